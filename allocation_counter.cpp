@@ -0,0 +1,111 @@
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<bool> counting(false);
+    std::atomic<uint64_t> allocations(0);
+
+    inline void count_allocation()
+    {
+        if (counting.load(std::memory_order_relaxed))
+            allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool allocation_counting_covers_malloc()
+{
+#ifdef __GLIBC__
+    return true;
+#else
+    return false;
+#endif
+}
+
+void allocation_counting_begin()
+{
+    allocations.store(0, std::memory_order_relaxed);
+    counting.store(true, std::memory_order_seq_cst);
+}
+
+uint64_t allocation_counting_end()
+{
+    counting.store(false, std::memory_order_seq_cst);
+    return allocations.load(std::memory_order_relaxed);
+}
+
+#ifdef __GLIBC__
+// glibc 导出的实际实现；可执行程序中的同名定义优先于 libc，共享库（OCCT、TBB）的调用也会解析到这里
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+    void *__libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void *ptr);
+
+    void *malloc(size_t size)
+    {
+        count_allocation();
+        return __libc_malloc(size);
+    }
+
+    void *calloc(size_t count, size_t size)
+    {
+        count_allocation();
+        return __libc_calloc(count, size);
+    }
+
+    void *realloc(void *ptr, size_t size)
+    {
+        count_allocation();
+        return __libc_realloc(ptr, size);
+    }
+
+    void *memalign(size_t alignment, size_t size)
+    {
+        count_allocation();
+        return __libc_memalign(alignment, size);
+    }
+
+    void *aligned_alloc(size_t alignment, size_t size)
+    {
+        count_allocation();
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void **ptr, size_t alignment, size_t size)
+    {
+        if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0)
+            return 22; // EINVAL
+        count_allocation();
+        void *p = __libc_memalign(alignment, size);
+        if (!p)
+            return 12; // ENOMEM
+        *ptr = p;
+        return 0;
+    }
+
+    void free(void *ptr)
+    {
+        __libc_free(ptr);
+    }
+}
+#else
+// 没有可转发的 malloc 实现，只统计 C++ 分配（数组和 nothrow 版本的默认实现转到这两个函数，对齐版本不计入）
+void *operator new(size_t size)
+{
+    count_allocation();
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+// 堆分配计数（只链接进基准测试程序，替换了全局分配函数，不要加入投影库）
+// - glibc：接管 malloc/calloc/realloc/posix_memalign 等，operator new 和 OCCT 的 Standard::Allocate 都经过这里
+// - 其它平台：只替换全局 operator new，经由 malloc 的分配（如OCCT内部）不计入
+// 计数对所有线程生效，未开启时每次分配只多一次原子读
+
+// 是否能统计到 malloc 级别的分配
+bool allocation_counting_covers_malloc();
+
+// 清零并开始计数
+void allocation_counting_begin();
+
+// 停止计数，返回 begin 以来所有线程的分配次数
+uint64_t allocation_counting_end();
@@ -0,0 +1,278 @@
+#include "analytic_projection.h"
+
+#include <cmath>
+#include <Precision.hxx>
+#include <Geom_Plane.hxx>
+#include <Geom_CylindricalSurface.hxx>
+#include <Geom_ConicalSurface.hxx>
+#include <Geom_SphericalSurface.hxx>
+#include <Geom_ToroidalSurface.hxx>
+
+namespace
+{
+    constexpr double TWO_PI = 6.283185307179586476925286766559;
+    constexpr double PI = 3.1415926535897932384626433832795;
+
+    // 把gp_Ax3拷贝到曲面的局部坐标系
+    void set_frame(const gp_Ax3 &pos, AnalyticSurface &s)
+    {
+        const gp_Pnt &o = pos.Location();
+        const gp_Dir &x = pos.XDirection();
+        const gp_Dir &y = pos.YDirection();
+        const gp_Dir &z = pos.Direction();
+        s.origin[0] = o.X(), s.origin[1] = o.Y(), s.origin[2] = o.Z();
+        s.xdir[0] = x.X(), s.xdir[1] = x.Y(), s.xdir[2] = x.Z();
+        s.ydir[0] = y.X(), s.ydir[1] = y.Y(), s.ydir[2] = y.Z();
+        s.zdir[0] = z.X(), s.zdir[1] = z.Y(), s.zdir[2] = z.Z();
+    }
+
+    // 角度归一化到[0, 2PI)，与OCCT周期参数范围一致
+    inline double wrap_angle(double a)
+    {
+        return a < 0.0 ? a + TWO_PI : a;
+    }
+
+    // 以下各内核的循环体没有分支依赖，便于编译器自动向量化
+    // 局部坐标：l = (P - O)·(X, Y, Z)
+#define ANALYTIC_LOCAL_FRAME                                     \
+    const double ox = s.origin[0], oy = s.origin[1], oz = s.origin[2]; \
+    const double x0 = s.xdir[0], x1 = s.xdir[1], x2 = s.xdir[2];   \
+    const double y0 = s.ydir[0], y1 = s.ydir[1], y2 = s.ydir[2];   \
+    const double z0 = s.zdir[0], z1 = s.zdir[1], z2 = s.zdir[2]
+
+    void plane_kernel(const AnalyticSurface &s, size_t n,
+                      const double *PROJ_RESTRICT x, const double *PROJ_RESTRICT y, const double *PROJ_RESTRICT z,
+                      double *PROJ_RESTRICT px, double *PROJ_RESTRICT py, double *PROJ_RESTRICT pz,
+                      double *PROJ_RESTRICT u, double *PROJ_RESTRICT v, double *PROJ_RESTRICT dist,
+                      unsigned char *PROJ_RESTRICT degenerate)
+    {
+        ANALYTIC_LOCAL_FRAME;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double dx = x[i] - ox, dy = y[i] - oy, dz = z[i] - oz;
+            const double lx = dx * x0 + dy * x1 + dz * x2;
+            const double ly = dx * y0 + dy * y1 + dz * y2;
+            const double lz = dx * z0 + dy * z1 + dz * z2;
+            px[i] = ox + lx * x0 + ly * y0;
+            py[i] = oy + lx * x1 + ly * y1;
+            pz[i] = oz + lx * x2 + ly * y2;
+            u[i] = lx;
+            v[i] = ly;
+            dist[i] = std::abs(lz);
+            degenerate[i] = 0;
+        }
+    }
+
+    void cylinder_kernel(const AnalyticSurface &s, size_t n,
+                         const double *PROJ_RESTRICT x, const double *PROJ_RESTRICT y, const double *PROJ_RESTRICT z,
+                         double *PROJ_RESTRICT px, double *PROJ_RESTRICT py, double *PROJ_RESTRICT pz,
+                         double *PROJ_RESTRICT u, double *PROJ_RESTRICT v, double *PROJ_RESTRICT dist,
+                         unsigned char *PROJ_RESTRICT degenerate)
+    {
+        ANALYTIC_LOCAL_FRAME;
+        const double R = s.radius;
+        const double tol = Precision::Confusion();
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double dx = x[i] - ox, dy = y[i] - oy, dz = z[i] - oz;
+            const double lx = dx * x0 + dy * x1 + dz * x2;
+            const double ly = dx * y0 + dy * y1 + dz * y2;
+            const double lz = dx * z0 + dy * z1 + dz * z2;
+            const double rho = std::sqrt(lx * lx + ly * ly);
+            const bool axis = rho <= tol;
+            const double k = axis ? 0.0 : R / rho;
+            const double cx = lx * k, cy = ly * k; // 径向分量
+            px[i] = ox + cx * x0 + cy * y0 + lz * z0;
+            py[i] = oy + cx * x1 + cy * y1 + lz * z1;
+            pz[i] = oz + cx * x2 + cy * y2 + lz * z2;
+            u[i] = wrap_angle(std::atan2(ly, lx));
+            v[i] = lz;
+            dist[i] = std::abs(rho - R);
+            degenerate[i] = axis;
+        }
+    }
+
+    void cone_kernel(const AnalyticSurface &s, size_t n,
+                     const double *PROJ_RESTRICT x, const double *PROJ_RESTRICT y, const double *PROJ_RESTRICT z,
+                     double *PROJ_RESTRICT px, double *PROJ_RESTRICT py, double *PROJ_RESTRICT pz,
+                     double *PROJ_RESTRICT u, double *PROJ_RESTRICT v, double *PROJ_RESTRICT dist,
+                     unsigned char *PROJ_RESTRICT degenerate)
+    {
+        ANALYTIC_LOCAL_FRAME;
+        const double R = s.radius, sa = s.sin_angle, ca = s.cos_angle;
+        const double tol = Precision::Confusion();
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double dx = x[i] - ox, dy = y[i] - oy, dz = z[i] - oz;
+            const double lx = dx * x0 + dy * x1 + dz * x2;
+            const double ly = dx * y0 + dy * y1 + dz * y2;
+            const double lz = dx * z0 + dy * z1 + dz * z2;
+            const double rho = std::sqrt(lx * lx + ly * ly);
+            const bool axis = rho <= tol;
+            const double cu = axis ? 1.0 : lx / rho;
+            const double su = axis ? 0.0 : ly / rho;
+            // 过轴线和点的平面与锥面交成两条母线：u方向一条，u+PI方向一条
+            // P(u,v) = O + (R + v*sin(a))*(cos(u)X + sin(u)Y) + v*cos(a)Z
+            const double va = (rho - R) * sa + lz * ca;
+            const double ea = rho - (R + va * sa), fa = lz - va * ca;
+            const double vb = -(rho + R) * sa + lz * ca;
+            const double eb = rho + (R + vb * sa), fb = lz - vb * ca;
+            const double da = ea * ea + fa * fa, db = eb * eb + fb * fb;
+            const bool second = db < da;
+            const double vv = second ? vb : va;
+            const double r = second ? -(R + vv * sa) : (R + vv * sa); // 沿(cu, su)方向的有符号半径
+            const double cx = r * cu, cy = r * su, ch = vv * ca;
+            px[i] = ox + cx * x0 + cy * y0 + ch * z0;
+            py[i] = oy + cx * x1 + cy * y1 + ch * z1;
+            pz[i] = oz + cx * x2 + cy * y2 + ch * z2;
+            const double uu = wrap_angle(std::atan2(ly, lx));
+            u[i] = second ? (uu >= PI ? uu - PI : uu + PI) : uu;
+            v[i] = vv;
+            dist[i] = std::sqrt(second ? db : da);
+            // 轴线上的点最近点构成一整个圆，两条母线等距时也不唯一
+            degenerate[i] = axis || std::abs(da - db) <= tol * tol;
+        }
+    }
+
+    void sphere_kernel(const AnalyticSurface &s, size_t n,
+                       const double *PROJ_RESTRICT x, const double *PROJ_RESTRICT y, const double *PROJ_RESTRICT z,
+                       double *PROJ_RESTRICT px, double *PROJ_RESTRICT py, double *PROJ_RESTRICT pz,
+                       double *PROJ_RESTRICT u, double *PROJ_RESTRICT v, double *PROJ_RESTRICT dist,
+                       unsigned char *PROJ_RESTRICT degenerate)
+    {
+        ANALYTIC_LOCAL_FRAME;
+        const double R = s.radius;
+        const double tol = Precision::Confusion();
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double dx = x[i] - ox, dy = y[i] - oy, dz = z[i] - oz;
+            const double lx = dx * x0 + dy * x1 + dz * x2;
+            const double ly = dx * y0 + dy * y1 + dz * y2;
+            const double lz = dx * z0 + dy * z1 + dz * z2;
+            const double rho = std::sqrt(lx * lx + ly * ly);
+            const double len = std::sqrt(dx * dx + dy * dy + dz * dz);
+            const bool center = len <= tol;
+            const double k = center ? 0.0 : R / len;
+            px[i] = ox + dx * k;
+            py[i] = oy + dy * k;
+            pz[i] = oz + dz * k;
+            u[i] = wrap_angle(std::atan2(ly, lx));
+            v[i] = std::atan2(lz, rho);
+            dist[i] = std::abs(len - R);
+            degenerate[i] = center;
+        }
+    }
+
+    void torus_kernel(const AnalyticSurface &s, size_t n,
+                      const double *PROJ_RESTRICT x, const double *PROJ_RESTRICT y, const double *PROJ_RESTRICT z,
+                      double *PROJ_RESTRICT px, double *PROJ_RESTRICT py, double *PROJ_RESTRICT pz,
+                      double *PROJ_RESTRICT u, double *PROJ_RESTRICT v, double *PROJ_RESTRICT dist,
+                      unsigned char *PROJ_RESTRICT degenerate)
+    {
+        ANALYTIC_LOCAL_FRAME;
+        const double R = s.radius, r = s.minor_radius;
+        const double tol = Precision::Confusion();
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double dx = x[i] - ox, dy = y[i] - oy, dz = z[i] - oz;
+            const double lx = dx * x0 + dy * x1 + dz * x2;
+            const double ly = dx * y0 + dy * y1 + dz * y2;
+            const double lz = dx * z0 + dy * z1 + dz * z2;
+            const double rho = std::sqrt(lx * lx + ly * ly);
+            const bool axis = rho <= tol;
+            const double cu = axis ? 1.0 : lx / rho;
+            const double su = axis ? 0.0 : ly / rho;
+            // 在子午面内投影到以(R, 0)为圆心、r为半径的管截面圆上
+            const double e = rho - R;
+            const double len = std::sqrt(e * e + lz * lz);
+            const bool tube_center = len <= tol;
+            const double k = tube_center ? 0.0 : r / len;
+            const double cr = R + e * k, ch = lz * k;
+            const double cx = cr * cu, cy = cr * su;
+            px[i] = ox + cx * x0 + cy * y0 + ch * z0;
+            py[i] = oy + cx * x1 + cy * y1 + ch * z1;
+            pz[i] = oz + cx * x2 + cy * y2 + ch * z2;
+            u[i] = wrap_angle(std::atan2(ly, lx));
+            v[i] = wrap_angle(std::atan2(lz, e));
+            dist[i] = std::abs(len - r);
+            degenerate[i] = axis || tube_center;
+        }
+    }
+
+#undef ANALYTIC_LOCAL_FRAME
+}
+
+bool analytic_surface_init(const Handle(Geom_Surface) & surface, AnalyticSurface &analytic)
+{
+    analytic = AnalyticSurface();
+    if (surface.IsNull())
+        return false;
+
+    if (Handle(Geom_Plane) plane = Handle(Geom_Plane)::DownCast(surface))
+    {
+        set_frame(plane->Position(), analytic);
+        analytic.type = ANALYTIC_PLANE;
+    }
+    else if (Handle(Geom_CylindricalSurface) cyl = Handle(Geom_CylindricalSurface)::DownCast(surface))
+    {
+        set_frame(cyl->Position(), analytic);
+        analytic.radius = cyl->Radius();
+        analytic.type = ANALYTIC_CYLINDER;
+    }
+    else if (Handle(Geom_ConicalSurface) cone = Handle(Geom_ConicalSurface)::DownCast(surface))
+    {
+        set_frame(cone->Position(), analytic);
+        analytic.radius = cone->RefRadius();
+        analytic.sin_angle = std::sin(cone->SemiAngle());
+        analytic.cos_angle = std::cos(cone->SemiAngle());
+        analytic.type = ANALYTIC_CONE;
+    }
+    else if (Handle(Geom_SphericalSurface) sphere = Handle(Geom_SphericalSurface)::DownCast(surface))
+    {
+        set_frame(sphere->Position(), analytic);
+        analytic.radius = sphere->Radius();
+        analytic.type = ANALYTIC_SPHERE;
+    }
+    else if (Handle(Geom_ToroidalSurface) torus = Handle(Geom_ToroidalSurface)::DownCast(surface))
+    {
+        // 主半径小于次半径时两侧管截面重叠，最近点不一定在同侧，交给通用投影
+        if (torus->MajorRadius() < torus->MinorRadius())
+            return false;
+        set_frame(torus->Position(), analytic);
+        analytic.radius = torus->MajorRadius();
+        analytic.minor_radius = torus->MinorRadius();
+        analytic.type = ANALYTIC_TORUS;
+    }
+    return analytic.type != ANALYTIC_NONE;
+}
+
+void analytic_project_kernel(const AnalyticSurface &analytic, size_t count,
+                             const double *x, const double *y, const double *z,
+                             double *px, double *py, double *pz,
+                             double *u, double *v, double *dist,
+                             unsigned char *degenerate)
+{
+    // 曲面类型每批只分派一次
+    switch (analytic.type)
+    {
+    case ANALYTIC_PLANE:
+        plane_kernel(analytic, count, x, y, z, px, py, pz, u, v, dist, degenerate);
+        break;
+    case ANALYTIC_CYLINDER:
+        cylinder_kernel(analytic, count, x, y, z, px, py, pz, u, v, dist, degenerate);
+        break;
+    case ANALYTIC_CONE:
+        cone_kernel(analytic, count, x, y, z, px, py, pz, u, v, dist, degenerate);
+        break;
+    case ANALYTIC_SPHERE:
+        sphere_kernel(analytic, count, x, y, z, px, py, pz, u, v, dist, degenerate);
+        break;
+    case ANALYTIC_TORUS:
+        torus_kernel(analytic, count, x, y, z, px, py, pz, u, v, dist, degenerate);
+        break;
+    default:
+        for (size_t i = 0; i < count; ++i)
+            degenerate[i] = 1;
+        break;
+    }
+}
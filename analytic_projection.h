@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <gp_Pnt.hxx>
+#include <Geom_Surface.hxx>
+
+#if defined(_MSC_VER) || defined(__GNUC__)
+#define PROJ_RESTRICT __restrict
+#else
+#define PROJ_RESTRICT
+#endif
+
+// 批量内核一次处理的点数（栈上SoA缓冲区大小）
+constexpr size_t ANALYTIC_BLOCK_SIZE = 256;
+
+// 可以用闭式解投影的初等曲面类型
+enum AnalyticSurfaceType
+{
+    ANALYTIC_NONE = 0, // 非初等曲面，走OCCT通用投影
+    ANALYTIC_PLANE,
+    ANALYTIC_CYLINDER,
+    ANALYTIC_CONE,
+    ANALYTIC_SPHERE,
+    ANALYTIC_TORUS
+};
+
+// 初等曲面的局部坐标系和尺寸（纯数值，可在线程间只读共享）
+struct AnalyticSurface
+{
+    AnalyticSurfaceType type = ANALYTIC_NONE;
+    double origin[3] = {0.0, 0.0, 0.0};
+    double xdir[3] = {1.0, 0.0, 0.0};
+    double ydir[3] = {0.0, 1.0, 0.0};
+    double zdir[3] = {0.0, 0.0, 1.0};
+    double radius = 0.0;       // 球/柱半径，锥参考半径，环主半径
+    double minor_radius = 0.0; // 环次半径
+    double sin_angle = 0.0;    // 锥半角正弦
+    double cos_angle = 1.0;    // 锥半角余弦
+};
+
+// 识别初等曲面（Geom_Plane/Geom_CylindricalSurface/Geom_ConicalSurface/
+// Geom_SphericalSurface/Geom_ToroidalSurface），其它类型返回false
+bool analytic_surface_init(const Handle(Geom_Surface) & surface, AnalyticSurface &analytic);
+
+// 闭式投影批量内核（SoA输入输出）
+// 解不唯一的点（球心、轴线上的点等）degenerate置1，需由调用者走通用投影
+void analytic_project_kernel(const AnalyticSurface &analytic, size_t count,
+                             const double *x, const double *y, const double *z,
+                             double *px, double *py, double *pz,
+                             double *u, double *v, double *dist,
+                             unsigned char *degenerate);
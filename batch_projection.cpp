@@ -0,0 +1,320 @@
+#include "batch_projection.h"
+#include "projection_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/task_arena.h>
+#include <tbb/enumerable_thread_specific.h>
+
+void PointArrays::reserve(size_t n)
+{
+    x.reserve(n);
+    y.reserve(n);
+    z.reserve(n);
+}
+
+void PointArrays::push_back(const gp_Pnt &p)
+{
+    x.push_back(p.X());
+    y.push_back(p.Y());
+    z.push_back(p.Z());
+}
+
+PointBatch PointArrays::batch() const
+{
+    return batch(0, size());
+}
+
+PointBatch PointArrays::batch(size_t begin, size_t end) const
+{
+    PointBatch b;
+    b.x = x.data() + begin;
+    b.y = y.data() + begin;
+    b.z = z.data() + begin;
+    b.count = end - begin;
+    return b;
+}
+
+void ProjectionResultArrays::resize(size_t n)
+{
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+    u.resize(n);
+    v.resize(n);
+    distance.resize(n);
+    status.resize(n);
+}
+
+ProjectionBuffers ProjectionResultArrays::buffers()
+{
+    ProjectionBuffers b;
+    b.x = x.data();
+    b.y = y.data();
+    b.z = z.data();
+    b.u = u.data();
+    b.v = v.data();
+    b.distance = distance.data();
+    b.status = status.data();
+    return b;
+}
+
+BatchProjector::BatchProjector(const Handle(Geom_Surface) & surface, bool prepare, ProjectionPrecision precision)
+    : surface_(surface)
+{
+    if (analytic_surface_init(surface, analytic_) || surface.IsNull())
+        return;
+    domain_ = surface_param_domain(surface);
+    if (prepare)
+    {
+        auto prepared = std::make_shared<PreparedSurface>(surface, 256, precision);
+        if (prepared->is_valid())
+            prepared_ = prepared;
+    }
+}
+
+void store_projection(const ProjectionBuffers &output, size_t i, const LocalProjectionResult &result)
+{
+    output.x[i] = result.point.X(), output.y[i] = result.point.Y(), output.z[i] = result.point.Z();
+    if (output.u)
+        output.u[i] = result.u;
+    if (output.v)
+        output.v[i] = result.v;
+    if (output.distance)
+        output.distance[i] = result.distance;
+    output.status[i] = PROJECTION_OK;
+}
+
+bool BatchProjector::project_point(const gp_Pnt &p, ProjectionWorkspace &workspace, LocalProjectionResult &result) const
+{
+    if (prepared_ && prepared_->project(p, workspace.prepared, result))
+        return true;
+    return project_point_occt(p, workspace, result);
+}
+
+bool BatchProjector::project_point_occt(const gp_Pnt &p, ProjectionWorkspace &workspace, LocalProjectionResult &result) const
+{
+    GeomAPI_ProjectPointOnSurf &projector = workspace.projector;
+    {
+        PROJ_PROFILE_PHASE(PROFILE_INIT);
+        // Init(p, surface) 每个点都重建 Extrema 的采样网格和解序列；
+        // 按曲面绑定一次，之后的点只做 Perform
+        if (workspace.projector_surface != surface_)
+        {
+            double umin, umax, vmin, vmax;
+            surface_->Bounds(umin, umax, vmin, vmax);
+            projector.Init(surface_, umin, umax, vmin, vmax);
+            workspace.projector_surface = surface_;
+        }
+        projector.Perform(p);
+    }
+    if (projector.NbPoints() == 0)
+    {
+        PROJ_PROFILE_FAILURE();
+        return false;
+    }
+    PROJ_PROFILE_PHASE(PROFILE_EXTRACT);
+    result.point = projector.NearestPoint();
+    projector.LowerDistanceParameters(result.u, result.v);
+    result.distance = projector.LowerDistance();
+    result.converged = true;
+    return true;
+}
+
+bool BatchProjector::refine_point(const gp_Pnt &p, double u0, double v0, ProjectionWorkspace &workspace,
+                                  LocalProjectionResult &result, int max_iterations) const
+{
+    if (prepared_)
+        return prepared_->refine(p, u0, v0, workspace.prepared, result, max_iterations);
+    return local_project_point(*surface_, domain_, p, u0, v0, result, max_iterations);
+}
+
+void BatchProjector::project_point_general(const PointBatch &input, const ProjectionBuffers &output,
+                                           size_t i, ProjectionWorkspace &workspace) const
+{
+    const gp_Pnt p(input.x[i], input.y[i], input.z[i]);
+    if (!std::isfinite(p.X()) || !std::isfinite(p.Y()) || !std::isfinite(p.Z()))
+    {
+        output.x[i] = p.X(), output.y[i] = p.Y(), output.z[i] = p.Z();
+        output.status[i] = PROJECTION_INVALID_INPUT;
+        return;
+    }
+
+    LocalProjectionResult result;
+    if (!project_point(p, workspace, result))
+    {
+        output.x[i] = p.X(), output.y[i] = p.Y(), output.z[i] = p.Z();
+        output.status[i] = PROJECTION_NOT_DONE;
+        return;
+    }
+    store_projection(output, i, result);
+}
+
+template <class Evaluator>
+void BatchProjector::project_point_prepared(const PointBatch &input, const ProjectionBuffers &output, size_t i,
+                                            ProjectionWorkspace &workspace, const Evaluator &evaluator) const
+{
+    const gp_Pnt p(input.x[i], input.y[i], input.z[i]);
+    if (!std::isfinite(p.X()) || !std::isfinite(p.Y()) || !std::isfinite(p.Z()))
+    {
+        output.x[i] = p.X(), output.y[i] = p.Y(), output.z[i] = p.Z();
+        output.status[i] = PROJECTION_INVALID_INPUT;
+        return;
+    }
+
+    LocalProjectionResult result;
+    if (!prepared_->project(p, workspace.prepared, evaluator, result) && !project_point_occt(p, workspace, result))
+    {
+        output.x[i] = p.X(), output.y[i] = p.Y(), output.z[i] = p.Z();
+        output.status[i] = PROJECTION_NOT_DONE;
+        return;
+    }
+    store_projection(output, i, result);
+}
+
+void BatchProjector::project_range(const PointBatch &input, const ProjectionBuffers &output,
+                                   size_t begin, size_t end, ProjectionWorkspace &workspace) const
+{
+    PROJ_PROFILE_CHUNK();
+    PROJ_PROFILE_POINTS(end - begin);
+    if (prepared_)
+    {
+        // 曲面类型每块分派一次，块内所有点共用同一个特化求值器（B样条求值器顺带记住上一个span）
+        prepared_->with_evaluator(workspace.prepared, [&](const auto &evaluator) {
+            for (size_t i = begin; i < end; ++i)
+                project_point_prepared(input, output, i, workspace, evaluator);
+        });
+        return;
+    }
+    if (!is_analytic())
+    {
+        for (size_t i = begin; i < end; ++i)
+            project_point_general(input, output, i, workspace);
+        return;
+    }
+
+    // 输入已是SoA，直接交给闭式内核；只在栈上缓存调用者不需要的字段
+    double u_scratch[ANALYTIC_BLOCK_SIZE], v_scratch[ANALYTIC_BLOCK_SIZE], d_scratch[ANALYTIC_BLOCK_SIZE];
+    unsigned char degenerate[ANALYTIC_BLOCK_SIZE];
+    for (size_t b = begin; b < end; b += ANALYTIC_BLOCK_SIZE)
+    {
+        const size_t n = std::min(ANALYTIC_BLOCK_SIZE, end - b);
+        analytic_project_kernel(analytic_, n, input.x + b, input.y + b, input.z + b,
+                                output.x + b, output.y + b, output.z + b,
+                                output.u ? output.u + b : u_scratch,
+                                output.v ? output.v + b : v_scratch,
+                                output.distance ? output.distance + b : d_scratch,
+                                degenerate);
+        for (size_t i = 0; i < n; ++i)
+        {
+            // 非有限坐标经过内核后同样是非有限值，统一交给通用路径标记
+            if (degenerate[i] || !std::isfinite(output.x[b + i]))
+                project_point_general(input, output, b + i, workspace);
+            else
+                output.status[b + i] = PROJECTION_OK;
+        }
+    }
+}
+
+struct ProjectionWorkspacePool::Storage
+{
+    tbb::enumerable_thread_specific<ProjectionWorkspace> workspaces;
+};
+
+ProjectionWorkspacePool::ProjectionWorkspacePool()
+    : storage_(new Storage())
+{
+}
+
+ProjectionWorkspacePool::~ProjectionWorkspacePool() = default;
+
+ProjectionWorkspace &ProjectionWorkspacePool::local()
+{
+    return storage_->workspaces.local();
+}
+
+size_t ProjectionWorkspacePool::size() const
+{
+    return storage_->workspaces.size();
+}
+
+void ProjectionWorkspacePool::clear()
+{
+    storage_->workspaces.clear();
+}
+
+void project_batch_serial(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output,
+                          ProjectionWorkspacePool *pool)
+{
+    if (pool)
+    {
+        projector.project_range(input, output, 0, input.count, pool->local());
+        return;
+    }
+    ProjectionWorkspace workspace; // 只构造一次
+    projector.project_range(input, output, 0, input.count, workspace);
+}
+
+void project_batch_omp(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output, int num_threads,
+                       ProjectionWorkspacePool *pool)
+{
+#ifdef _OPENMP
+    const size_t num_points = input.count;
+    const int num_blocks = static_cast<int>((num_points + ANALYTIC_BLOCK_SIZE - 1) / ANALYTIC_BLOCK_SIZE);
+    omp_set_num_threads(num_threads);
+#pragma omp parallel
+    {
+        std::unique_ptr<ProjectionWorkspace> owned; // 没有工作区池时每个线程只构造一次
+        if (!pool)
+            owned.reset(new ProjectionWorkspace());
+        ProjectionWorkspace &workspace = pool ? pool->local() : *owned;
+#pragma omp for
+        for (int b = 0; b < num_blocks; ++b)
+        {
+            const size_t begin = static_cast<size_t>(b) * ANALYTIC_BLOCK_SIZE;
+            const size_t end = std::min(begin + ANALYTIC_BLOCK_SIZE, num_points);
+            projector.project_range(input, output, begin, end, workspace);
+        }
+    }
+#else
+    std::cerr << "OpenMP not enabled!" << std::endl;
+#endif
+}
+
+void project_batch_tbb(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output, int num_threads,
+                       ProjectionWorkspacePool *pool)
+{
+    tbb::enumerable_thread_specific<ProjectionWorkspace> ets_workspace;
+    tbb::task_arena arena(num_threads);
+    arena.execute([&] {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, input.count, ANALYTIC_BLOCK_SIZE), [&](const tbb::blocked_range<size_t> &r) {
+            auto &workspace = pool ? pool->local() : ets_workspace.local(); // 每个线程只构造一次
+            projector.project_range(input, output, r.begin(), r.end(), workspace);
+        });
+    });
+}
+
+void project_batch(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output,
+                   ProjectionBackend backend, int num_threads, ProjectionWorkspacePool *pool)
+{
+    switch (backend)
+    {
+    case BACKEND_OPENMP:
+        project_batch_omp(projector, input, output, num_threads, pool);
+        break;
+    case BACKEND_TBB:
+        project_batch_tbb(projector, input, output, num_threads, pool);
+        break;
+    default:
+        project_batch_serial(projector, input, output, pool);
+        break;
+    }
+}
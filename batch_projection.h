@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <gp_Pnt.hxx>
+#include <Geom_Surface.hxx>
+#include <GeomAPI_ProjectPointOnSurf.hxx>
+
+#include "analytic_projection.h"
+#include "local_projection.h"
+#include "prepared_surface.h"
+
+// 单点投影状态码
+enum ProjectionStatus : unsigned char
+{
+    PROJECTION_OK = 0,            // 投影成功
+    PROJECTION_NOT_DONE = 1,      // 通用投影无解（NbPoints() == 0）
+    PROJECTION_INVALID_INPUT = 2  // 输入坐标非有限值
+};
+
+// 后端选择
+enum ProjectionBackend
+{
+    BACKEND_SERIAL = 0,
+    BACKEND_OPENMP,
+    BACKEND_TBB
+};
+
+// 输入点（SoA），x/y/z 各自连续存放 count 个坐标
+struct PointBatch
+{
+    const double *x = nullptr;
+    const double *y = nullptr;
+    const double *z = nullptr;
+    size_t count = 0;
+};
+
+// 调用者提供的输出缓冲区（SoA），每个数组至少容纳输入的 count 个元素
+// 不需要的字段可以置空（x/y/z/status 除外）
+struct ProjectionBuffers
+{
+    double *x = nullptr;
+    double *y = nullptr;
+    double *z = nullptr;
+    double *u = nullptr;
+    double *v = nullptr;
+    double *distance = nullptr;
+    unsigned char *status = nullptr;
+};
+
+// 持有输入坐标的便捷容器
+struct PointArrays
+{
+    std::vector<double> x, y, z;
+
+    void reserve(size_t n);
+    void push_back(const gp_Pnt &p);
+    size_t size() const { return x.size(); }
+    PointBatch batch() const;
+    PointBatch batch(size_t begin, size_t end) const;
+};
+
+// 持有投影结果的便捷容器（一次分配，多次复用）
+struct ProjectionResultArrays
+{
+    std::vector<double> x, y, z, u, v, distance;
+    std::vector<unsigned char> status;
+
+    void resize(size_t n);
+    size_t size() const { return x.size(); }
+    ProjectionBuffers buffers();
+    gp_Pnt point(size_t i) const { return gp_Pnt(x[i], y[i], z[i]); }
+};
+
+// 每个线程私有的投影工作区（可默认构造，线程间不共享）
+struct ProjectionWorkspace
+{
+    GeomAPI_ProjectPointOnSurf projector;   // OCCT通用投影（回退路径），每个曲面只 Init 一次，之后逐点 Perform
+    Handle(Geom_Surface) projector_surface; // projector 当前绑定的曲面（持有引用，防止地址被复用）
+    PreparedSurface::Scratch prepared;      // 预处理曲面的线程私有状态
+};
+
+// 跨批次复用的线程私有工作区：每个线程首次使用时构造一个 ProjectionWorkspace，
+// 之后只在换曲面时重新绑定（求值适配器、候选缓冲、OCCT投影器的搜索网格），
+// 反复投影（迭代求解、逐时间步更新）时稳态下热路径不再分配堆内存
+class ProjectionWorkspacePool
+{
+public:
+    ProjectionWorkspacePool();
+    ~ProjectionWorkspacePool();
+
+    // 当前线程的工作区（可从TBB/OpenMP工作线程调用）
+    ProjectionWorkspace &local();
+    // 已构造的工作区数
+    size_t size() const;
+    // 释放全部工作区，不得与投影并发调用
+    void clear();
+
+private:
+    struct Storage;
+    std::unique_ptr<Storage> storage_;
+};
+
+// 批量投影器：
+// - 初等曲面走闭式内核
+// - 其它曲面默认构建一次 PreparedSurface（采样网格+补丁包围盒），种子搜索后做局部Newton求解
+// - Newton不收敛或曲面无法预处理时回退到 GeomAPI_ProjectPointOnSurf
+// 构造后只读，可被多个线程共享；每个线程持有自己的 ProjectionWorkspace
+class BatchProjector
+{
+public:
+    // precision 只影响预处理曲面的种子搜索（见 ProjectionPrecision），初等曲面始终走双精度闭式内核
+    explicit BatchProjector(const Handle(Geom_Surface) & surface, bool prepare = true,
+                            ProjectionPrecision precision = PRECISION_DOUBLE);
+
+    bool is_analytic() const { return analytic_.type != ANALYTIC_NONE; }
+    const AnalyticSurface &analytic() const { return analytic_; }
+    const Handle(Geom_Surface) & surface() const { return surface_; }
+    const SurfaceParamDomain &domain() const { return domain_; }
+    const PreparedSurface *prepared() const { return prepared_.get(); }
+
+    // 单线程投影 input[begin, end)，结果写到 output 的相同下标处
+    void project_range(const PointBatch &input, const ProjectionBuffers &output,
+                       size_t begin, size_t end, ProjectionWorkspace &workspace) const;
+
+    // 单点全局投影（不走闭式内核），失败返回false
+    bool project_point(const gp_Pnt &p, ProjectionWorkspace &workspace, LocalProjectionResult &result) const;
+
+    // 从种子(u0, v0)做局部求解，只保证局部极小
+    bool refine_point(const gp_Pnt &p, double u0, double v0, ProjectionWorkspace &workspace,
+                      LocalProjectionResult &result, int max_iterations = 20) const;
+
+    // 用单点全局投影处理 input 的第i个点并写入 output
+    void project_point_general(const PointBatch &input, const ProjectionBuffers &output,
+                               size_t i, ProjectionWorkspace &workspace) const;
+
+private:
+    // OCCT通用投影（预处理曲面求解失败或无法预处理时的回退）
+    bool project_point_occt(const gp_Pnt &p, ProjectionWorkspace &workspace, LocalProjectionResult &result) const;
+
+    // 预处理曲面路径：求值器由 project_range 按曲面类型每块构造一次
+    template <class Evaluator>
+    void project_point_prepared(const PointBatch &input, const ProjectionBuffers &output, size_t i,
+                                ProjectionWorkspace &workspace, const Evaluator &evaluator) const;
+
+    Handle(Geom_Surface) surface_;
+    AnalyticSurface analytic_;
+    SurfaceParamDomain domain_;
+    std::shared_ptr<const PreparedSurface> prepared_;
+};
+
+// 把单点结果写入输出缓冲区的第i个位置
+void store_projection(const ProjectionBuffers &output, size_t i, const LocalProjectionResult &result);
+
+// 以下批量投影的 pool 为空时每次调用新建工作区，否则使用池中的线程私有工作区
+
+// 串行批量投影
+void project_batch_serial(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output,
+                          ProjectionWorkspacePool *pool = nullptr);
+
+// OpenMP并行批量投影（按块静态划分）
+void project_batch_omp(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output, int num_threads,
+                       ProjectionWorkspacePool *pool = nullptr);
+
+// TBB并行批量投影（每个线程一个工作区）
+void project_batch_tbb(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output, int num_threads,
+                       ProjectionWorkspacePool *pool = nullptr);
+
+// 按后端分派
+void project_batch(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output,
+                   ProjectionBackend backend, int num_threads, ProjectionWorkspacePool *pool = nullptr);
@@ -0,0 +1,738 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Standard_Version.hxx>
+#include <gp.hxx>
+#include <gp_Ax3.hxx>
+#include <gp_Pln.hxx>
+#include <gp_Cylinder.hxx>
+#include <gp_Cone.hxx>
+#include <gp_Sphere.hxx>
+#include <gp_Torus.hxx>
+#include <gp_Vec.hxx>
+#include <Geom_Plane.hxx>
+#include <Geom_CylindricalSurface.hxx>
+#include <Geom_ConicalSurface.hxx>
+#include <Geom_SphericalSurface.hxx>
+#include <Geom_ToroidalSurface.hxx>
+#include <GeomAPI_ProjectPointOnSurf.hxx>
+#include <GeomConvert.hxx>
+#include <Precision.hxx>
+
+#include "allocation_counter.h"
+#include "batch_projection.h"
+#include "coherent_projection.h"
+#include "numa_projection.h"
+#include "schedule_tuner.h"
+#include "seed_cache.h"
+#include "simd_kernels.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <tbb/version.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#include <tbb/enumerable_thread_specific.h>
+
+// 可复现的投影基准测试：
+// 曲面 × 点分布 × 方法 × 后端 × 线程数扫描，预热后重复计时，输出中位数/p95/吞吐量，
+// 强扩展（点数固定）和弱扩展（每线程点数固定），结果可写成JSON/CSV供回归比较
+namespace
+{
+    struct BenchConfig
+    {
+        std::string surface = "sphere";
+        std::string distribution = "uniform";
+        size_t points = 1000000;             // 强扩展的总点数 / 弱扩展的每线程点数
+        std::vector<int> threads;            // 为空时取 1, 2, 4, ... 直到硬件线程数
+        std::vector<std::string> methods = {"fast", "batch"};
+        std::vector<std::string> backends = {"serial", "omp", "tbb"};
+        std::vector<std::string> scalings = {"strong"};
+        std::string pinning = "core";        // numa 方法的线程绑定方式
+        std::string schedule_cache;          // tuned 方法的调度缓存文件
+        bool count_allocs = false;           // 每个组合额外运行一次（不计时）统计堆分配次数
+        int warmup = 1;
+        int repeat = 5;
+        unsigned seed = 42;
+        double scale = 50.0;                 // 曲面特征尺寸
+        std::string json_path, csv_path;
+    };
+
+    struct BenchRecord
+    {
+        std::string method, backend, scaling;
+        int threads = 1;
+        size_t points = 0;
+        std::vector<double> times;           // 每次重复的耗时（秒）
+        double median = 0.0, p95 = 0.0, min = 0.0, mean = 0.0;
+        double throughput = 0.0;             // 点/秒（按中位数）
+        double speedup = 1.0, efficiency = 1.0;
+        std::vector<double> node_throughput; // numa 方法：各节点吞吐量（点/秒，各次重复取中位数）
+        long long allocations = -1;          // 计数运行的堆分配次数（未统计为-1）
+    };
+
+    // 同一组合的全部被测数据（只生成一次，各次运行共用）
+    struct BenchContext
+    {
+        Handle(Geom_Surface) surface;
+        std::unique_ptr<BatchProjector> projector;
+        std::unique_ptr<BatchProjector> mixed_projector; // mixed 方法：单精度SIMD种子搜索
+        ProjectionWorkspacePool workspaces;              // pooled 方法：跨运行复用的线程私有工作区
+        SeedCache seed_cache;                            // cached 方法：首次使用时构建，不计入计时
+        PointArrays points;
+        std::vector<gp_Pnt> aos_points;      // GeomAPI 逐点方法使用
+        ProjectionResultArrays results;
+        std::vector<gp_Pnt> aos_results;
+
+        // numa 方法：按线程数重建执行器，输入输出由各分片首次触碰
+        NumaTopology topology;
+        ThreadPinning pinning = PIN_CORE;
+        std::unique_ptr<NumaExecutor> numa;
+        NumaBatchBuffers numa_buffers;
+        std::vector<double> numa_times;      // 最近一次运行各分片的耗时
+
+        // tuned 方法：每个 (后端, 线程数) 首次运行（预热）时查缓存或标定，之后复用选出的调度
+        ScheduleTuner tuner;
+        std::map<std::pair<int, int>, std::unique_ptr<ScheduledBatch>> tuned;
+    };
+
+    std::vector<std::string> split_list(const std::string &text)
+    {
+        std::vector<std::string> items;
+        std::stringstream ss(text);
+        std::string item;
+        while (std::getline(ss, item, ','))
+        {
+            if (!item.empty())
+                items.push_back(item);
+        }
+        return items;
+    }
+
+    Handle(Geom_Surface) make_surface(const std::string &name, double r)
+    {
+        const gp_Ax3 axis(gp_Pnt(0, 0, 0), gp_Dir(0, 0, 1));
+        if (name == "plane")
+            return new Geom_Plane(gp_Pln(axis));
+        if (name == "cylinder")
+            return new Geom_CylindricalSurface(gp_Cylinder(axis, r));
+        if (name == "cone")
+            return new Geom_ConicalSurface(gp_Cone(axis, M_PI / 6.0, r));
+        if (name == "sphere")
+            return new Geom_SphericalSurface(gp_Sphere(axis, r));
+        if (name == "torus")
+            return new Geom_ToroidalSurface(gp_Torus(axis, r, 0.3 * r));
+        if (name == "nurbs-sphere")
+            return GeomConvert::SurfaceToBSplineSurface(new Geom_SphericalSurface(gp_Sphere(axis, r)));
+        if (name == "nurbs-torus")
+            return GeomConvert::SurfaceToBSplineSurface(new Geom_ToroidalSurface(gp_Torus(axis, r, 0.3 * r)));
+        return Handle(Geom_Surface)();
+    }
+
+    // uniform: [-2r, 2r]^3 均匀；gaussian: 以原点为中心、标准差r；
+    // shell: 曲面上随机点沿法向偏移（标准差0.1r）；clustered: 16个簇，簇内标准差0.05r
+    bool generate_points(const Handle(Geom_Surface) & surface, const std::string &distribution, size_t n,
+                         double r, unsigned seed, PointArrays &points)
+    {
+        std::mt19937_64 rng(seed);
+        std::uniform_real_distribution<double> cube(-2.0 * r, 2.0 * r);
+        points.reserve(n);
+        if (distribution == "uniform")
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                const double x = cube(rng), y = cube(rng), z = cube(rng);
+                points.push_back(gp_Pnt(x, y, z));
+            }
+        }
+        else if (distribution == "gaussian")
+        {
+            std::normal_distribution<double> g(0.0, r);
+            for (size_t i = 0; i < n; ++i)
+            {
+                const double x = g(rng), y = g(rng), z = g(rng);
+                points.push_back(gp_Pnt(x, y, z));
+            }
+        }
+        else if (distribution == "shell")
+        {
+            double umin, umax, vmin, vmax;
+            surface->Bounds(umin, umax, vmin, vmax);
+            // 无限参数方向截到 [-r, r]
+            umin = Precision::IsInfinite(umin) ? -r : umin, umax = Precision::IsInfinite(umax) ? r : umax;
+            vmin = Precision::IsInfinite(vmin) ? -r : vmin, vmax = Precision::IsInfinite(vmax) ? r : vmax;
+            std::uniform_real_distribution<double> du(umin, umax), dv(vmin, vmax);
+            std::normal_distribution<double> offset(0.0, 0.1 * r);
+            gp_Pnt s;
+            gp_Vec su, sv;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const double u = du(rng), v = dv(rng);
+                surface->D1(u, v, s, su, sv);
+                gp_Vec normal = su.Crossed(sv);
+                const double len = normal.Magnitude();
+                if (len > gp::Resolution())
+                    s.Translate(normal * (offset(rng) / len));
+                points.push_back(s);
+            }
+        }
+        else if (distribution == "clustered")
+        {
+            std::vector<gp_Pnt> centers;
+            for (int c = 0; c < 16; ++c)
+            {
+                const double x = cube(rng), y = cube(rng), z = cube(rng);
+                centers.emplace_back(x, y, z);
+            }
+            std::uniform_int_distribution<int> pick(0, 15);
+            std::normal_distribution<double> g(0.0, 0.05 * r);
+            for (size_t i = 0; i < n; ++i)
+            {
+                const gp_Pnt &c = centers[pick(rng)];
+                const double x = c.X() + g(rng), y = c.Y() + g(rng), z = c.Z() + g(rng);
+                points.push_back(gp_Pnt(x, y, z));
+            }
+        }
+        else
+            return false;
+        return true;
+    }
+
+    // GeomAPI 逐点投影：per_point 为true时每个点构造一次projector（对照组），否则每线程构造一次
+    void project_occt(const Handle(Geom_Surface) & surface, const std::vector<gp_Pnt> &points, std::vector<gp_Pnt> &projected,
+                      size_t n, ProjectionBackend backend, int num_threads, bool per_point)
+    {
+        if (backend == BACKEND_TBB)
+        {
+            tbb::enumerable_thread_specific<GeomAPI_ProjectPointOnSurf> ets_projector;
+            tbb::task_arena arena(num_threads);
+            arena.execute([&] {
+                tbb::parallel_for(size_t(0), n, [&](size_t i) {
+                    if (per_point)
+                    {
+                        GeomAPI_ProjectPointOnSurf projector(points[i], surface);
+                        projected[i] = projector.NearestPoint();
+                        return;
+                    }
+                    auto &projector = ets_projector.local();
+                    projector.Init(points[i], surface);
+                    projected[i] = projector.NearestPoint();
+                });
+            });
+        }
+        else if (backend == BACKEND_OPENMP)
+        {
+#ifdef _OPENMP
+            omp_set_num_threads(num_threads);
+#pragma omp parallel
+            {
+                GeomAPI_ProjectPointOnSurf projector;
+#pragma omp for
+                for (long long i = 0; i < static_cast<long long>(n); ++i)
+                {
+                    if (per_point)
+                    {
+                        GeomAPI_ProjectPointOnSurf local(points[i], surface);
+                        projected[i] = local.NearestPoint();
+                        continue;
+                    }
+                    projector.Init(points[i], surface);
+                    projected[i] = projector.NearestPoint();
+                }
+            }
+#else
+            std::cerr << "OpenMP not enabled!" << std::endl;
+#endif
+        }
+        else
+        {
+            GeomAPI_ProjectPointOnSurf projector;
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (per_point)
+                {
+                    GeomAPI_ProjectPointOnSurf local(points[i], surface);
+                    projected[i] = local.NearestPoint();
+                    continue;
+                }
+                projector.Init(points[i], surface);
+                projected[i] = projector.NearestPoint();
+            }
+        }
+    }
+
+    // 方法: perpoint | fast（GeomAPI），batch（BatchProjector），pooled（跨运行复用工作区），
+    // coherent（Morton热启动），tuned（自动调优调度）
+    std::function<void(size_t, int)> make_runner(const std::string &method, ProjectionBackend backend, BenchContext &ctx)
+    {
+        if (method == "perpoint" || method == "fast")
+        {
+            const bool per_point = method == "perpoint";
+            return [&ctx, backend, per_point](size_t n, int num_threads) {
+                project_occt(ctx.surface, ctx.aos_points, ctx.aos_results, n, backend, num_threads, per_point);
+            };
+        }
+        if (method == "batch")
+        {
+            return [&ctx, backend](size_t n, int num_threads) {
+                project_batch(*ctx.projector, ctx.points.batch(0, n), ctx.results.buffers(), backend, num_threads);
+            };
+        }
+        if (method == "pooled")
+        {
+            return [&ctx, backend](size_t n, int num_threads) {
+                project_batch(*ctx.projector, ctx.points.batch(0, n), ctx.results.buffers(), backend, num_threads, &ctx.workspaces);
+            };
+        }
+        if (method == "mixed")
+        {
+            if (!ctx.mixed_projector)
+                ctx.mixed_projector.reset(new BatchProjector(ctx.surface, true, PRECISION_MIXED));
+            return [&ctx, backend](size_t n, int num_threads) {
+                project_batch(*ctx.mixed_projector, ctx.points.batch(0, n), ctx.results.buffers(), backend, num_threads);
+            };
+        }
+        if (method == "cached")
+        {
+            if (!ctx.seed_cache.is_valid())
+                ctx.seed_cache.build(*ctx.projector, static_cast<int>(std::thread::hardware_concurrency()));
+            return [&ctx, backend](size_t n, int num_threads) {
+                project_batch_cached(ctx.seed_cache, *ctx.projector, ctx.points.batch(0, n), ctx.results.buffers(), backend, num_threads);
+            };
+        }
+        if (method == "tuned")
+        {
+            return [&ctx, backend](size_t n, int num_threads) {
+                const PointBatch input = ctx.points.batch(0, n);
+                if (backend == BACKEND_SERIAL)
+                {
+                    project_batch_serial(*ctx.projector, input, ctx.results.buffers());
+                    return;
+                }
+                std::unique_ptr<ScheduledBatch> &batch = ctx.tuned[std::make_pair(static_cast<int>(backend), num_threads)];
+                if (!batch)
+                {
+                    TuneOptions options;
+                    options.families = backend == BACKEND_OPENMP ? FAMILY_OPENMP : FAMILY_TBB;
+                    bool cached = false;
+                    const ScheduleConfig config = ctx.tuner.select(*ctx.projector, input, num_threads, options, &cached);
+                    std::cout << "    schedule(" << num_threads << " threads): " << schedule_kind_name(config.kind)
+                              << " grain=" << config.grain << " reuse=" << (config.reuse_workspace ? "thread" : "block")
+                              << (cached ? " (cached)" : " (calibrated)") << std::endl;
+                    batch.reset(new ScheduledBatch(config));
+                }
+                batch->run(*ctx.projector, input, ctx.results.buffers(), num_threads);
+            };
+        }
+        if (method == "numa")
+        {
+            return [&ctx](size_t, int) {
+                project_batch_numa(*ctx.projector, ctx.numa_buffers.input(), ctx.numa_buffers.output(), *ctx.numa, &ctx.numa_times);
+            };
+        }
+        if (method == "coherent")
+        {
+            return [&ctx, backend](size_t n, int num_threads) {
+                project_batch_coherent(*ctx.projector, ctx.points.batch(0, n), ctx.results.buffers(), backend, num_threads);
+            };
+        }
+        return std::function<void(size_t, int)>();
+    }
+
+    // 为 numa 方法建立 n 个点、num_threads 个分片的执行器，并按分片首次触碰输入输出
+    void prepare_numa(BenchContext &ctx, ProjectionBackend backend, size_t n, int num_threads)
+    {
+        ctx.numa.reset(new NumaExecutor(ctx.topology, num_threads, ctx.pinning, backend));
+        ctx.numa_buffers.allocate(n);
+        ctx.numa_buffers.first_touch(*ctx.numa, ctx.points.batch(0, n));
+    }
+
+    bool parse_pinning(const std::string &name, ThreadPinning &pinning)
+    {
+        if (name == "none")
+            pinning = PIN_NONE;
+        else if (name == "core")
+            pinning = PIN_CORE;
+        else if (name == "socket")
+            pinning = PIN_SOCKET;
+        else
+            return false;
+        return true;
+    }
+
+    double median_of(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        const size_t n = values.size();
+        return n == 0 ? 0.0 : n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+    }
+
+    bool parse_backend(const std::string &name, ProjectionBackend &backend)
+    {
+        if (name == "serial")
+            backend = BACKEND_SERIAL;
+        else if (name == "omp")
+            backend = BACKEND_OPENMP;
+        else if (name == "tbb")
+            backend = BACKEND_TBB;
+        else
+            return false;
+        return true;
+    }
+
+    void summarize(BenchRecord &record)
+    {
+        std::vector<double> sorted = record.times;
+        std::sort(sorted.begin(), sorted.end());
+        const size_t n = sorted.size();
+        record.min = sorted.front();
+        record.median = n % 2 ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+        record.p95 = sorted[std::min(n - 1, static_cast<size_t>(std::ceil(0.95 * n)) - 1)]; // 最近秩法
+        double sum = 0.0;
+        for (double t : sorted)
+            sum += t;
+        record.mean = sum / n;
+        record.throughput = record.median > 0.0 ? record.points / record.median : 0.0;
+    }
+
+    std::string json_escape(const std::string &s)
+    {
+        std::string out;
+        for (char c : s)
+        {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            out += c;
+        }
+        return out;
+    }
+
+    std::string timestamp()
+    {
+        const std::time_t now = std::time(nullptr);
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        return buffer;
+    }
+
+    bool write_json(const std::string &path, const BenchConfig &config, const std::vector<BenchRecord> &records)
+    {
+        std::ofstream out(path);
+        if (!out)
+            return false;
+        out << std::setprecision(9);
+        out << "{\n  \"meta\": {\n"
+            << "    \"timestamp\": \"" << timestamp() << "\",\n"
+            << "    \"occt_version\": \"" << OCC_VERSION_COMPLETE << "\",\n"
+            << "    \"tbb_version\": \"" << TBB_VERSION_MAJOR << "." << TBB_VERSION_MINOR << "\",\n"
+            << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+            << "    \"numa_nodes\": " << NumaTopology::detect().nb_nodes() << ",\n"
+            << "    \"pinning\": \"" << json_escape(config.pinning) << "\",\n"
+            << "    \"simd\": \"" << simd_level_name(simd_level()) << "\",\n"
+            << "    \"surface\": \"" << json_escape(config.surface) << "\",\n"
+            << "    \"distribution\": \"" << json_escape(config.distribution) << "\",\n"
+            << "    \"points\": " << config.points << ",\n"
+            << "    \"warmup\": " << config.warmup << ",\n"
+            << "    \"repeat\": " << config.repeat << ",\n"
+            << "    \"seed\": " << config.seed << "\n  },\n  \"results\": [\n";
+        for (size_t k = 0; k < records.size(); ++k)
+        {
+            const BenchRecord &r = records[k];
+            out << "    {\"method\": \"" << r.method << "\", \"backend\": \"" << r.backend << "\", \"scaling\": \""
+                << r.scaling << "\", \"threads\": " << r.threads << ", \"points\": " << r.points
+                << ", \"median_s\": " << r.median << ", \"p95_s\": " << r.p95 << ", \"min_s\": " << r.min
+                << ", \"mean_s\": " << r.mean << ", \"throughput_pts_per_s\": " << r.throughput
+                << ", \"speedup\": " << r.speedup << ", \"efficiency\": " << r.efficiency << ", \"times_s\": [";
+            for (size_t t = 0; t < r.times.size(); ++t)
+                out << (t ? ", " : "") << r.times[t];
+            out << "]";
+            if (!r.node_throughput.empty())
+            {
+                out << ", \"node_throughput_pts_per_s\": [";
+                for (size_t node = 0; node < r.node_throughput.size(); ++node)
+                    out << (node ? ", " : "") << r.node_throughput[node];
+                out << "]";
+            }
+            if (r.allocations >= 0)
+                out << ", \"allocations\": " << r.allocations << ", \"allocs_per_point\": "
+                    << static_cast<double>(r.allocations) / r.points;
+            out << "}" << (k + 1 < records.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+
+    bool write_csv(const std::string &path, const BenchConfig &config, const std::vector<BenchRecord> &records)
+    {
+        std::ofstream out(path);
+        if (!out)
+            return false;
+        out << std::setprecision(9);
+        out << "surface,distribution,method,backend,scaling,threads,points,median_s,p95_s,min_s,mean_s,"
+               "throughput_pts_per_s,speedup,efficiency"
+            << (config.count_allocs ? ",allocations,allocs_per_point\n" : "\n");
+        for (const BenchRecord &r : records)
+        {
+            out << config.surface << ',' << config.distribution << ',' << r.method << ',' << r.backend << ','
+                << r.scaling << ',' << r.threads << ',' << r.points << ',' << r.median << ',' << r.p95 << ','
+                << r.min << ',' << r.mean << ',' << r.throughput << ',' << r.speedup << ',' << r.efficiency;
+            if (config.count_allocs)
+                out << ',' << r.allocations << ',' << static_cast<double>(r.allocations) / r.points;
+            out << '\n';
+        }
+        return static_cast<bool>(out);
+    }
+
+    void print_usage()
+    {
+        std::cout << "Usage: DEMO_OCCT_BENCH [options]\n"
+                  << "  --surface plane|cylinder|cone|sphere|torus|nurbs-sphere|nurbs-torus (default sphere)\n"
+                  << "  --distribution uniform|gaussian|shell|clustered (default uniform)\n"
+                  << "  --points N          total points (strong) / points per thread (weak), default 1000000\n"
+                  << "  --threads 1,2,4,... thread counts to sweep, default powers of two up to hardware threads\n"
+                  << "  --methods LIST      perpoint,fast,batch,pooled,mixed,coherent,cached,tuned,numa (default fast,batch)\n"
+                  << "  --pinning MODE      none|core|socket thread pinning for the numa method (default core)\n"
+                  << "  --schedule-cache F  schedule cache for the tuned method (calibrated during warmup, saved on exit)\n"
+                  << "  --count-allocs 0|1  count heap allocations in one extra untimed run per record (default 0)\n"
+                  << "  --backends LIST     serial,omp,tbb (default serial,omp,tbb)\n"
+                  << "  --scaling LIST      strong,weak (default strong)\n"
+                  << "  --warmup N --repeat N --seed N --scale R\n"
+                  << "  --json FILE --csv FILE" << std::endl;
+    }
+
+    bool parse_args(int argc, char **argv, BenchConfig &config)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h")
+                return false;
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+            const std::string value = argv[++i];
+            if (arg == "--surface")
+                config.surface = value;
+            else if (arg == "--distribution")
+                config.distribution = value;
+            else if (arg == "--points")
+                config.points = static_cast<size_t>(std::atoll(value.c_str()));
+            else if (arg == "--threads")
+            {
+                config.threads.clear();
+                for (const std::string &t : split_list(value))
+                    config.threads.push_back(std::max(1, std::atoi(t.c_str())));
+            }
+            else if (arg == "--methods")
+                config.methods = split_list(value);
+            else if (arg == "--pinning")
+                config.pinning = value;
+            else if (arg == "--schedule-cache")
+                config.schedule_cache = value;
+            else if (arg == "--count-allocs")
+                config.count_allocs = std::atoi(value.c_str()) != 0;
+            else if (arg == "--backends")
+                config.backends = split_list(value);
+            else if (arg == "--scaling")
+                config.scalings = split_list(value);
+            else if (arg == "--warmup")
+                config.warmup = std::max(0, std::atoi(value.c_str()));
+            else if (arg == "--repeat")
+                config.repeat = std::max(1, std::atoi(value.c_str()));
+            else if (arg == "--seed")
+                config.seed = static_cast<unsigned>(std::atoll(value.c_str()));
+            else if (arg == "--scale")
+                config.scale = std::atof(value.c_str());
+            else if (arg == "--json")
+                config.json_path = value;
+            else if (arg == "--csv")
+                config.csv_path = value;
+            else
+            {
+                std::cerr << "Unknown option " << arg << std::endl;
+                return false;
+            }
+        }
+        if (config.threads.empty())
+        {
+            const int hw = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            for (int t = 1; t < hw; t *= 2)
+                config.threads.push_back(t);
+            config.threads.push_back(hw);
+        }
+        return config.points > 0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    BenchConfig config;
+    if (!parse_args(argc, argv, config))
+    {
+        print_usage();
+        return 1;
+    }
+
+    BenchContext ctx;
+    ctx.surface = make_surface(config.surface, config.scale);
+    if (ctx.surface.IsNull())
+    {
+        std::cerr << "Unknown surface " << config.surface << std::endl;
+        return 1;
+    }
+    ctx.projector.reset(new BatchProjector(ctx.surface));
+    if (!parse_pinning(config.pinning, ctx.pinning))
+    {
+        std::cerr << "Unknown pinning " << config.pinning << std::endl;
+        return 1;
+    }
+    ctx.topology = NumaTopology::detect();
+    if (!config.schedule_cache.empty())
+        ctx.tuner.load(config.schedule_cache);
+
+    // 弱扩展需要 points * 最大线程数 个点；只生成一次，各次运行取前缀
+    const int max_threads = *std::max_element(config.threads.begin(), config.threads.end());
+    const bool weak = std::find(config.scalings.begin(), config.scalings.end(), "weak") != config.scalings.end();
+    const size_t total = weak ? config.points * max_threads : config.points;
+    if (!generate_points(ctx.surface, config.distribution, total, config.scale, config.seed, ctx.points))
+    {
+        std::cerr << "Unknown distribution " << config.distribution << std::endl;
+        return 1;
+    }
+    ctx.results.resize(total);
+    const bool need_aos = std::find(config.methods.begin(), config.methods.end(), "fast") != config.methods.end() ||
+                          std::find(config.methods.begin(), config.methods.end(), "perpoint") != config.methods.end();
+    if (need_aos)
+    {
+        ctx.aos_points.reserve(total);
+        for (size_t i = 0; i < total; ++i)
+            ctx.aos_points.emplace_back(ctx.points.x[i], ctx.points.y[i], ctx.points.z[i]);
+        ctx.aos_results.resize(total);
+    }
+
+    std::cout << "surface=" << config.surface << " distribution=" << config.distribution << " points=" << config.points
+              << " warmup=" << config.warmup << " repeat=" << config.repeat << " seed=" << config.seed
+              << " numa_nodes=" << ctx.topology.nb_nodes() << " simd=" << simd_level_name(simd_level()) << " OCCT " << OCC_VERSION_COMPLETE << std::endl;
+    if (config.count_allocs && !allocation_counting_covers_malloc())
+        std::cout << "note: allocation counting sees operator new only on this platform (malloc inside OCCT is not counted)" << std::endl;
+    std::cout << std::left << std::setw(10) << "method" << std::setw(8) << "backend" << std::setw(8) << "scaling"
+              << std::right << std::setw(8) << "threads" << std::setw(12) << "points" << std::setw(12) << "median(s)"
+              << std::setw(12) << "p95(s)" << std::setw(14) << "Mpts/s" << std::setw(10) << "speedup"
+              << std::setw(8) << "eff(%)" << std::endl;
+
+    std::vector<BenchRecord> records;
+    for (const std::string &method : config.methods)
+    {
+        for (const std::string &backend_name : config.backends)
+        {
+            ProjectionBackend backend;
+            std::function<void(size_t, int)> runner;
+            if (!parse_backend(backend_name, backend) || !(runner = make_runner(method, backend, ctx)))
+            {
+                std::cerr << "Skipping unknown method/backend " << method << "/" << backend_name << std::endl;
+                continue;
+            }
+            for (const std::string &scaling : config.scalings)
+            {
+                if (scaling != "strong" && scaling != "weak")
+                    continue;
+                const std::vector<int> sweep = backend == BACKEND_SERIAL ? std::vector<int>(1, 1) : config.threads;
+                const size_t first_record = records.size();
+                for (int t : sweep)
+                {
+                    BenchRecord record;
+                    record.method = method, record.backend = backend_name, record.scaling = scaling;
+                    record.threads = t;
+                    record.points = scaling == "weak" ? config.points * t : config.points;
+                    const bool numa = method == "numa";
+                    if (numa)
+                        prepare_numa(ctx, backend, record.points, t);
+                    for (int w = 0; w < config.warmup; ++w)
+                        runner(record.points, t);
+                    std::vector<std::vector<double>> node_runs; // [节点][重复]
+                    for (int r = 0; r < config.repeat; ++r)
+                    {
+                        const auto start = std::chrono::steady_clock::now();
+                        runner(record.points, t);
+                        record.times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                        if (numa)
+                        {
+                            const std::vector<double> nodes = ctx.numa->node_throughput(record.points, ctx.numa_times);
+                            node_runs.resize(nodes.size());
+                            for (size_t node = 0; node < nodes.size(); ++node)
+                                node_runs[node].push_back(nodes[node]);
+                        }
+                    }
+                    if (config.count_allocs)
+                    {
+                        // 计时之后再跑一次：此时工作区、调度缓存等一次性状态都已建好，计数即稳态值
+                        allocation_counting_begin();
+                        runner(record.points, t);
+                        record.allocations = static_cast<long long>(allocation_counting_end());
+                    }
+                    summarize(record);
+                    for (const std::vector<double> &runs : node_runs)
+                        record.node_throughput.push_back(median_of(runs));
+
+                    // 以扫描的第一个线程数为基准：强扩展看加速比，弱扩展看耗时是否保持不变
+                    const BenchRecord &base = records.size() > first_record ? records[first_record] : record;
+                    const double ratio = static_cast<double>(t) / base.threads;
+                    if (scaling == "strong")
+                    {
+                        record.speedup = base.median / record.median;
+                        record.efficiency = record.speedup / ratio;
+                    }
+                    else
+                    {
+                        record.efficiency = base.median / record.median;
+                        record.speedup = record.efficiency * ratio;
+                    }
+                    records.push_back(record);
+
+                    std::cout << std::left << std::setw(10) << method << std::setw(8) << backend_name << std::setw(8)
+                              << scaling << std::right << std::setw(8) << t << std::setw(12) << record.points
+                              << std::fixed << std::setprecision(4) << std::setw(12) << record.median << std::setw(12)
+                              << record.p95 << std::setprecision(3) << std::setw(14) << record.throughput / 1e6
+                              << std::setprecision(2) << std::setw(10) << record.speedup << std::setprecision(1)
+                              << std::setw(8) << 100.0 * record.efficiency << std::defaultfloat << std::endl;
+                    for (size_t node = 0; node < record.node_throughput.size(); ++node)
+                    {
+                        if (record.node_throughput[node] > 0.0)
+                            std::cout << "    node " << node << ": " << std::fixed << std::setprecision(3)
+                                      << record.node_throughput[node] / 1e6 << " Mpts/s" << std::defaultfloat << std::endl;
+                    }
+                    if (record.allocations >= 0)
+                        std::cout << "    allocations: " << record.allocations << " per run, "
+                                  << static_cast<double>(record.allocations) / record.points << " per point" << std::endl;
+                }
+            }
+        }
+    }
+
+    if (!config.schedule_cache.empty() && ctx.tuner.size() > 0)
+        ctx.tuner.save(config.schedule_cache);
+    if (!config.json_path.empty() && !write_json(config.json_path, config, records))
+        std::cerr << "Failed to write " << config.json_path << std::endl;
+    if (!config.csv_path.empty() && !write_csv(config.csv_path, config, records))
+        std::cerr << "Failed to write " << config.csv_path << std::endl;
+    return 0;
+}
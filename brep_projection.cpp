@@ -0,0 +1,481 @@
+#include "brep_projection.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <Precision.hxx>
+#include <Bnd_Box.hxx>
+#include <gp_Pnt2d.hxx>
+#include <TopAbs_ShapeEnum.hxx>
+#include <TopAbs_State.hxx>
+#include <TopoDS.hxx>
+#include <TopExp.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepTools.hxx>
+#include <IGESControl_Reader.hxx>
+#include <STEPControl_Reader.hxx>
+#include <IFSelect_ReturnStatus.hxx>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/task_arena.h>
+#include <tbb/enumerable_thread_specific.h>
+
+namespace
+{
+    const int MAX_LEAF_SIZE = 4;        // BVH叶子节点的元素数上限
+    const size_t BREP_GRAIN_SIZE = 64;  // 每点开销远大于单曲面投影，并行划分粒度取小一些
+
+    inline double box_dist2(const double box[6], double x, double y, double z)
+    {
+        const double dx = std::max(std::max(box[0] - x, x - box[3]), 0.0);
+        const double dy = std::max(std::max(box[1] - y, y - box[4]), 0.0);
+        const double dz = std::max(std::max(box[2] - z, z - box[5]), 0.0);
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    // 把形状的包围盒按容差放大后写入box，空包围盒返回false
+    bool shape_box(const TopoDS_Shape &shape, double tolerance, double box[6])
+    {
+        Bnd_Box bnd;
+        BRepBndLib::Add(shape, bnd, Standard_False); // 按几何计算，不依赖可能偏内的三角化
+        if (bnd.IsVoid())
+            return false;
+        bnd.Enlarge(tolerance);
+        bnd.Get(box[0], box[1], box[2], box[3], box[4], box[5]);
+        return true;
+    }
+
+    // 周期参数折回 [tmin, tmin + period)
+    inline double fold_param(double t, double tmin, bool periodic, double period)
+    {
+        if (!periodic || period <= 0.0)
+            return t;
+        t = tmin + std::fmod(t - tmin, period);
+        return t < tmin ? t + period : t;
+    }
+
+    // 面优先：距离相同时（投影点落在面的边界上）保留面的UV
+    inline bool is_better(const BRepProjectionResult &candidate, const BRepProjectionResult &best)
+    {
+        if (best.type == BREP_NONE)
+            return true;
+        if (candidate.type == best.type)
+            return candidate.distance < best.distance;
+        if (candidate.type == BREP_FACE)
+            return candidate.distance <= best.distance + Precision::Confusion();
+        return candidate.distance < best.distance - Precision::Confusion();
+    }
+
+    inline double prune_limit2(const BRepProjectionResult &best)
+    {
+        if (best.type == BREP_NONE)
+            return std::numeric_limits<double>::infinity();
+        const double limit = best.distance + Precision::Confusion();
+        return limit * limit;
+    }
+}
+
+TopoDS_Shape load_cad_shape(const std::string &path)
+{
+    std::string ext = path.substr(path.find_last_of('.') == std::string::npos ? path.size() : path.find_last_of('.') + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    TopoDS_Shape shape;
+    if (ext == "igs" || ext == "iges")
+    {
+        IGESControl_Reader reader;
+        if (reader.ReadFile(path.c_str()) != IFSelect_RetDone)
+        {
+            std::cerr << "Failed to read IGES file: " << path << std::endl;
+            return shape;
+        }
+        reader.TransferRoots();
+        shape = reader.OneShape();
+    }
+    else if (ext == "stp" || ext == "step")
+    {
+        STEPControl_Reader reader;
+        if (reader.ReadFile(path.c_str()) != IFSelect_RetDone)
+        {
+            std::cerr << "Failed to read STEP file: " << path << std::endl;
+            return shape;
+        }
+        reader.TransferRoots();
+        shape = reader.OneShape();
+    }
+    else
+    {
+        std::cerr << "Unsupported CAD file extension: " << path << std::endl;
+        return shape;
+    }
+
+    if (shape.IsNull())
+        std::cerr << "No shape transferred from: " << path << std::endl;
+    return shape;
+}
+
+BRepProjector::BRepProjector(const TopoDS_Shape &shape)
+{
+    if (shape.IsNull())
+        return;
+    TopExp::MapShapes(shape, TopAbs_FACE, faces_);
+    TopExp::MapShapes(shape, TopAbs_EDGE, edges_);
+
+    // 面
+    face_data_.resize(faces_.Extent());
+    for (int i = 1; i <= faces_.Extent(); ++i)
+    {
+        const TopoDS_Face &f = TopoDS::Face(faces_(i));
+        Handle(Geom_Surface) surface = BRep_Tool::Surface(f);
+        Element element;
+        if (surface.IsNull() || !shape_box(f, BRep_Tool::Tolerance(f), element.box))
+            continue;
+
+        FaceData &data = face_data_[i - 1];
+        data.projector.reset(new BatchProjector(surface));
+        data.classifier.reset(new BRepTopAdaptor_FClass2d(f, Precision::PConfusion()));
+        data.domain = surface_param_domain(surface);
+        BRepTools::UVBounds(f, data.umin, data.umax, data.vmin, data.vmax);
+
+        element.type = BREP_FACE;
+        element.index = i;
+        elements_.push_back(element);
+    }
+
+    // 边（跳过退化边和没有三维曲线的边）
+    edge_projectors_.resize(edges_.Extent());
+    for (int i = 1; i <= edges_.Extent(); ++i)
+    {
+        const TopoDS_Edge &e = TopoDS::Edge(edges_(i));
+        if (BRep_Tool::Degenerated(e))
+            continue;
+        double first = 0.0, last = 0.0;
+        Handle(Geom_Curve) curve = BRep_Tool::Curve(e, first, last);
+        Element element;
+        if (curve.IsNull() || !shape_box(e, BRep_Tool::Tolerance(e), element.box))
+            continue;
+        edge_projectors_[i - 1].reset(new CurveProjector(curve, first, last));
+        element.type = BREP_EDGE;
+        element.index = i;
+        elements_.push_back(element);
+    }
+
+    if (elements_.empty())
+        return;
+
+    // BVH
+    std::vector<double> centers(elements_.size() * 3);
+    order_.resize(elements_.size());
+    for (size_t k = 0; k < elements_.size(); ++k)
+    {
+        for (int c = 0; c < 3; ++c)
+            centers[3 * k + c] = 0.5 * (elements_[k].box[c] + elements_[k].box[c + 3]);
+        order_[k] = static_cast<int>(k);
+    }
+    nodes_.reserve(2 * elements_.size());
+    nodes_.resize(1);
+    build_node(0, 0, static_cast<int>(elements_.size()), centers);
+}
+
+void BRepProjector::build_node(int node, int begin, int end, const std::vector<double> &centers)
+{
+    Node &n = nodes_[node];
+    n.box[0] = n.box[1] = n.box[2] = std::numeric_limits<double>::max();
+    n.box[3] = n.box[4] = n.box[5] = -std::numeric_limits<double>::max();
+    double clo[3] = {n.box[0], n.box[1], n.box[2]}, chi[3] = {n.box[3], n.box[4], n.box[5]};
+    for (int k = begin; k < end; ++k)
+    {
+        const Element &e = elements_[order_[k]];
+        for (int c = 0; c < 3; ++c)
+        {
+            n.box[c] = std::min(n.box[c], e.box[c]);
+            n.box[c + 3] = std::max(n.box[c + 3], e.box[c + 3]);
+            clo[c] = std::min(clo[c], centers[3 * order_[k] + c]);
+            chi[c] = std::max(chi[c], centers[3 * order_[k] + c]);
+        }
+    }
+
+    if (end - begin <= MAX_LEAF_SIZE)
+    {
+        n.first = begin;
+        n.count = end - begin;
+        return;
+    }
+
+    // 按元素中心的最长轴取中位数划分
+    int axis = 0;
+    for (int c = 1; c < 3; ++c)
+    {
+        if (chi[c] - clo[c] > chi[axis] - clo[axis])
+            axis = c;
+    }
+    const int mid = (begin + end) / 2;
+    std::nth_element(order_.begin() + begin, order_.begin() + mid, order_.begin() + end,
+                     [&](int a, int b) { return centers[3 * a + axis] < centers[3 * b + axis]; });
+
+    const int left = static_cast<int>(nodes_.size());
+    n.first = left;
+    n.count = 0;
+    nodes_.resize(nodes_.size() + 2); // n 此后失效
+    build_node(left, begin, mid, centers);
+    build_node(left + 1, mid, end, centers);
+}
+
+const TopoDS_Face &BRepProjector::face(int index) const
+{
+    return TopoDS::Face(faces_(index));
+}
+
+const TopoDS_Edge &BRepProjector::edge(int index) const
+{
+    return TopoDS::Edge(edges_(index));
+}
+
+bool BRepProjector::project_face(int index, const gp_Pnt &p, double best_distance, BRepProjectionWorkspace &workspace,
+                                 BRepProjectionResult &candidate) const
+{
+    const FaceData &data = face_data_[index - 1];
+    const BatchProjector &projector = *data.projector;
+
+    // 先在整张曲面上求全局最近点
+    LocalProjectionResult local;
+    bool found = false;
+    if (projector.is_analytic())
+    {
+        const double x = p.X(), y = p.Y(), z = p.Z();
+        double px, py, pz;
+        unsigned char degenerate = 0;
+        analytic_project_kernel(projector.analytic(), 1, &x, &y, &z, &px, &py, &pz,
+                                &local.u, &local.v, &local.distance, &degenerate);
+        local.point.SetCoord(px, py, pz);
+        found = !degenerate;
+    }
+    if (!found)
+        found = projector.project_point(p, workspace.surface, local);
+    if (!found)
+        return false;
+
+    const double u = fold_param(local.u, data.umin, data.domain.uperiodic, data.domain.uperiod);
+    const double v = fold_param(local.v, data.vmin, data.domain.vperiodic, data.domain.vperiod);
+    const TopAbs_State state = data.classifier->Perform(gp_Pnt2d(u, v));
+    if (state == TopAbs_IN || state == TopAbs_ON)
+    {
+        candidate.point = local.point;
+        candidate.u = u, candidate.v = v;
+        candidate.distance = local.distance;
+        candidate.type = BREP_FACE;
+        candidate.element = index;
+        return true;
+    }
+
+    // 落在面外：曲面上的全局最近距离是面的距离下界，已不可能更近时直接放弃；
+    // 否则在面的UV范围内求全部极值，取落在面内的最近者（面内没有极值时最近点在边界上，由边给出）
+    if (local.distance > best_distance + Precision::Confusion())
+        return false;
+    GeomAPI_ProjectPointOnSurf &extrema = workspace.face_extrema;
+    const double *bounds = workspace.face_extrema_bounds;
+    if (workspace.face_extrema_surface != projector.surface() || bounds[0] != data.umin || bounds[1] != data.umax ||
+        bounds[2] != data.vmin || bounds[3] != data.vmax)
+    {
+        extrema.Init(projector.surface(), data.umin, data.umax, data.vmin, data.vmax);
+        workspace.face_extrema_surface = projector.surface();
+        workspace.face_extrema_bounds[0] = data.umin, workspace.face_extrema_bounds[1] = data.umax;
+        workspace.face_extrema_bounds[2] = data.vmin, workspace.face_extrema_bounds[3] = data.vmax;
+    }
+    extrema.Perform(p);
+    bool inside = false;
+    for (int k = 1; k <= extrema.NbPoints(); ++k)
+    {
+        const double d = extrema.Distance(k);
+        if (inside && d >= candidate.distance)
+            continue;
+        double uk, vk;
+        extrema.Parameters(k, uk, vk);
+        const TopAbs_State sk = data.classifier->Perform(gp_Pnt2d(uk, vk));
+        if (sk != TopAbs_IN && sk != TopAbs_ON)
+            continue;
+        candidate.point = extrema.Point(k);
+        candidate.u = uk, candidate.v = vk;
+        candidate.distance = d;
+        inside = true;
+    }
+    if (!inside)
+        return false;
+    candidate.type = BREP_FACE;
+    candidate.element = index;
+    return true;
+}
+
+bool BRepProjector::project_edge(int index, const gp_Pnt &p, BRepProjectionWorkspace &workspace,
+                                 BRepProjectionResult &candidate) const
+{
+    LocalProjectionResult local;
+    if (!edge_projectors_[index - 1]->project_point(p, workspace.curve, local))
+        return false;
+    candidate.point = local.point;
+    candidate.u = local.u;
+    candidate.v = 0.0;
+    candidate.distance = local.distance;
+    candidate.type = BREP_EDGE;
+    candidate.element = index;
+    return true;
+}
+
+bool BRepProjector::project_element(const Element &element, const gp_Pnt &p, double best_distance,
+                                    BRepProjectionWorkspace &workspace, BRepProjectionResult &candidate) const
+{
+    if (element.type == BREP_FACE)
+        return project_face(element.index, p, best_distance, workspace, candidate);
+    return project_edge(element.index, p, workspace, candidate);
+}
+
+bool BRepProjector::project_point(const gp_Pnt &p, BRepProjectionWorkspace &workspace,
+                                  BRepProjectionResult &result) const
+{
+    result = BRepProjectionResult();
+    if (nodes_.empty())
+        return false;
+
+    const double x = p.X(), y = p.Y(), z = p.Z();
+    BRepProjectionResult candidate;
+    auto &stack = workspace.stack;
+    stack.clear();
+    stack.emplace_back(0, box_dist2(nodes_[0].box, x, y, z));
+    while (!stack.empty())
+    {
+        const std::pair<int, double> top = stack.back();
+        stack.pop_back();
+        if (top.second > prune_limit2(result))
+            continue;
+
+        const Node &node = nodes_[top.first];
+        if (node.count > 0)
+        {
+            for (int k = node.first; k < node.first + node.count; ++k)
+            {
+                const Element &element = elements_[order_[k]];
+                if (box_dist2(element.box, x, y, z) > prune_limit2(result))
+                    continue;
+                const double best = result.type == BREP_NONE ? std::numeric_limits<double>::infinity() : result.distance;
+                if (project_element(element, p, best, workspace, candidate) && is_better(candidate, result))
+                    result = candidate;
+            }
+            continue;
+        }
+
+        // 远的孩子先入栈，近的先出栈
+        const int a = node.first, b = node.first + 1;
+        const double da = box_dist2(nodes_[a].box, x, y, z), db = box_dist2(nodes_[b].box, x, y, z);
+        if (da <= db)
+        {
+            stack.emplace_back(b, db);
+            stack.emplace_back(a, da);
+        }
+        else
+        {
+            stack.emplace_back(a, da);
+            stack.emplace_back(b, db);
+        }
+    }
+    return result.type != BREP_NONE;
+}
+
+bool BRepProjector::project_point_brute_force(const gp_Pnt &p, BRepProjectionWorkspace &workspace,
+                                              BRepProjectionResult &result) const
+{
+    result = BRepProjectionResult();
+    BRepProjectionResult candidate;
+    for (const Element &element : elements_)
+    {
+        const double best = result.type == BREP_NONE ? std::numeric_limits<double>::infinity() : result.distance;
+        if (project_element(element, p, best, workspace, candidate) && is_better(candidate, result))
+            result = candidate;
+    }
+    return result.type != BREP_NONE;
+}
+
+void BRepProjector::project_range(const PointBatch &input, const ProjectionBuffers &output,
+                                  const BRepElementBuffers &elements, size_t begin, size_t end,
+                                  BRepProjectionWorkspace &workspace) const
+{
+    BRepProjectionResult result;
+    for (size_t i = begin; i < end; ++i)
+    {
+        const gp_Pnt p(input.x[i], input.y[i], input.z[i]);
+        const bool finite = std::isfinite(p.X()) && std::isfinite(p.Y()) && std::isfinite(p.Z());
+        if (!finite || !project_point(p, workspace, result))
+        {
+            output.x[i] = p.X(), output.y[i] = p.Y(), output.z[i] = p.Z();
+            output.status[i] = finite ? PROJECTION_NOT_DONE : PROJECTION_INVALID_INPUT;
+            if (elements.element)
+                elements.element[i] = 0;
+            if (elements.type)
+                elements.type[i] = BREP_NONE;
+            continue;
+        }
+        output.x[i] = result.point.X(), output.y[i] = result.point.Y(), output.z[i] = result.point.Z();
+        if (output.u)
+            output.u[i] = result.u;
+        if (output.v)
+            output.v[i] = result.v;
+        if (output.distance)
+            output.distance[i] = result.distance;
+        output.status[i] = PROJECTION_OK;
+        if (elements.element)
+            elements.element[i] = result.element;
+        if (elements.type)
+            elements.type[i] = result.type;
+    }
+}
+
+void project_brep_batch(const BRepProjector &projector, const PointBatch &input, const ProjectionBuffers &output,
+                        const BRepElementBuffers &elements, ProjectionBackend backend, int num_threads)
+{
+    if (backend == BACKEND_TBB)
+    {
+        tbb::enumerable_thread_specific<BRepProjectionWorkspace> ets_workspace;
+        tbb::task_arena arena(num_threads);
+        arena.execute([&] {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, input.count, BREP_GRAIN_SIZE), [&](const tbb::blocked_range<size_t> &r) {
+                auto &workspace = ets_workspace.local(); // 每个线程只构造一次
+                projector.project_range(input, output, elements, r.begin(), r.end(), workspace);
+            });
+        });
+    }
+    else if (backend == BACKEND_OPENMP)
+    {
+#ifdef _OPENMP
+        const size_t num_points = input.count;
+        const int num_blocks = static_cast<int>((num_points + BREP_GRAIN_SIZE - 1) / BREP_GRAIN_SIZE);
+        omp_set_num_threads(num_threads);
+#pragma omp parallel
+        {
+            BRepProjectionWorkspace workspace; // 每个线程只构造一次
+            // 每点遍历的元素数随位置变化很大，用动态调度
+#pragma omp for schedule(dynamic)
+            for (int b = 0; b < num_blocks; ++b)
+            {
+                const size_t begin = static_cast<size_t>(b) * BREP_GRAIN_SIZE;
+                const size_t end = std::min(begin + BREP_GRAIN_SIZE, num_points);
+                projector.project_range(input, output, elements, begin, end, workspace);
+            }
+        }
+#else
+        std::cerr << "OpenMP not enabled!" << std::endl;
+#endif
+    }
+    else
+    {
+        BRepProjectionWorkspace workspace;
+        projector.project_range(input, output, elements, 0, input.count, workspace);
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gp_Pnt.hxx>
+#include <TopoDS_Shape.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <BRepTopAdaptor_FClass2d.hxx>
+
+#include "batch_projection.h"
+#include "curve_projection.h"
+
+// 读取CAD模型，按扩展名选择IGES（.igs/.iges）或STEP（.stp/.step）读取器
+// 失败时返回空形状并输出错误信息
+TopoDS_Shape load_cad_shape(const std::string &path);
+
+// 最近元素类型
+enum BRepElementType : unsigned char
+{
+    BREP_NONE = 0,
+    BREP_FACE = 1,
+    BREP_EDGE = 2
+};
+
+// 点到BRep模型的投影结果
+// element为面或边在 TopExp::MapShapes 映射中的序号（从1开始），
+// 面返回曲面参数(u, v)，边返回曲线参数u（v为0）
+struct BRepProjectionResult
+{
+    gp_Pnt point;
+    double u = 0.0, v = 0.0;
+    double distance = 0.0;
+    int element = 0;
+    BRepElementType type = BREP_NONE;
+};
+
+// 批量投影的元素输出（可置空）
+struct BRepElementBuffers
+{
+    int *element = nullptr;
+    unsigned char *type = nullptr;
+};
+
+// 每个线程私有的BRep投影工作区
+struct BRepProjectionWorkspace
+{
+    std::vector<std::pair<int, double>> stack; // BVH遍历栈：节点下标、包围盒距离平方下界
+    ProjectionWorkspace surface;               // 面投影工作区
+    // 面UV范围内求全部极值用的投影器；与 surface.projector（绑定整个曲面）分开，
+    // 按 (曲面, UV范围) 绑定一次，之后逐点 Perform
+    GeomAPI_ProjectPointOnSurf face_extrema;
+    Handle(Geom_Surface) face_extrema_surface;
+    double face_extrema_bounds[4] = {0.0, 0.0, 0.0, 0.0};
+    CurveProjectionWorkspace curve;            // 边投影工作区
+};
+
+// 点到BRep模型（IGES/STEP）的全局最近点投影
+// - 收集模型中所有面和边，为每个元素计算包围盒并构建BVH（按最长轴中位数划分）
+// - 每个面持有一个 BatchProjector（闭式内核/预处理曲面）和预构建的二维分类器，
+//   投影点落在面边界外时舍弃，由边界上的边给出最近点；每条边持有一个 CurveProjector
+// - 查询时按包围盒下界由近到远遍历BVH，下界不小于当前最近距离的子树直接剪枝
+// 构造后只读，可被多个线程共享；每个线程持有自己的 BRepProjectionWorkspace
+class BRepProjector
+{
+public:
+    explicit BRepProjector(const TopoDS_Shape &shape);
+
+    int nb_faces() const { return faces_.Extent(); }
+    int nb_edges() const { return edges_.Extent(); }
+    size_t nb_nodes() const { return nodes_.size(); }
+    const TopoDS_Face &face(int index) const;
+    const TopoDS_Edge &edge(int index) const;
+
+    // 单点投影，模型中没有可投影元素时返回false
+    bool project_point(const gp_Pnt &p, BRepProjectionWorkspace &workspace, BRepProjectionResult &result) const;
+
+    // 不使用BVH，逐个元素投影（用于校验）
+    bool project_point_brute_force(const gp_Pnt &p, BRepProjectionWorkspace &workspace,
+                                   BRepProjectionResult &result) const;
+
+    // 单线程投影 input[begin, end)，结果写到 output 的相同下标处
+    void project_range(const PointBatch &input, const ProjectionBuffers &output, const BRepElementBuffers &elements,
+                       size_t begin, size_t end, BRepProjectionWorkspace &workspace) const;
+
+private:
+    // 参与投影的元素（面或边）
+    struct Element
+    {
+        double box[6]; // xmin, ymin, zmin, xmax, ymax, zmax
+        BRepElementType type;
+        int index;     // 在 faces_ 或 edges_ 中的序号
+    };
+
+    struct FaceData
+    {
+        std::unique_ptr<BatchProjector> projector;
+        std::unique_ptr<BRepTopAdaptor_FClass2d> classifier;
+        SurfaceParamDomain domain;
+        double umin, umax, vmin, vmax; // 面的UV范围，周期方向的投影参数折回该范围再分类
+    };
+
+    // BVH节点：叶子节点 count > 0，元素为 order_[first, first + count)；内部节点左右孩子为 first、first + 1
+    struct Node
+    {
+        double box[6];
+        int first;
+        int count;
+    };
+
+    void build_node(int node, int begin, int end, const std::vector<double> &centers);
+    // best_distance为当前最近距离，面投影据此跳过不可能更近的边界内搜索
+    bool project_element(const Element &element, const gp_Pnt &p, double best_distance,
+                         BRepProjectionWorkspace &workspace, BRepProjectionResult &candidate) const;
+    bool project_face(int index, const gp_Pnt &p, double best_distance, BRepProjectionWorkspace &workspace,
+                      BRepProjectionResult &candidate) const;
+    bool project_edge(int index, const gp_Pnt &p, BRepProjectionWorkspace &workspace,
+                      BRepProjectionResult &candidate) const;
+
+    TopTools_IndexedMapOfShape faces_, edges_;
+    std::vector<FaceData> face_data_; // 下标为序号 - 1
+    std::vector<std::unique_ptr<CurveProjector>> edge_projectors_; // 只投影到边的参数范围
+    std::vector<Element> elements_;
+    std::vector<int> order_;          // 叶子节点引用的元素下标
+    std::vector<Node> nodes_;         // nodes_[0] 为根节点
+};
+
+// 按后端分派的BRep批量投影，elements 中的数组可置空
+void project_brep_batch(const BRepProjector &projector, const PointBatch &input, const ProjectionBuffers &output,
+                        const BRepElementBuffers &elements, ProjectionBackend backend, int num_threads);
@@ -0,0 +1,564 @@
+#include "cgns_snapping.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#include <cgnslib.h>
+
+#include <tbb/task_group.h>
+
+namespace
+{
+    const cgsize_t ELEMENT_CHUNK = 1 << 16; // 读取单元连接关系的分块大小
+
+    // 打开的CGNS文件，析构时关闭
+    struct CgnsFile
+    {
+        int fn = -1;
+        ~CgnsFile()
+        {
+            if (fn >= 0)
+                cg_close(fn);
+        }
+    };
+
+    bool cg_check(int ier, const char *what)
+    {
+        if (ier == CG_OK)
+            return true;
+        std::cerr << "CGNS error in " << what << ": " << cg_get_error() << std::endl;
+        return false;
+    }
+
+    double seconds_since(const std::chrono::high_resolution_clock::time_point &start)
+    {
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // 区域的节点编号方式：非结构网格为1开始的节点号，结构网格按 i 最快的顺序线性化
+    struct ZoneLayout
+    {
+        bool structured = false;
+        int index_dim = 1;
+        cgsize_t dims[3] = {0, 0, 0}; // 各方向节点数
+        cgsize_t nb_nodes = 0;
+        cgsize_t slab = 1;            // 结构网格最后一个索引方向一层的节点数
+
+        cgsize_t linear(const cgsize_t *ijk) const
+        {
+            cgsize_t id = 0;
+            for (int d = index_dim - 1; d >= 0; --d)
+                id = id * dims[d] + (ijk[d] - 1);
+            return id + 1;
+        }
+    };
+
+    // 坐标块：节点号 [first, last]（1开始，闭区间）及其中需要贴合的边界节点
+    struct CoordChunk
+    {
+        cgsize_t first = 0, last = 0;
+        std::vector<double> coords[3];
+        std::vector<size_t> local;        // 边界节点在块内的偏移
+        PointArrays points;
+        ProjectionResultArrays results;
+        SnapStats stats;                  // 只累计 snapped/rejected/failed/max_displacement
+    };
+
+    // BC引用的单元集合：区间或有序列表
+    struct ElementSet
+    {
+        bool is_range = true;
+        cgsize_t lo = 0, hi = -1;
+        std::vector<cgsize_t> list;
+
+        bool contains(cgsize_t e) const
+        {
+            if (e < lo || e > hi)
+                return false;
+            return is_range || std::binary_search(list.begin(), list.end(), e);
+        }
+    };
+
+    // 收集单元集合中所有单元的节点号，逐分区按块读取连接关系
+    bool collect_element_nodes(int fn, int B, int Z, const ElementSet &set, std::vector<cgsize_t> &nodes)
+    {
+        int nsections = 0;
+        if (!cg_check(cg_nsections(fn, B, Z, &nsections), "cg_nsections"))
+            return false;
+        std::vector<cgsize_t> conn, offsets;
+        for (int S = 1; S <= nsections; ++S)
+        {
+            char name[33];
+            CGNS_ENUMT(ElementType_t) type;
+            cgsize_t start = 0, end = 0;
+            int nbndry = 0, parent_flag = 0;
+            if (!cg_check(cg_section_read(fn, B, Z, S, name, &type, &start, &end, &nbndry, &parent_flag), "cg_section_read"))
+                return false;
+            const cgsize_t lo = std::max(start, set.lo), hi = std::min(end, set.hi);
+            if (lo > hi)
+                continue;
+            if (type == CGNS_ENUMV(NFACE_n))
+            {
+                std::cerr << "Skipping NFACE_n section " << name << " referenced by a boundary condition" << std::endl;
+                continue;
+            }
+
+            const bool poly = type == CGNS_ENUMV(MIXED) || type == CGNS_ENUMV(NGON_n);
+            int npe = 0;
+            if (!poly && !cg_check(cg_npe(type, &npe), "cg_npe"))
+                return false;
+            for (cgsize_t e0 = lo; e0 <= hi; e0 += ELEMENT_CHUNK)
+            {
+                const cgsize_t e1 = std::min(e0 + ELEMENT_CHUNK - 1, hi);
+                const size_t count = static_cast<size_t>(e1 - e0 + 1);
+                if (poly)
+                {
+                    cgsize_t size = 0;
+                    if (!cg_check(cg_ElementPartialSize(fn, B, Z, S, e0, e1, &size), "cg_ElementPartialSize"))
+                        return false;
+                    conn.resize(static_cast<size_t>(size));
+                    offsets.resize(count + 1);
+                    if (!cg_check(cg_poly_elements_partial_read(fn, B, Z, S, e0, e1, conn.data(), offsets.data(), nullptr),
+                                  "cg_poly_elements_partial_read"))
+                        return false;
+                    for (size_t k = 0; k < count; ++k)
+                    {
+                        if (!set.contains(e0 + static_cast<cgsize_t>(k)))
+                            continue;
+                        // MIXED 每个单元首项为单元类型
+                        const cgsize_t b = offsets[k] + (type == CGNS_ENUMV(MIXED) ? 1 : 0);
+                        nodes.insert(nodes.end(), conn.begin() + b, conn.begin() + offsets[k + 1]);
+                    }
+                }
+                else
+                {
+                    conn.resize(count * npe);
+                    if (!cg_check(cg_elements_partial_read(fn, B, Z, S, e0, e1, conn.data(), nullptr), "cg_elements_partial_read"))
+                        return false;
+                    for (size_t k = 0; k < count; ++k)
+                    {
+                        if (set.contains(e0 + static_cast<cgsize_t>(k)))
+                            nodes.insert(nodes.end(), conn.begin() + k * npe, conn.begin() + (k + 1) * npe);
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // 结构网格的节点区间 [rmin, rmax]（各方向闭区间）
+    void collect_structured_range(const ZoneLayout &layout, const cgsize_t *rmin, const cgsize_t *rmax,
+                                  std::vector<cgsize_t> &nodes)
+    {
+        cgsize_t ijk[3] = {1, 1, 1};
+        const cgsize_t kmin = layout.index_dim > 2 ? rmin[2] : 1, kmax = layout.index_dim > 2 ? rmax[2] : 1;
+        const cgsize_t jmin = layout.index_dim > 1 ? rmin[1] : 1, jmax = layout.index_dim > 1 ? rmax[1] : 1;
+        for (ijk[2] = kmin; ijk[2] <= kmax; ++ijk[2])
+        {
+            for (ijk[1] = jmin; ijk[1] <= jmax; ++ijk[1])
+            {
+                for (ijk[0] = rmin[0]; ijk[0] <= rmax[0]; ++ijk[0])
+                    nodes.push_back(layout.linear(ijk));
+            }
+        }
+    }
+
+    bool boundary_selected(int fn, int B, int Z, int BC, const char *bc_name, const SnapOptions &options)
+    {
+        if (options.boundaries.empty())
+            return true;
+        char family[33] = "";
+        if (cg_goto(fn, B, "Zone_t", Z, "ZoneBC_t", 1, "BC_t", BC, "end") == CG_OK)
+        {
+            if (cg_famname_read(family) != CG_OK)
+                family[0] = '\0';
+        }
+        for (const std::string &name : options.boundaries)
+        {
+            if (name == bc_name || (family[0] != '\0' && name == family))
+                return true;
+        }
+        return false;
+    }
+
+    // 收集区域内所选边界条件引用的全部节点（有序去重）
+    bool collect_boundary_nodes(int fn, int B, int Z, const ZoneLayout &layout, const SnapOptions &options,
+                                std::vector<cgsize_t> &nodes)
+    {
+        nodes.clear();
+        int nbocos = 0;
+        if (!cg_check(cg_nbocos(fn, B, Z, &nbocos), "cg_nbocos"))
+            return false;
+        std::vector<cgsize_t> points;
+        for (int BC = 1; BC <= nbocos; ++BC)
+        {
+            char name[33];
+            CGNS_ENUMT(BCType_t) bctype;
+            CGNS_ENUMT(PointSetType_t) ptset_type;
+            cgsize_t npnts = 0, normal_list_size = 0;
+            int normal_index[3], ndataset = 0;
+            CGNS_ENUMT(DataType_t) normal_type;
+            CGNS_ENUMT(GridLocation_t) location;
+            if (!cg_check(cg_boco_info(fn, B, Z, BC, name, &bctype, &ptset_type, &npnts, normal_index,
+                                       &normal_list_size, &normal_type, &ndataset), "cg_boco_info") ||
+                !cg_check(cg_boco_gridlocation_read(fn, B, Z, BC, &location), "cg_boco_gridlocation_read"))
+                return false;
+            if (!boundary_selected(fn, B, Z, BC, name, options))
+                continue;
+
+            const int index_dim = layout.structured ? layout.index_dim : 1;
+            points.resize(static_cast<size_t>(npnts) * index_dim);
+            if (!cg_check(cg_boco_read(fn, B, Z, BC, points.data(), nullptr), "cg_boco_read"))
+                return false;
+
+            const bool is_range = ptset_type == CGNS_ENUMV(PointRange) || ptset_type == CGNS_ENUMV(ElementRange);
+            const bool is_list = ptset_type == CGNS_ENUMV(PointList) || ptset_type == CGNS_ENUMV(ElementList);
+            if (!is_range && !is_list)
+            {
+                std::cerr << "Skipping boundary " << name << ": unsupported point set type" << std::endl;
+                continue;
+            }
+            const bool vertex = location == CGNS_ENUMV(Vertex) && ptset_type != CGNS_ENUMV(ElementRange) &&
+                                ptset_type != CGNS_ENUMV(ElementList);
+
+            if (layout.structured)
+            {
+                if (is_range)
+                {
+                    // 面心/单元区间换成节点区间：法向索引不变，其余方向多一个节点
+                    // - I/J/KFaceCenter 直接给出法向；CellCenter 各方向都加宽
+                    // - 通用 FaceCenter/EdgeCenter 只能按索引相等的方向推断法向
+                    //   （切向只有一个单元宽时也会索引相等，所以优先用 location）
+                    cgsize_t rmin[3], rmax[3];
+                    for (int d = 0; d < index_dim; ++d)
+                    {
+                        rmin[d] = std::min(points[d], points[index_dim + d]);
+                        rmax[d] = std::max(points[d], points[index_dim + d]);
+                    }
+                    int normal = -1;
+                    if (location == CGNS_ENUMV(IFaceCenter))
+                        normal = 0;
+                    else if (location == CGNS_ENUMV(JFaceCenter))
+                        normal = 1;
+                    else if (location == CGNS_ENUMV(KFaceCenter))
+                        normal = 2;
+                    for (int d = 0; d < index_dim && !vertex; ++d)
+                    {
+                        bool widen = d != normal;
+                        if (normal < 0 && location != CGNS_ENUMV(CellCenter))
+                            widen = rmin[d] != rmax[d];
+                        if (widen)
+                            rmax[d] = std::min(rmax[d] + 1, layout.dims[d]);
+                    }
+                    collect_structured_range(layout, rmin, rmax, nodes);
+                }
+                else if (vertex)
+                {
+                    for (cgsize_t k = 0; k < npnts; ++k)
+                        nodes.push_back(layout.linear(&points[static_cast<size_t>(k) * index_dim]));
+                }
+                else
+                    std::cerr << "Skipping boundary " << name << ": face-centered point lists on structured zones" << std::endl;
+                continue;
+            }
+
+            if (vertex)
+            {
+                if (is_range)
+                {
+                    for (cgsize_t id = points[0]; id <= points[1]; ++id)
+                        nodes.push_back(id);
+                }
+                else
+                    nodes.insert(nodes.end(), points.begin(), points.end());
+                continue;
+            }
+
+            // 单元型边界（EdgeCenter/FaceCenter等）：经单元连接关系得到节点
+            ElementSet set;
+            set.is_range = is_range;
+            if (is_range)
+                set.lo = points[0], set.hi = points[1];
+            else if (!points.empty())
+            {
+                set.list = points;
+                std::sort(set.list.begin(), set.list.end());
+                set.lo = set.list.front(), set.hi = set.list.back();
+            }
+            if (!collect_element_nodes(fn, B, Z, set, nodes))
+                return false;
+        }
+        std::sort(nodes.begin(), nodes.end());
+        nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+        return true;
+    }
+
+    class ZoneSnapper
+    {
+    public:
+        ZoneSnapper(int fn, int B, int Z, const ZoneLayout &layout, const BRepProjector &projector,
+                    const SnapOptions &options)
+            : fn_(fn), B_(B), Z_(Z), layout_(layout), projector_(projector), options_(options)
+        {
+        }
+
+        bool init()
+        {
+            int ncoords = 0;
+            if (!cg_check(cg_ncoords(fn_, B_, Z_, &ncoords), "cg_ncoords"))
+                return false;
+            const char *names[3] = {"CoordinateX", "CoordinateY", "CoordinateZ"};
+            for (int C = 1; C <= ncoords; ++C)
+            {
+                char name[33];
+                CGNS_ENUMT(DataType_t) type;
+                if (!cg_check(cg_coord_info(fn_, B_, Z_, C, &type, name), "cg_coord_info"))
+                    return false;
+                for (int d = 0; d < 3; ++d)
+                {
+                    if (std::strcmp(name, names[d]) == 0)
+                        has_coord_[d] = true, coord_type_[d] = type;
+                }
+            }
+            if (!has_coord_[0] || !has_coord_[1])
+            {
+                std::cerr << "Zone " << Z_ << ": only Cartesian coordinates are supported" << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+        bool read(CoordChunk &chunk, const std::vector<cgsize_t> &nodes, SnapStats &stats)
+        {
+            const auto start = std::chrono::high_resolution_clock::now();
+            cgsize_t rmin[3], rmax[3];
+            file_range(chunk, rmin, rmax);
+            const char *names[3] = {"CoordinateX", "CoordinateY", "CoordinateZ"};
+            const size_t count = static_cast<size_t>(chunk.last - chunk.first + 1);
+            for (int d = 0; d < 3; ++d)
+            {
+                chunk.coords[d].assign(count, 0.0); // 缺少Z坐标时按z = 0投影
+                if (has_coord_[d] && !cg_check(cg_coord_read(fn_, B_, Z_, names[d], CGNS_ENUMV(RealDouble), rmin, rmax,
+                                                             chunk.coords[d].data()), "cg_coord_read"))
+                    return false;
+            }
+
+            auto lo = std::lower_bound(nodes.begin(), nodes.end(), chunk.first);
+            auto hi = std::upper_bound(lo, nodes.end(), chunk.last);
+            chunk.local.clear();
+            chunk.points.x.clear(), chunk.points.y.clear(), chunk.points.z.clear();
+            chunk.points.reserve(hi - lo);
+            for (auto it = lo; it != hi; ++it)
+            {
+                const size_t k = static_cast<size_t>(*it - chunk.first);
+                chunk.local.push_back(k);
+                chunk.points.push_back(gp_Pnt(chunk.coords[0][k], chunk.coords[1][k], chunk.coords[2][k]));
+            }
+            stats.read_time += seconds_since(start);
+            return true;
+        }
+
+        // 可在工作线程执行：只访问块自身的缓冲
+        void project(CoordChunk &chunk) const
+        {
+            const auto start = std::chrono::high_resolution_clock::now();
+            chunk.stats = SnapStats();
+            chunk.results.resize(chunk.points.size());
+            project_brep_batch(projector_, chunk.points.batch(), chunk.results.buffers(), BRepElementBuffers(),
+                               options_.backend, options_.num_threads);
+            for (size_t m = 0; m < chunk.local.size(); ++m)
+            {
+                if (chunk.results.status[m] != PROJECTION_OK)
+                {
+                    ++chunk.stats.failed;
+                    continue;
+                }
+                const double d = chunk.results.distance[m];
+                if (options_.max_distance >= 0.0 && d > options_.max_distance)
+                {
+                    ++chunk.stats.rejected;
+                    continue;
+                }
+                const size_t k = chunk.local[m];
+                chunk.coords[0][k] = chunk.results.x[m];
+                chunk.coords[1][k] = chunk.results.y[m];
+                chunk.coords[2][k] = chunk.results.z[m];
+                chunk.stats.max_displacement = std::max(chunk.stats.max_displacement, d);
+                ++chunk.stats.snapped;
+            }
+            chunk.stats.project_time = seconds_since(start);
+        }
+
+        bool write(const CoordChunk &chunk, SnapStats &stats)
+        {
+            const auto start = std::chrono::high_resolution_clock::now();
+            cgsize_t rmin[3], rmax[3];
+            file_range(chunk, rmin, rmax);
+            const char *names[3] = {"CoordinateX", "CoordinateY", "CoordinateZ"};
+            const cgsize_t count = chunk.last - chunk.first + 1;
+            const cgsize_t m_dims[1] = {count}, m_rmin[1] = {1}, m_rmax[1] = {count};
+            for (int d = 0; d < 3; ++d)
+            {
+                int C = 0;
+                // 保持文件中原有的数据类型
+                if (has_coord_[d] &&
+                    !cg_check(cg_coord_general_write(fn_, B_, Z_, names[d], coord_type_[d], rmin, rmax,
+                                                     CGNS_ENUMV(RealDouble), 1, m_dims, m_rmin, m_rmax,
+                                                     chunk.coords[d].data(), &C), "cg_coord_general_write"))
+                    return false;
+            }
+            stats.snapped += chunk.stats.snapped;
+            stats.rejected += chunk.stats.rejected;
+            stats.failed += chunk.stats.failed;
+            stats.max_displacement = std::max(stats.max_displacement, chunk.stats.max_displacement);
+            stats.project_time += chunk.stats.project_time;
+            stats.write_time += seconds_since(start);
+            return true;
+        }
+
+    private:
+        void file_range(const CoordChunk &chunk, cgsize_t *rmin, cgsize_t *rmax) const
+        {
+            if (!layout_.structured)
+            {
+                rmin[0] = chunk.first, rmax[0] = chunk.last;
+                return;
+            }
+            const int last = layout_.index_dim - 1;
+            for (int d = 0; d < last; ++d)
+                rmin[d] = 1, rmax[d] = layout_.dims[d];
+            rmin[last] = (chunk.first - 1) / layout_.slab + 1;
+            rmax[last] = chunk.last / layout_.slab;
+        }
+
+        int fn_, B_, Z_;
+        const ZoneLayout &layout_;
+        const BRepProjector &projector_;
+        const SnapOptions &options_;
+        bool has_coord_[3] = {false, false, false};
+        CGNS_ENUMT(DataType_t) coord_type_[3] = {CGNS_ENUMV(RealDouble), CGNS_ENUMV(RealDouble), CGNS_ENUMV(RealDouble)};
+    };
+
+    bool snap_zone(int fn, int B, int Z, const BRepProjector &projector, const SnapOptions &options, SnapStats &stats)
+    {
+        char zone_name[33];
+        CGNS_ENUMT(ZoneType_t) zone_type;
+        cgsize_t size[9];
+        ZoneLayout layout;
+        if (!cg_check(cg_zone_type(fn, B, Z, &zone_type), "cg_zone_type") ||
+            !cg_check(cg_zone_read(fn, B, Z, zone_name, size), "cg_zone_read") ||
+            !cg_check(cg_index_dim(fn, B, Z, &layout.index_dim), "cg_index_dim"))
+            return false;
+        layout.structured = zone_type == CGNS_ENUMV(Structured);
+        layout.nb_nodes = 1;
+        for (int d = 0; d < layout.index_dim; ++d)
+        {
+            layout.dims[d] = size[d];
+            layout.nb_nodes *= size[d];
+        }
+        if (layout.structured)
+        {
+            for (int d = 0; d < layout.index_dim - 1; ++d)
+                layout.slab *= layout.dims[d];
+        }
+
+        std::vector<cgsize_t> nodes;
+        auto start = std::chrono::high_resolution_clock::now();
+        if (!collect_boundary_nodes(fn, B, Z, layout, options, nodes))
+            return false;
+        stats.read_time += seconds_since(start);
+        // 边界点列表中超出 [1, nb_nodes] 的节点号无法对应坐标，丢弃（nodes 已排序）
+        const auto valid_begin = std::lower_bound(nodes.begin(), nodes.end(), cgsize_t(1));
+        const auto valid_end = std::upper_bound(valid_begin, nodes.end(), layout.nb_nodes);
+        if (valid_begin != nodes.begin() || valid_end != nodes.end())
+        {
+            std::cerr << "Zone " << Z << ": ignoring " << (nodes.size() - (valid_end - valid_begin))
+                      << " boundary node ids outside [1, " << layout.nb_nodes << "]" << std::endl;
+            nodes.erase(valid_end, nodes.end());
+            nodes.erase(nodes.begin(), valid_begin);
+        }
+        stats.boundary_nodes += nodes.size();
+        ++stats.zones;
+        if (nodes.empty())
+            return true;
+
+        ZoneSnapper snapper(fn, B, Z, layout, projector, options);
+        if (!snapper.init())
+            return false;
+
+        // 只处理含边界节点的块；结构网格按整层对齐
+        cgsize_t chunk_nodes = std::max<cgsize_t>(static_cast<cgsize_t>(options.chunk_nodes), 1);
+        chunk_nodes = std::max<cgsize_t>(chunk_nodes / layout.slab, 1) * layout.slab;
+        std::vector<std::pair<cgsize_t, cgsize_t>> ranges;
+        for (cgsize_t first = 1; first <= layout.nb_nodes; first += chunk_nodes)
+        {
+            const cgsize_t last = std::min(first + chunk_nodes - 1, layout.nb_nodes);
+            auto it = std::lower_bound(nodes.begin(), nodes.end(), first);
+            if (it != nodes.end() && *it <= last)
+                ranges.emplace_back(first, last);
+        }
+        if (ranges.empty())
+            return true;
+
+        // 三个缓冲轮转：投影第c块的同时写回第c-1块、读取第c+1块
+        CoordChunk buffers[3];
+        bool ok = true;
+        buffers[0].first = ranges[0].first, buffers[0].last = ranges[0].second;
+        if (!snapper.read(buffers[0], nodes, stats))
+            return false;
+        for (size_t c = 0; c < ranges.size() && ok; ++c)
+        {
+            tbb::task_group group;
+            CoordChunk &current = buffers[c % 3];
+            group.run([&] { snapper.project(current); });
+            if (c > 0)
+                ok = snapper.write(buffers[(c - 1) % 3], stats);
+            if (ok && c + 1 < ranges.size())
+            {
+                CoordChunk &next = buffers[(c + 1) % 3];
+                next.first = ranges[c + 1].first, next.last = ranges[c + 1].second;
+                ok = snapper.read(next, nodes, stats);
+            }
+            group.wait();
+        }
+        if (ok)
+            ok = snapper.write(buffers[(ranges.size() - 1) % 3], stats);
+        return ok;
+    }
+}
+
+bool snap_cgns_mesh(const std::string &mesh_in, const std::string &mesh_out, const BRepProjector &projector,
+                    const SnapOptions &options, SnapStats &stats)
+{
+    stats = SnapStats();
+    std::error_code ec;
+    std::filesystem::copy_file(mesh_in, mesh_out, std::filesystem::copy_options::overwrite_existing, ec);
+    if (ec)
+    {
+        std::cerr << "Failed to copy " << mesh_in << " to " << mesh_out << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    CgnsFile file;
+    if (!cg_check(cg_open(mesh_out.c_str(), CG_MODE_MODIFY, &file.fn), "cg_open"))
+        return false;
+    int nbases = 0;
+    if (!cg_check(cg_nbases(file.fn, &nbases), "cg_nbases"))
+        return false;
+    for (int B = 1; B <= nbases; ++B)
+    {
+        int nzones = 0;
+        if (!cg_check(cg_nzones(file.fn, B, &nzones), "cg_nzones"))
+            return false;
+        for (int Z = 1; Z <= nzones; ++Z)
+        {
+            if (!snap_zone(file.fn, B, Z, projector, options, stats))
+                return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "brep_projection.h"
+
+// CGNS边界节点贴合参数
+struct SnapOptions
+{
+    std::vector<std::string> boundaries; // 只处理这些边界条件（按BC名或族名匹配），为空时处理全部
+    size_t chunk_nodes = 1 << 20;        // 每次读写的节点数上限（结构网格按最后一个索引方向的整层对齐）
+    double max_distance = -1.0;          // 投影距离超过该值的节点保持不动，负数表示不限制
+    ProjectionBackend backend = BACKEND_TBB;
+    int num_threads = 1;
+};
+
+// 贴合统计（所有区域累加）
+struct SnapStats
+{
+    size_t zones = 0;
+    size_t boundary_nodes = 0;  // 参与贴合的边界节点（去重后）
+    size_t snapped = 0;         // 已移动到CAD上的节点
+    size_t rejected = 0;        // 超过 max_distance 未移动的节点
+    size_t failed = 0;          // 投影失败的节点
+    double max_displacement = 0.0;
+    double read_time = 0.0, project_time = 0.0, write_time = 0.0; // 秒；读写与投影重叠执行，三者之和大于总耗时
+};
+
+// 把 mesh_in 复制为 mesh_out，再把其中边界节点投影到CAD模型上并就地改写坐标
+// - 按块读取节点坐标，只保留三个块的坐标缓冲（内存与网格总节点数无关）
+// - 读写在主线程进行（CGNS库不是线程安全的），与上一块的并行投影重叠
+// - 边界节点由 BC 的 PointList/PointRange（Vertex）或所引用单元的连接关系（EdgeCenter/FaceCenter）得到
+// 失败时返回false并输出错误信息
+bool snap_cgns_mesh(const std::string &mesh_in, const std::string &mesh_out, const BRepProjector &projector,
+                    const SnapOptions &options, SnapStats &stats);
@@ -0,0 +1,222 @@
+#include "coherent_projection.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/blocked_range.h>
+#include <tbb/task_arena.h>
+#include <tbb/enumerable_thread_specific.h>
+
+uint64_t morton_spread_bits(uint32_t x)
+{
+    uint64_t v = x & 0x1fffff; // 21位
+    v = (v | v << 32) & 0x1f00000000ffffULL;
+    v = (v | v << 16) & 0x1f0000ff0000ffULL;
+    v = (v | v << 8) & 0x100f00f00f00f00fULL;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+    v = (v | v << 2) & 0x1249249249249249ULL;
+    return v;
+}
+
+uint64_t morton_encode(uint32_t ix, uint32_t iy, uint32_t iz)
+{
+    return morton_spread_bits(ix) | (morton_spread_bits(iy) << 1) | (morton_spread_bits(iz) << 2);
+}
+
+namespace
+{
+    // 半差乘比例后夹到 [0, 0x1fffff]，保证转换为整数前在范围内
+    inline uint32_t morton_quantize(double half_offset, double scale)
+    {
+        const double t = half_offset * scale;
+        return t > 0.0 ? (t < double(0x1fffff) ? uint32_t(t) : 0x1fffff) : 0;
+    }
+}
+
+MortonGrid::MortonGrid(const double box_lo[3], const double box_hi[3])
+{
+    // 坐标先减半再相减，±DBL_MAX 量级的包围盒也不会溢出成 inf
+    double half_extent = 0.0;
+    for (int k = 0; k < 3; ++k)
+    {
+        const bool valid = std::isfinite(box_lo[k]) && std::isfinite(box_hi[k]) && box_lo[k] <= box_hi[k];
+        lo[k] = valid ? box_lo[k] : 0.0;
+        if (valid)
+            half_extent = std::max(half_extent, 0.5 * box_hi[k] - 0.5 * box_lo[k]);
+    }
+    scale = half_extent > 0.0 ? double(0x1fffff) / half_extent : 0.0;
+}
+
+uint64_t MortonGrid::key(double x, double y, double z) const
+{
+    if (!(std::isfinite(x) && std::isfinite(y) && std::isfinite(z)))
+        return morton_encode(0x1fffff, 0x1fffff, 0x1fffff);
+    return morton_encode(morton_quantize(0.5 * x - 0.5 * lo[0], scale), morton_quantize(0.5 * y - 0.5 * lo[1], scale),
+                         morton_quantize(0.5 * z - 0.5 * lo[2], scale));
+}
+
+void morton_order(const PointBatch &input, std::vector<size_t> &order, int num_threads)
+{
+    const size_t n = input.count;
+    order.resize(n);
+    if (n == 0)
+        return;
+
+    // 包围盒只计有限坐标的点（非有限点由 project_batch 判为 PROJECTION_INVALID_INPUT）
+    const double inf = std::numeric_limits<double>::infinity();
+    double lo[3] = {inf, inf, inf};
+    double hi[3] = {-inf, -inf, -inf};
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (!(std::isfinite(input.x[i]) && std::isfinite(input.y[i]) && std::isfinite(input.z[i])))
+            continue;
+        lo[0] = std::min(lo[0], input.x[i]), hi[0] = std::max(hi[0], input.x[i]);
+        lo[1] = std::min(lo[1], input.y[i]), hi[1] = std::max(hi[1], input.y[i]);
+        lo[2] = std::min(lo[2], input.z[i]), hi[2] = std::max(hi[2], input.z[i]);
+    }
+    const MortonGrid grid(lo, hi);
+
+    std::vector<std::pair<uint64_t, size_t>> keys(n);
+    tbb::task_arena arena(num_threads);
+    arena.execute([&] {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, n), [&](const tbb::blocked_range<size_t> &r) {
+            for (size_t i = r.begin(); i < r.end(); ++i)
+                keys[i] = std::make_pair(grid.key(input.x[i], input.y[i], input.z[i]), i);
+        });
+        tbb::parallel_sort(keys.begin(), keys.end());
+    });
+    for (size_t k = 0; k < n; ++k)
+        order[k] = keys[k].second;
+}
+
+namespace
+{
+    // 沿Morton顺序处理 order[0, count) 这一段
+    void project_chunk(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output,
+                       const size_t *order, size_t count, ProjectionWorkspace &workspace,
+                       const WarmStartOptions &options, WarmStartStats &stats)
+    {
+        bool has_prev = false;
+        gp_Pnt prev_p;
+        double prev_u = 0.0, prev_v = 0.0, prev_d = 0.0;
+        LocalProjectionResult local, global;
+
+        for (size_t k = 0; k < count; ++k)
+        {
+            const size_t i = order[k];
+            const gp_Pnt p(input.x[i], input.y[i], input.z[i]);
+
+            if (has_prev && projector.refine_point(p, prev_u, prev_v, workspace, local, options.max_iterations) &&
+                local.distance <= prev_d + p.Distance(prev_p) + options.distance_slack)
+            {
+                store_projection(output, i, local);
+                prev_u = local.u, prev_v = local.v, prev_d = local.distance;
+                prev_p = p;
+                ++stats.warm_accepted;
+                continue;
+            }
+
+            // 块首点或热启动被拒绝：全局求解，并作为后续点的种子
+            const bool finite = std::isfinite(p.X()) && std::isfinite(p.Y()) && std::isfinite(p.Z());
+            if (!finite || !projector.project_point(p, workspace, global))
+            {
+                output.x[i] = p.X(), output.y[i] = p.Y(), output.z[i] = p.Z();
+                output.status[i] = finite ? PROJECTION_NOT_DONE : PROJECTION_INVALID_INPUT;
+                has_prev = false;
+                ++stats.failed;
+                continue;
+            }
+            store_projection(output, i, global);
+            prev_u = global.u, prev_v = global.v, prev_d = global.distance;
+            prev_p = p;
+            has_prev = true;
+            ++stats.global_solved;
+        }
+    }
+
+    void add_stats(WarmStartStats &total, const WarmStartStats &part)
+    {
+        total.warm_accepted += part.warm_accepted;
+        total.global_solved += part.global_solved;
+        total.failed += part.failed;
+    }
+}
+
+WarmStartStats project_batch_coherent(const BatchProjector &projector, const PointBatch &input,
+                                      const ProjectionBuffers &output, ProjectionBackend backend,
+                                      int num_threads, const WarmStartOptions &options)
+{
+    WarmStartStats stats;
+    if (projector.is_analytic())
+    {
+        project_batch(projector, input, output, backend, num_threads);
+        stats.global_solved = input.count;
+        return stats;
+    }
+
+    std::vector<size_t> order;
+    morton_order(input, order, backend == BACKEND_SERIAL ? 1 : num_threads);
+
+    const size_t chunk = std::max<size_t>(options.chunk_size, 1);
+    const size_t num_chunks = (input.count + chunk - 1) / chunk;
+
+    if (backend == BACKEND_TBB)
+    {
+        tbb::enumerable_thread_specific<ProjectionWorkspace> ets_workspace;
+        tbb::enumerable_thread_specific<WarmStartStats> ets_stats;
+        tbb::task_arena arena(num_threads);
+        arena.execute([&] {
+            tbb::parallel_for(size_t(0), num_chunks, [&](size_t c) {
+                const size_t begin = c * chunk;
+                const size_t count = std::min(chunk, input.count - begin);
+                project_chunk(projector, input, output, order.data() + begin, count,
+                              ets_workspace.local(), options, ets_stats.local());
+            });
+        });
+        for (const auto &part : ets_stats)
+            add_stats(stats, part);
+    }
+    else if (backend == BACKEND_OPENMP)
+    {
+#ifdef _OPENMP
+        omp_set_num_threads(num_threads);
+#pragma omp parallel
+        {
+            ProjectionWorkspace workspace;
+            WarmStartStats part;
+            // 曲面上各处的收敛速度不同，块数远多于线程数，用动态调度
+#pragma omp for schedule(dynamic)
+            for (int c = 0; c < static_cast<int>(num_chunks); ++c)
+            {
+                const size_t begin = static_cast<size_t>(c) * chunk;
+                const size_t count = std::min(chunk, input.count - begin);
+                project_chunk(projector, input, output, order.data() + begin, count, workspace, options, part);
+            }
+#pragma omp critical
+            add_stats(stats, part);
+        }
+#else
+        std::cerr << "OpenMP not enabled!" << std::endl;
+#endif
+    }
+    else
+    {
+        ProjectionWorkspace workspace;
+        for (size_t c = 0; c < num_chunks; ++c)
+        {
+            const size_t begin = c * chunk;
+            project_chunk(projector, input, output, order.data() + begin,
+                          std::min(chunk, input.count - begin), workspace, options, stats);
+        }
+    }
+    return stats;
+}
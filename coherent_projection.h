@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "batch_projection.h"
+
+// 热启动投影参数
+struct WarmStartOptions
+{
+    size_t chunk_size = 1024;   // 每个任务沿Morton曲线连续处理的点数，块首点做全局求解
+    int max_iterations = 20;    // 局部Newton最大迭代次数
+    double distance_slack = 1e-7; // 距离检查的绝对容差
+};
+
+// 热启动统计
+struct WarmStartStats
+{
+    size_t warm_accepted = 0; // 局部求解被接受的点数
+    size_t global_solved = 0; // 走全局求解的点数（块首点和被拒绝的点）
+    size_t failed = 0;        // 全局求解也失败的点数
+};
+
+// 21位整数坐标交织成63位Morton码
+uint64_t morton_spread_bits(uint32_t x);
+uint64_t morton_encode(uint32_t ix, uint32_t iy, uint32_t iz);
+
+// 把包围盒各轴同比例量化到21位整数网格（保持空间各向同性）后计算Morton码
+// - 包围盒应只由有限坐标的点构成；没有有限点（空盒）时所有有限点映射到网格原点
+// - 非有限坐标映射到网格最大角，排在Morton序末尾；盒外的点夹到网格边界
+struct MortonGrid
+{
+    double lo[3] = {0.0, 0.0, 0.0};
+    double scale = 0.0;
+
+    MortonGrid() = default;
+    MortonGrid(const double box_lo[3], const double box_hi[3]);
+    uint64_t key(double x, double y, double z) const;
+};
+
+// 按包围盒量化后的Morton码（每轴21位）对点排序，order[k]为第k个点的原始下标
+void morton_order(const PointBatch &input, std::vector<size_t> &order, int num_threads);
+
+// 空间相关性热启动投影：
+// 点按Morton曲线重排后分块，块内每个点以上一个点的UV为种子做局部Newton求解，
+// 若结果距离超过 d(上一点) + |P - 上一点|（全局最近距离的上界），
+// 说明落入了别的局部极小，回退到全局求解。结果按原始顺序写回。
+// 初等曲面已有闭式解，直接走 project_batch。
+WarmStartStats project_batch_coherent(const BatchProjector &projector, const PointBatch &input,
+                                      const ProjectionBuffers &output, ProjectionBackend backend,
+                                      int num_threads, const WarmStartOptions &options = WarmStartOptions());
@@ -0,0 +1,550 @@
+#include "curve_projection.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <Precision.hxx>
+#include <gp_Vec.hxx>
+#include <gp_Circ.hxx>
+#include <gp_Lin.hxx>
+#include <Geom_Line.hxx>
+#include <Geom_Circle.hxx>
+#include <Geom_TrimmedCurve.hxx>
+#include <Geom_BezierCurve.hxx>
+#include <GeomConvert.hxx>
+#include <TColStd_Array1OfReal.hxx>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/task_arena.h>
+#include <tbb/enumerable_thread_specific.h>
+
+namespace
+{
+    constexpr double TWO_PI = 6.283185307179586476925286766559;
+
+    const double ORTHOGONALITY_TOL = 1e-10; // 残差与切向量夹角余弦的收敛阈值
+    const double LOOSE_ORTHOGONALITY_TOL = 1e-6;
+    const int MAX_LINE_SEARCH = 8;
+
+    inline double box_dist2(const double box[6], double x, double y, double z)
+    {
+        const double dx = std::max(std::max(box[0] - x, x - box[3]), 0.0);
+        const double dy = std::max(std::max(box[1] - y, y - box[4]), 0.0);
+        const double dz = std::max(std::max(box[2] - z, z - box[5]), 0.0);
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    void line_kernel(const AnalyticCurve &c, size_t n,
+                     const double *PROJ_RESTRICT x, const double *PROJ_RESTRICT y, const double *PROJ_RESTRICT z,
+                     double *PROJ_RESTRICT px, double *PROJ_RESTRICT py, double *PROJ_RESTRICT pz,
+                     double *PROJ_RESTRICT t, double *PROJ_RESTRICT dist, unsigned char *PROJ_RESTRICT degenerate)
+    {
+        const double ox = c.origin[0], oy = c.origin[1], oz = c.origin[2];
+        const double d0 = c.xdir[0], d1 = c.xdir[1], d2 = c.xdir[2];
+        const double first = c.first, last = c.last; // 无限直线的范围为 ±Precision::Infinite()，截断不起作用
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double dx = x[i] - ox, dy = y[i] - oy, dz = z[i] - oz;
+            const double s = std::min(std::max(dx * d0 + dy * d1 + dz * d2, first), last);
+            px[i] = ox + s * d0;
+            py[i] = oy + s * d1;
+            pz[i] = oz + s * d2;
+            t[i] = s;
+            const double ex = x[i] - px[i], ey = y[i] - py[i], ez = z[i] - pz[i];
+            dist[i] = std::sqrt(ex * ex + ey * ey + ez * ez);
+            degenerate[i] = 0;
+        }
+    }
+
+    // 圆: C(t) = O + R(cos t X + sin t Y)，t = atan2(局部y, 局部x) 折回 [first, first + 2PI)
+    // 圆弧上 t 超出 last 时，距离沿圆周单峰，最近点必为两端点之一
+    void circle_kernel(const AnalyticCurve &c, size_t n,
+                       const double *PROJ_RESTRICT x, const double *PROJ_RESTRICT y, const double *PROJ_RESTRICT z,
+                       double *PROJ_RESTRICT px, double *PROJ_RESTRICT py, double *PROJ_RESTRICT pz,
+                       double *PROJ_RESTRICT t, double *PROJ_RESTRICT dist, unsigned char *PROJ_RESTRICT degenerate)
+    {
+        const double ox = c.origin[0], oy = c.origin[1], oz = c.origin[2];
+        const double x0 = c.xdir[0], x1 = c.xdir[1], x2 = c.xdir[2];
+        const double y0 = c.ydir[0], y1 = c.ydir[1], y2 = c.ydir[2];
+        const double R = c.radius, first = c.first, last = c.last;
+        const bool bounded = c.bounded;
+        const double tol = Precision::Confusion();
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double dx = x[i] - ox, dy = y[i] - oy, dz = z[i] - oz;
+            const double lx = dx * x0 + dy * x1 + dz * x2;
+            const double ly = dx * y0 + dy * y1 + dz * y2;
+            const bool on_axis = lx * lx + ly * ly <= tol * tol;
+            double s = on_axis ? first : std::atan2(ly, lx);
+            s = first + std::fmod(s - first, TWO_PI);
+            s = s < first ? s + TWO_PI : s;
+            if (bounded && s > last)
+            {
+                // 比较两端点到P在圆平面内的角距离
+                const double to_last = s - last, to_first = first + TWO_PI - s;
+                s = to_last <= to_first ? last : first;
+            }
+            const double cs = std::cos(s), sn = std::sin(s);
+            px[i] = ox + R * (cs * x0 + sn * y0);
+            py[i] = oy + R * (cs * x1 + sn * y1);
+            pz[i] = oz + R * (cs * x2 + sn * y2);
+            t[i] = s;
+            const double ex = x[i] - px[i], ey = y[i] - py[i], ez = z[i] - pz[i];
+            dist[i] = std::sqrt(ex * ex + ey * ey + ez * ez);
+            degenerate[i] = on_axis ? 1 : 0;
+        }
+    }
+
+    // 从种子t0出发在 [a, b] 内的一维Newton投影：最小化 |C(t) - P|^2 / 2
+    template <class Curve>
+    bool local_project_curve(const Curve &curve, const gp_Pnt &p, double t0, double a, double b,
+                             LocalProjectionResult &result, int max_iterations)
+    {
+        double t = std::min(std::max(t0, a), b);
+        gp_Pnt C;
+        gp_Vec D1, D2;
+        curve.D2(t, C, D1, D2);
+        gp_Vec d(p, C); // C - P
+        double f = d.SquareMagnitude();
+
+        result.converged = false;
+        int it = 0;
+        for (; it < max_iterations; ++it)
+        {
+            const double g = D1.Dot(d), a2 = D1.SquareMagnitude();
+            const double dn = std::sqrt(f);
+            // 收敛：点在曲线上、残差与切向量正交，或停在端点且梯度指向范围外
+            if (dn <= Precision::Confusion() || std::abs(g) <= ORTHOGONALITY_TOL * dn * std::sqrt(a2) ||
+                (t <= a && g > 0.0) || (t >= b && g < 0.0))
+            {
+                result.converged = true;
+                break;
+            }
+
+            double h = a2 + D2.Dot(d);
+            if (h <= 0.0) // 凹侧远离曲线时退化为Gauss-Newton
+                h = a2;
+            if (h <= 0.0) // 奇异参数点，交给全局求解
+                break;
+            const double dt = -g / h;
+
+            // 回溯线搜索，保证距离单调下降
+            bool accepted = false;
+            double step = 1.0;
+            for (int ls = 0; ls < MAX_LINE_SEARCH; ++ls, step *= 0.5)
+            {
+                const double tn = std::min(std::max(t + step * dt, a), b);
+                gp_Pnt Cn;
+                gp_Vec D1n, D2n;
+                curve.D2(tn, Cn, D1n, D2n);
+                const gp_Vec dnew(p, Cn);
+                const double fn = dnew.SquareMagnitude();
+                if (fn <= f)
+                {
+                    const bool tiny_step = std::abs(tn - t) <= Precision::PConfusion();
+                    t = tn, C = Cn, D1 = D1n, D2 = D2n, d = dnew, f = fn;
+                    accepted = !tiny_step;
+                    if (tiny_step)
+                        result.converged = true;
+                    break;
+                }
+            }
+            if (!accepted)
+            {
+                // 无法继续下降：用宽松正交条件判定
+                if (!result.converged)
+                {
+                    const double dd = std::sqrt(f);
+                    result.converged = dd <= Precision::Confusion() ||
+                                       std::abs(D1.Dot(d)) <= LOOSE_ORTHOGONALITY_TOL * dd * D1.Magnitude();
+                }
+                break;
+            }
+        }
+
+        result.point = C;
+        result.u = t;
+        result.v = 0.0;
+        result.distance = std::sqrt(f);
+        result.iterations = it;
+        return result.converged;
+    }
+}
+
+bool analytic_curve_init(const Handle(Geom_Curve) & curve, double first, double last, AnalyticCurve &analytic)
+{
+    analytic = AnalyticCurve();
+    Handle(Geom_Curve) basis = curve;
+    while (Handle(Geom_TrimmedCurve) trimmed = Handle(Geom_TrimmedCurve)::DownCast(basis))
+        basis = trimmed->BasisCurve();
+    if (basis.IsNull())
+        return false;
+
+    if (Handle(Geom_Line) line = Handle(Geom_Line)::DownCast(basis))
+    {
+        const gp_Lin lin = line->Lin();
+        const gp_Pnt &o = lin.Location();
+        const gp_Dir &d = lin.Direction();
+        analytic.type = ANALYTIC_CURVE_LINE;
+        analytic.origin[0] = o.X(), analytic.origin[1] = o.Y(), analytic.origin[2] = o.Z();
+        analytic.xdir[0] = d.X(), analytic.xdir[1] = d.Y(), analytic.xdir[2] = d.Z();
+        analytic.first = first;
+        analytic.last = last;
+        analytic.bounded = !Precision::IsInfinite(first) && !Precision::IsInfinite(last);
+        return true;
+    }
+    if (Handle(Geom_Circle) circle = Handle(Geom_Circle)::DownCast(basis))
+    {
+        const gp_Circ circ = circle->Circ();
+        const gp_Ax2 &pos = circ.Position();
+        const gp_Pnt &o = pos.Location();
+        const gp_Dir &x = pos.XDirection();
+        const gp_Dir &y = pos.YDirection();
+        analytic.type = ANALYTIC_CURVE_CIRCLE;
+        analytic.origin[0] = o.X(), analytic.origin[1] = o.Y(), analytic.origin[2] = o.Z();
+        analytic.xdir[0] = x.X(), analytic.xdir[1] = x.Y(), analytic.xdir[2] = x.Z();
+        analytic.ydir[0] = y.X(), analytic.ydir[1] = y.Y(), analytic.ydir[2] = y.Z();
+        analytic.radius = circ.Radius();
+        analytic.first = first;
+        analytic.last = last;
+        analytic.bounded = last - first < TWO_PI - Precision::PConfusion();
+        return true;
+    }
+    return false;
+}
+
+void analytic_curve_project_kernel(const AnalyticCurve &analytic, size_t count,
+                                   const double *x, const double *y, const double *z,
+                                   double *px, double *py, double *pz,
+                                   double *t, double *dist,
+                                   unsigned char *degenerate)
+{
+    switch (analytic.type)
+    {
+    case ANALYTIC_CURVE_LINE:
+        line_kernel(analytic, count, x, y, z, px, py, pz, t, dist, degenerate);
+        break;
+    case ANALYTIC_CURVE_CIRCLE:
+        circle_kernel(analytic, count, x, y, z, px, py, pz, t, dist, degenerate);
+        break;
+    default:
+        std::fill(degenerate, degenerate + count, static_cast<unsigned char>(1));
+        break;
+    }
+}
+
+CurveProjector::CurveProjector(const Handle(Geom_Curve) & curve, bool prepare)
+{
+    if (!curve.IsNull())
+        init(curve, curve->FirstParameter(), curve->LastParameter(), prepare);
+}
+
+CurveProjector::CurveProjector(const Handle(Geom_Curve) & curve, double first, double last, bool prepare)
+{
+    if (!curve.IsNull())
+        init(curve, first, last, prepare);
+}
+
+void CurveProjector::init(const Handle(Geom_Curve) & curve, double first, double last, bool prepare)
+{
+    curve_ = curve;
+    first_ = first;
+    last_ = last;
+    periodic_ = curve->IsPeriodic() && last - first >= curve->Period() - Precision::PConfusion();
+    if (analytic_curve_init(curve, first, last, analytic_) || !prepare)
+        return;
+
+    // B样条、Bezier，以及以它们为基曲线的裁剪曲线（转换后参数不变）
+    Handle(Geom_Curve) basis = curve;
+    while (Handle(Geom_TrimmedCurve) trimmed = Handle(Geom_TrimmedCurve)::DownCast(basis))
+        basis = trimmed->BasisCurve();
+    Handle(Geom_BSplineCurve) bspline;
+    if (Handle(Geom_BSplineCurve)::DownCast(basis))
+        bspline = Handle(Geom_BSplineCurve)::DownCast(basis->Copy());
+    else if (Handle(Geom_BezierCurve)::DownCast(basis))
+        bspline = GeomConvert::CurveToBSplineCurve(basis);
+    if (bspline.IsNull())
+        return;
+
+    // 非周期化并截到投影范围，span与控制点一一对应
+    if (!periodic_ && (first > bspline->FirstParameter() + Precision::PConfusion() ||
+                       last < bspline->LastParameter() - Precision::PConfusion() ||
+                       bspline->IsPeriodic()))
+        bspline->Segment(first, last);
+    if (bspline->IsPeriodic())
+        bspline->SetNotPeriodic();
+    prepare_bspline(bspline);
+}
+
+void CurveProjector::prepare_bspline(const Handle(Geom_BSplineCurve) & bspline)
+{
+    bspline_ = bspline;
+    const int degree = bspline->Degree();
+    const int nb_poles = bspline->NbPoles();
+    const TColStd_Array1OfReal &knots = bspline->KnotSequence();
+    const int lower = knots.Lower();
+    nb_span_samples_ = std::max(3, degree + 2); // 每span等分 degree + 1 段，含两端
+
+    gp_Pnt point;
+    for (int i = degree + 1; i <= nb_poles; ++i)
+    {
+        // 1开始的节点序列上，[K(i), K(i+1)] 上非零的基函数为 N(i-degree) .. N(i)
+        const double t0 = knots(lower + i - 1), t1 = knots(lower + i);
+        if (t1 - t0 <= Precision::PConfusion())
+            continue;
+        Span span;
+        span.t0 = t0, span.t1 = t1;
+        span.box[0] = span.box[1] = span.box[2] = std::numeric_limits<double>::max();
+        span.box[3] = span.box[4] = span.box[5] = -std::numeric_limits<double>::max();
+        for (int j = i - degree; j <= i; ++j)
+        {
+            // 权重为正时曲线段位于这些控制点的凸包内
+            const gp_Pnt &pole = bspline->Pole(j);
+            const double c[3] = {pole.X(), pole.Y(), pole.Z()};
+            for (int k = 0; k < 3; ++k)
+            {
+                span.box[k] = std::min(span.box[k], c[k] - Precision::Confusion());
+                span.box[k + 3] = std::max(span.box[k + 3], c[k] + Precision::Confusion());
+            }
+        }
+        span.first_sample = static_cast<int>(sample_t_.size());
+        for (int s = 0; s < nb_span_samples_; ++s)
+        {
+            const double t = t0 + (t1 - t0) * s / (nb_span_samples_ - 1);
+            bspline->D0(t, point);
+            sample_t_.push_back(t);
+            sample_x_.push_back(point.X());
+            sample_y_.push_back(point.Y());
+            sample_z_.push_back(point.Z());
+        }
+        spans_.push_back(span);
+    }
+}
+
+void CurveProjector::bind(CurveProjectionWorkspace &workspace) const
+{
+    if (workspace.owner == this)
+        return;
+    workspace.adaptor.Load(bspline_);
+    workspace.span_bounds.resize(spans_.size());
+    workspace.span_order.resize(spans_.size());
+    workspace.owner = this;
+}
+
+bool CurveProjector::refine_point(const gp_Pnt &p, double t0, double a, double b, CurveProjectionWorkspace &workspace,
+                                  LocalProjectionResult &result, int max_iterations) const
+{
+    if (!spans_.empty())
+    {
+        bind(workspace);
+        return local_project_curve(workspace.adaptor, p, t0, a, b, result, max_iterations);
+    }
+    return local_project_curve(*curve_, p, t0, a, b, result, max_iterations);
+}
+
+bool CurveProjector::project_point_general(const gp_Pnt &p, CurveProjectionWorkspace &workspace,
+                                           LocalProjectionResult &result) const
+{
+    const bool finite_range = !Precision::IsInfinite(first_) && !Precision::IsInfinite(last_);
+    bool found = false;
+    if (finite_range)
+    {
+        // 曲线投影只给出内部极值，端点单独比较
+        const gp_Pnt p0 = curve_->Value(first_), p1 = curve_->Value(last_);
+        const double d0 = p.Distance(p0), d1 = p.Distance(p1);
+        result.point = d0 <= d1 ? p0 : p1;
+        result.u = d0 <= d1 ? first_ : last_;
+        result.distance = std::min(d0, d1);
+        found = true;
+    }
+
+    GeomAPI_ProjectPointOnCurve &projector = workspace.projector;
+    if (finite_range)
+        projector.Init(p, curve_, first_, last_);
+    else
+        projector.Init(p, curve_);
+    if (projector.NbPoints() > 0 && (!found || projector.LowerDistance() < result.distance))
+    {
+        result.point = projector.NearestPoint();
+        result.u = projector.LowerDistanceParameter();
+        result.distance = projector.LowerDistance();
+        found = true;
+    }
+    result.v = 0.0;
+    result.converged = found;
+    return found;
+}
+
+bool CurveProjector::project_point(const gp_Pnt &p, CurveProjectionWorkspace &workspace, LocalProjectionResult &result) const
+{
+    if (is_analytic())
+    {
+        const double x = p.X(), y = p.Y(), z = p.Z();
+        double px, py, pz;
+        unsigned char degenerate = 0;
+        analytic_curve_project_kernel(analytic_, 1, &x, &y, &z, &px, &py, &pz, &result.u, &result.distance, &degenerate);
+        result.point.SetCoord(px, py, pz);
+        result.v = 0.0;
+        result.converged = true;
+        return true;
+    }
+    if (spans_.empty())
+        return project_point_general(p, workspace, result);
+
+    // span下界由近到远，每个可能更近的span从最近采样点出发做局部求解
+    bind(workspace);
+    const double x = p.X(), y = p.Y(), z = p.Z();
+    for (size_t k = 0; k < spans_.size(); ++k)
+        workspace.span_bounds[k] = box_dist2(spans_[k].box, x, y, z);
+    std::iota(workspace.span_order.begin(), workspace.span_order.end(), 0);
+    std::sort(workspace.span_order.begin(), workspace.span_order.end(),
+              [&](int a, int b) { return workspace.span_bounds[a] < workspace.span_bounds[b]; });
+
+    bool found = false;
+    double best2 = std::numeric_limits<double>::infinity();
+    LocalProjectionResult candidate;
+    for (int k : workspace.span_order)
+    {
+        if (workspace.span_bounds[k] >= best2)
+            break;
+        const Span &span = spans_[k];
+        int seed = span.first_sample;
+        double seed2 = std::numeric_limits<double>::infinity();
+        for (int s = span.first_sample; s < span.first_sample + nb_span_samples_; ++s)
+        {
+            const double dx = sample_x_[s] - x, dy = sample_y_[s] - y, dz = sample_z_[s] - z;
+            const double d2 = dx * dx + dy * dy + dz * dz;
+            if (d2 < seed2)
+                seed2 = d2, seed = s;
+        }
+        local_project_curve(workspace.adaptor, p, sample_t_[seed], span.t0, span.t1, candidate, 20);
+        if (candidate.converged && candidate.distance * candidate.distance < best2)
+        {
+            result = candidate;
+            best2 = candidate.distance * candidate.distance;
+            found = true;
+        }
+    }
+    if (!found)
+        return project_point_general(p, workspace, result);
+
+    if (periodic_)
+    {
+        result.u = first_ + std::fmod(result.u - first_, curve_->Period());
+        if (result.u < first_)
+            result.u += curve_->Period();
+    }
+    return true;
+}
+
+void CurveProjector::store_failure(const PointBatch &input, const ProjectionBuffers &output, size_t i, bool finite) const
+{
+    output.x[i] = input.x[i], output.y[i] = input.y[i], output.z[i] = input.z[i];
+    output.status[i] = finite ? PROJECTION_NOT_DONE : PROJECTION_INVALID_INPUT;
+}
+
+void CurveProjector::project_range(const PointBatch &input, const ProjectionBuffers &output,
+                                   size_t begin, size_t end, CurveProjectionWorkspace &workspace) const
+{
+    if (!is_analytic())
+    {
+        LocalProjectionResult result;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const gp_Pnt p(input.x[i], input.y[i], input.z[i]);
+            const bool finite = std::isfinite(p.X()) && std::isfinite(p.Y()) && std::isfinite(p.Z());
+            if (!finite || !project_point(p, workspace, result))
+                store_failure(input, output, i, finite);
+            else
+                store_projection(output, i, result);
+        }
+        return;
+    }
+
+    // 闭式内核；轴线上的点解不唯一，内核已取 t = first，仍视为成功
+    double t_scratch[ANALYTIC_BLOCK_SIZE], d_scratch[ANALYTIC_BLOCK_SIZE];
+    unsigned char degenerate[ANALYTIC_BLOCK_SIZE];
+    for (size_t b = begin; b < end; b += ANALYTIC_BLOCK_SIZE)
+    {
+        const size_t n = std::min(ANALYTIC_BLOCK_SIZE, end - b);
+        double *t = output.u ? output.u + b : t_scratch;
+        analytic_curve_project_kernel(analytic_, n, input.x + b, input.y + b, input.z + b,
+                                      output.x + b, output.y + b, output.z + b, t,
+                                      output.distance ? output.distance + b : d_scratch, degenerate);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const bool finite = std::isfinite(output.x[b + i]) && std::isfinite(output.y[b + i]) &&
+                                std::isfinite(output.z[b + i]);
+            if (!finite)
+                store_failure(input, output, b + i, false);
+            else
+                output.status[b + i] = PROJECTION_OK;
+            if (output.v)
+                output.v[b + i] = 0.0;
+        }
+    }
+}
+
+void project_curve_batch_serial(const CurveProjector &projector, const PointBatch &input, const ProjectionBuffers &output)
+{
+    CurveProjectionWorkspace workspace; // 只构造一次
+    projector.project_range(input, output, 0, input.count, workspace);
+}
+
+void project_curve_batch_omp(const CurveProjector &projector, const PointBatch &input, const ProjectionBuffers &output, int num_threads)
+{
+#ifdef _OPENMP
+    const size_t num_points = input.count;
+    const int num_blocks = static_cast<int>((num_points + ANALYTIC_BLOCK_SIZE - 1) / ANALYTIC_BLOCK_SIZE);
+    omp_set_num_threads(num_threads);
+#pragma omp parallel
+    {
+        CurveProjectionWorkspace workspace; // 每个线程只构造一次
+#pragma omp for
+        for (int b = 0; b < num_blocks; ++b)
+        {
+            const size_t begin = static_cast<size_t>(b) * ANALYTIC_BLOCK_SIZE;
+            const size_t end = std::min(begin + ANALYTIC_BLOCK_SIZE, num_points);
+            projector.project_range(input, output, begin, end, workspace);
+        }
+    }
+#else
+    std::cerr << "OpenMP not enabled!" << std::endl;
+#endif
+}
+
+void project_curve_batch_tbb(const CurveProjector &projector, const PointBatch &input, const ProjectionBuffers &output, int num_threads)
+{
+    tbb::enumerable_thread_specific<CurveProjectionWorkspace> ets_workspace;
+    tbb::task_arena arena(num_threads);
+    arena.execute([&] {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, input.count, ANALYTIC_BLOCK_SIZE), [&](const tbb::blocked_range<size_t> &r) {
+            auto &workspace = ets_workspace.local(); // 每个线程只构造一次
+            projector.project_range(input, output, r.begin(), r.end(), workspace);
+        });
+    });
+}
+
+void project_curve_batch(const CurveProjector &projector, const PointBatch &input, const ProjectionBuffers &output,
+                         ProjectionBackend backend, int num_threads)
+{
+    switch (backend)
+    {
+    case BACKEND_OPENMP:
+        project_curve_batch_omp(projector, input, output, num_threads);
+        break;
+    case BACKEND_TBB:
+        project_curve_batch_tbb(projector, input, output, num_threads);
+        break;
+    default:
+        project_curve_batch_serial(projector, input, output);
+        break;
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <gp_Pnt.hxx>
+#include <Geom_Curve.hxx>
+#include <Geom_BSplineCurve.hxx>
+#include <GeomAdaptor_Curve.hxx>
+#include <GeomAPI_ProjectPointOnCurve.hxx>
+
+#include "batch_projection.h"
+
+// 可以用闭式解投影的曲线类型
+enum AnalyticCurveType
+{
+    ANALYTIC_CURVE_NONE = 0, // 走B样条span分段或OCCT通用投影
+    ANALYTIC_CURVE_LINE,
+    ANALYTIC_CURVE_CIRCLE
+};
+
+// 直线/圆的局部坐标系和参数范围（纯数值，可在线程间只读共享）
+struct AnalyticCurve
+{
+    AnalyticCurveType type = ANALYTIC_CURVE_NONE;
+    double origin[3] = {0.0, 0.0, 0.0};
+    double xdir[3] = {1.0, 0.0, 0.0}; // 直线方向 / 圆的X轴
+    double ydir[3] = {0.0, 1.0, 0.0}; // 圆的Y轴
+    double radius = 0.0;
+    double first = 0.0, last = 0.0;   // 参数范围
+    bool bounded = false;             // 直线为线段，或圆为圆弧（范围小于一个周期）
+};
+
+// 识别直线和圆（包括以它们为基曲线的 Geom_TrimmedCurve），参数范围限制在 [first, last]
+bool analytic_curve_init(const Handle(Geom_Curve) & curve, double first, double last, AnalyticCurve &analytic);
+
+// 闭式投影批量内核（SoA输入输出），t为曲线参数
+// 圆的轴线上的点到整圆等距：取 t = first，degenerate置1（解不唯一，结果仍有效）
+void analytic_curve_project_kernel(const AnalyticCurve &analytic, size_t count,
+                                   const double *x, const double *y, const double *z,
+                                   double *px, double *py, double *pz,
+                                   double *t, double *dist,
+                                   unsigned char *degenerate);
+
+// 每个线程私有的曲线投影工作区
+struct CurveProjectionWorkspace
+{
+    GeomAPI_ProjectPointOnCurve projector; // OCCT通用投影（回退路径）
+    GeomAdaptor_Curve adaptor;             // 线程私有求值器，内部缓存当前B样条span的多项式系数
+    const void *owner = nullptr;           // adaptor 当前绑定的投影器
+    std::vector<double> span_bounds;       // 各span凸包包围盒到查询点的距离平方下界
+    std::vector<int> span_order;
+};
+
+// 批量曲线投影器：
+// - 直线/圆（含圆弧、线段）走闭式内核
+// - B样条（Bezier先转换为B样条）按节点区间分span，每个span用控制点包围盒（凸包性质）给出距离下界，
+//   按下界由近到远在span内采样取种子做局部Newton求解，下界不小于当前最近距离的span直接跳过
+// - 其它曲线回退到 GeomAPI_ProjectPointOnCurve
+// 结果写入 ProjectionBuffers：u为曲线参数，v不使用（可置空）
+// 构造后只读，可被多个线程共享；每个线程持有自己的 CurveProjectionWorkspace
+class CurveProjector
+{
+public:
+    explicit CurveProjector(const Handle(Geom_Curve) & curve, bool prepare = true);
+    // 只投影到参数范围 [first, last]（如拓扑边的范围）
+    CurveProjector(const Handle(Geom_Curve) & curve, double first, double last, bool prepare = true);
+
+    bool is_analytic() const { return analytic_.type != ANALYTIC_CURVE_NONE; }
+    bool is_prepared() const { return !spans_.empty(); }
+    const AnalyticCurve &analytic() const { return analytic_; }
+    const Handle(Geom_Curve) & curve() const { return curve_; }
+    double first() const { return first_; }
+    double last() const { return last_; }
+    size_t nb_spans() const { return spans_.size(); }
+
+    // 单线程投影 input[begin, end)，结果写到 output 的相同下标处
+    void project_range(const PointBatch &input, const ProjectionBuffers &output,
+                       size_t begin, size_t end, CurveProjectionWorkspace &workspace) const;
+
+    // 单点全局投影，失败返回false；结果的u为曲线参数
+    bool project_point(const gp_Pnt &p, CurveProjectionWorkspace &workspace, LocalProjectionResult &result) const;
+
+    // 从种子t0在 [a, b] 内做局部Newton求解，只保证局部极小
+    bool refine_point(const gp_Pnt &p, double t0, double a, double b, CurveProjectionWorkspace &workspace,
+                      LocalProjectionResult &result, int max_iterations = 20) const;
+
+private:
+    // B样条的一个非零长度节点区间
+    struct Span
+    {
+        double box[6];   // 该span控制点的包围盒（xmin, ymin, zmin, xmax, ymax, zmax）
+        double t0, t1;   // 参数区间
+        int first_sample; // 采样点在 sample_t_ 等数组中的起始下标，共 nb_span_samples_ 个（含两端）
+    };
+
+    void init(const Handle(Geom_Curve) & curve, double first, double last, bool prepare);
+    void prepare_bspline(const Handle(Geom_BSplineCurve) & bspline);
+    void bind(CurveProjectionWorkspace &workspace) const;
+    bool project_point_general(const gp_Pnt &p, CurveProjectionWorkspace &workspace, LocalProjectionResult &result) const;
+    void store_failure(const PointBatch &input, const ProjectionBuffers &output, size_t i, bool finite) const;
+
+    Handle(Geom_Curve) curve_;
+    AnalyticCurve analytic_;
+    double first_ = 0.0, last_ = 0.0;
+    bool periodic_ = false;                // 投影范围覆盖整个周期，结果参数折回 [first, first + period)
+    Handle(Geom_BSplineCurve) bspline_;    // 非周期化并截到投影范围的B样条副本，参数与原曲线一致
+    std::vector<Span> spans_;
+    int nb_span_samples_ = 0;
+    std::vector<double> sample_t_, sample_x_, sample_y_, sample_z_; // span采样（SoA）
+};
+
+// 串行批量曲线投影
+void project_curve_batch_serial(const CurveProjector &projector, const PointBatch &input, const ProjectionBuffers &output);
+
+// OpenMP并行批量曲线投影（按块静态划分）
+void project_curve_batch_omp(const CurveProjector &projector, const PointBatch &input, const ProjectionBuffers &output, int num_threads);
+
+// TBB并行批量曲线投影（每个线程一个工作区）
+void project_curve_batch_tbb(const CurveProjector &projector, const PointBatch &input, const ProjectionBuffers &output, int num_threads);
+
+// 按后端分派
+void project_curve_batch(const CurveProjector &projector, const PointBatch &input, const ProjectionBuffers &output,
+                         ProjectionBackend backend, int num_threads);
@@ -0,0 +1,376 @@
+#include "distributed_projection.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/blocked_range.h>
+#include <tbb/task_arena.h>
+
+#include "coherent_projection.h"
+#include "point_stream.h"
+
+namespace
+{
+    const uint64_t WRITE_CHUNK_BYTES = 1 << 30; // MPI-IO 单次写入的字节数上限（计数为int）
+
+    // 交换中的一个输入点；(key, index) 作为排序键
+    struct ShardPoint
+    {
+        uint64_t key;
+        uint64_t index; // 全局下标
+        double x, y, z;
+    };
+
+    // 送回读取它的rank的一个结果
+    struct ShardResult
+    {
+        uint64_t index;
+        double x, y, z, u, v, distance;
+        unsigned char status;
+    };
+
+    struct SampleKey
+    {
+        uint64_t key;
+        uint64_t index;
+    };
+
+    inline bool shard_less(uint64_t key_a, uint64_t index_a, uint64_t key_b, uint64_t index_b)
+    {
+        return key_a < key_b || (key_a == key_b && index_a < index_b);
+    }
+
+    // 所有rank是否都成功
+    bool all_ok(MPI_Comm comm, bool ok)
+    {
+        int local = ok ? 1 : 0, global = 0;
+        MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_MIN, comm);
+        return global == 1;
+    }
+
+    // 第 rank 个rank读取的第一个点（按下标均分）
+    uint64_t slice_begin(uint64_t count, int rank, int size)
+    {
+        return count / size * rank + count % size * rank / size;
+    }
+
+    // 按元素计数的 Alltoallv（元素按字节整体发送），任一rank的接收总数超过int范围时所有rank返回false
+    template <class T>
+    bool exchange(MPI_Comm comm, const std::vector<T> &send, const std::vector<int> &send_counts, std::vector<T> &recv)
+    {
+        int size = 1;
+        MPI_Comm_size(comm, &size);
+        std::vector<int> recv_counts(size), send_displs(size), recv_displs(size);
+        MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, comm);
+
+        long long send_total = 0, recv_total = 0;
+        for (int r = 0; r < size; ++r)
+        {
+            send_displs[r] = static_cast<int>(send_total);
+            recv_displs[r] = static_cast<int>(std::min<long long>(recv_total, INT_MAX));
+            send_total += send_counts[r];
+            recv_total += recv_counts[r];
+        }
+        if (!all_ok(comm, recv_total <= INT_MAX))
+        {
+            std::cerr << "Too many points on one rank for MPI_Alltoallv: " << recv_total << std::endl;
+            return false;
+        }
+
+        recv.resize(static_cast<size_t>(recv_total));
+        MPI_Datatype type;
+        MPI_Type_contiguous(static_cast<int>(sizeof(T)), MPI_BYTE, &type);
+        MPI_Type_commit(&type);
+        MPI_Alltoallv(send.data(), send_counts.data(), send_displs.data(), type,
+                      recv.data(), recv_counts.data(), recv_displs.data(), type, comm);
+        MPI_Type_free(&type);
+        return true;
+    }
+
+    // 每个值在各rank上的最小、平均、最大
+    void reduce_spreads(MPI_Comm comm, const std::vector<double> &values, std::vector<RankSpread> &spreads)
+    {
+        int size = 1;
+        MPI_Comm_size(comm, &size);
+        const int n = static_cast<int>(values.size());
+        std::vector<double> lo(n), hi(n), sum(n);
+        MPI_Allreduce(values.data(), lo.data(), n, MPI_DOUBLE, MPI_MIN, comm);
+        MPI_Allreduce(values.data(), hi.data(), n, MPI_DOUBLE, MPI_MAX, comm);
+        MPI_Allreduce(values.data(), sum.data(), n, MPI_DOUBLE, MPI_SUM, comm);
+        spreads.resize(n);
+        for (int k = 0; k < n; ++k)
+        {
+            spreads[k].min = lo[k];
+            spreads[k].avg = sum[k] / size;
+            spreads[k].max = hi[k];
+        }
+    }
+
+    // 选出 size - 1 个分割点：各rank从自己有序的点中等距取样，汇总排序后等距取分割点
+    void select_splitters(MPI_Comm comm, const std::vector<ShardPoint> &sorted, size_t samples_per_rank,
+                          std::vector<SampleKey> &splitters)
+    {
+        int size = 1;
+        MPI_Comm_size(comm, &size);
+        const size_t n = sorted.size();
+        const size_t samples = std::min(samples_per_rank, n);
+        std::vector<uint64_t> local(2 * samples);
+        for (size_t k = 0; k < samples; ++k)
+        {
+            const ShardPoint &p = sorted[(2 * k + 1) * n / (2 * samples)];
+            local[2 * k] = p.key;
+            local[2 * k + 1] = p.index;
+        }
+
+        const int local_count = static_cast<int>(local.size());
+        std::vector<int> counts(size), displs(size);
+        MPI_Allgather(&local_count, 1, MPI_INT, counts.data(), 1, MPI_INT, comm);
+        int total = 0;
+        for (int r = 0; r < size; ++r)
+        {
+            displs[r] = total;
+            total += counts[r];
+        }
+        std::vector<uint64_t> gathered(total);
+        MPI_Allgatherv(local.data(), local_count, MPI_UINT64_T, gathered.data(), counts.data(), displs.data(),
+                       MPI_UINT64_T, comm);
+
+        std::vector<SampleKey> all(total / 2);
+        for (size_t k = 0; k < all.size(); ++k)
+            all[k] = {gathered[2 * k], gathered[2 * k + 1]};
+        std::sort(all.begin(), all.end(), [](const SampleKey &a, const SampleKey &b) {
+            return shard_less(a.key, a.index, b.key, b.index);
+        });
+
+        splitters.clear();
+        if (all.empty())
+            return;
+        for (int r = 1; r < size; ++r)
+            splitters.push_back(all[all.size() * r / size]);
+    }
+
+    // 结果集体写入结果文件：rank 0 写文件头，各rank写自己那一段的记录和状态
+    bool write_result_file(MPI_Comm comm, const std::string &path, uint64_t count, uint64_t begin,
+                           const std::vector<double> &records, const std::vector<unsigned char> &status)
+    {
+        int rank = 0;
+        MPI_Comm_rank(comm, &rank);
+        MPI_File file;
+        const bool opened = MPI_File_open(comm, path.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL,
+                                          &file) == MPI_SUCCESS;
+        if (!all_ok(comm, opened))
+        {
+            if (opened)
+                MPI_File_close(&file);
+            if (rank == 0)
+                std::cerr << "Failed to create result file: " << path << std::endl;
+            return false;
+        }
+
+        const ResultFileHeader header = make_result_header(count);
+        bool ok = MPI_File_set_size(file, static_cast<MPI_Offset>(header.status_offset + count)) == MPI_SUCCESS;
+        if (rank == 0)
+            ok = ok && MPI_File_write_at(file, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE) == MPI_SUCCESS;
+
+        // 每轮最多写 WRITE_CHUNK_BYTES；各rank的轮数取最大值，先写完的rank以空写参与集体调用
+        const unsigned char *record_bytes = reinterpret_cast<const unsigned char *>(records.data());
+        const uint64_t record_size = records.size() * sizeof(double);
+        uint64_t rounds = (std::max<uint64_t>(record_size, status.size()) + WRITE_CHUNK_BYTES - 1) / WRITE_CHUNK_BYTES;
+        MPI_Allreduce(MPI_IN_PLACE, &rounds, 1, MPI_UINT64_T, MPI_MAX, comm);
+        for (uint64_t k = 0; k < rounds; ++k)
+        {
+            const uint64_t offset = k * WRITE_CHUNK_BYTES;
+            const uint64_t record_part = offset < record_size ? std::min(WRITE_CHUNK_BYTES, record_size - offset) : 0;
+            const uint64_t status_part = offset < status.size() ? std::min<uint64_t>(WRITE_CHUNK_BYTES, status.size() - offset) : 0;
+            ok = MPI_File_write_at_all(file, static_cast<MPI_Offset>(header.record_offset + begin * 6 * sizeof(double) + offset),
+                                       record_bytes + std::min(offset, record_size), static_cast<int>(record_part),
+                                       MPI_BYTE, MPI_STATUS_IGNORE) == MPI_SUCCESS && ok;
+            ok = MPI_File_write_at_all(file, static_cast<MPI_Offset>(header.status_offset + begin + offset),
+                                       status.data() + std::min<uint64_t>(offset, status.size()), static_cast<int>(status_part),
+                                       MPI_BYTE, MPI_STATUS_IGNORE) == MPI_SUCCESS && ok;
+        }
+        ok = MPI_File_close(&file) == MPI_SUCCESS && ok;
+        if (!all_ok(comm, ok))
+        {
+            if (rank == 0)
+                std::cerr << "Failed to write result file: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+bool project_distributed(MPI_Comm comm, const BatchProjector &projector, const std::string &input_path,
+                         const std::string &output_path, const DistributedOptions &options, DistributedStats &stats)
+{
+    stats = DistributedStats();
+    int rank = 0, size = 1;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    const int num_threads = std::max(options.num_threads, 1);
+    tbb::task_arena arena(num_threads);
+    const double start = MPI_Wtime();
+
+    // 1. 读取自己的一段，同时统计包围盒（只计有限坐标）
+    MappedFile file;
+    const double *xyz = nullptr;
+    uint64_t count = 0;
+    if (!all_ok(comm, open_point_file(input_path, file, xyz, count)))
+        return false;
+    const uint64_t begin = slice_begin(count, rank, size);
+    const size_t local_count = static_cast<size_t>(slice_begin(count, rank + 1, size) - begin);
+    if (!all_ok(comm, local_count <= static_cast<size_t>(INT_MAX)))
+    {
+        if (rank == 0)
+            std::cerr << "Too many points per rank: " << count << " points on " << size << " ranks" << std::endl;
+        return false;
+    }
+
+    std::vector<ShardPoint> points(local_count);
+    double lo[3] = {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+                    std::numeric_limits<double>::infinity()};
+    double hi[3] = {-lo[0], -lo[1], -lo[2]};
+    for (size_t i = 0; i < local_count; ++i)
+    {
+        const double *p = xyz + 3 * (begin + i);
+        points[i] = {0, begin + i, p[0], p[1], p[2]};
+        if (std::isfinite(p[0]) && std::isfinite(p[1]) && std::isfinite(p[2]))
+        {
+            for (int k = 0; k < 3; ++k)
+                lo[k] = std::min(lo[k], p[k]), hi[k] = std::max(hi[k], p[k]);
+        }
+    }
+    file.close();
+    const double read_done = MPI_Wtime();
+
+    // 2. 全局包围盒上的Morton码，样本排序后按分割点交换
+    MPI_Allreduce(MPI_IN_PLACE, lo, 3, MPI_DOUBLE, MPI_MIN, comm);
+    MPI_Allreduce(MPI_IN_PLACE, hi, 3, MPI_DOUBLE, MPI_MAX, comm);
+    const MortonGrid grid(lo, hi);
+    const auto point_less = [](const ShardPoint &a, const ShardPoint &b) {
+        return shard_less(a.key, a.index, b.key, b.index);
+    };
+    arena.execute([&] {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, local_count), [&](const tbb::blocked_range<size_t> &r) {
+            for (size_t i = r.begin(); i < r.end(); ++i)
+                points[i].key = grid.key(points[i].x, points[i].y, points[i].z);
+        });
+        tbb::parallel_sort(points.begin(), points.end(), point_less);
+    });
+
+    std::vector<SampleKey> splitters;
+    select_splitters(comm, points, std::max<size_t>(options.samples_per_rank, 1), splitters);
+    // 点已有序，发往各rank的点是连续的一段：第 r 段为 [splitters[r-1], splitters[r])
+    std::vector<int> send_counts(size, 0);
+    size_t first = 0;
+    for (int r = 0; r < size; ++r)
+    {
+        size_t last = local_count;
+        if (r < static_cast<int>(splitters.size()))
+        {
+            const SampleKey &s = splitters[r];
+            last = std::lower_bound(points.begin() + first, points.end(), s, [](const ShardPoint &p, const SampleKey &k) {
+                       return shard_less(p.key, p.index, k.key, k.index);
+                   }) - points.begin();
+        }
+        send_counts[r] = static_cast<int>(last - first);
+        first = last;
+    }
+    std::vector<ShardPoint> shard;
+    if (!exchange(comm, points, send_counts, shard))
+        return false;
+    std::vector<ShardPoint>().swap(points);
+    // 来自各rank的段各自有序，合并成rank内的Morton序
+    arena.execute([&] { tbb::parallel_sort(shard.begin(), shard.end(), point_less); });
+    const double partition_done = MPI_Wtime();
+
+    // 3. rank内线程并行投影
+    const size_t shard_count = shard.size();
+    PointArrays input;
+    input.x.resize(shard_count);
+    input.y.resize(shard_count);
+    input.z.resize(shard_count);
+    for (size_t i = 0; i < shard_count; ++i)
+    {
+        input.x[i] = shard[i].x;
+        input.y[i] = shard[i].y;
+        input.z[i] = shard[i].z;
+    }
+    ProjectionResultArrays output;
+    output.resize(shard_count);
+    if (options.warm_start)
+        project_batch_coherent(projector, input.batch(), output.buffers(), options.backend, num_threads);
+    else
+        project_batch(projector, input.batch(), output.buffers(), options.backend, num_threads);
+    const double project_done = MPI_Wtime();
+
+    // 4. 结果按原始下标送回读取它的rank
+    std::vector<uint64_t> slices(size + 1);
+    for (int r = 0; r <= size; ++r)
+        slices[r] = slice_begin(count, r, size);
+    std::vector<int> owner(shard_count);
+    std::vector<int> result_counts(size, 0);
+    uint64_t failed = 0;
+    for (size_t i = 0; i < shard_count; ++i)
+    {
+        owner[i] = static_cast<int>(std::upper_bound(slices.begin(), slices.end(), shard[i].index) - slices.begin()) - 1;
+        ++result_counts[owner[i]];
+        if (output.status[i] != PROJECTION_OK)
+            ++failed;
+    }
+    std::vector<size_t> cursor(size, 0);
+    for (int r = 1; r < size; ++r)
+        cursor[r] = cursor[r - 1] + result_counts[r - 1];
+    std::vector<ShardResult> outgoing(shard_count);
+    for (size_t i = 0; i < shard_count; ++i)
+    {
+        ShardResult &res = outgoing[cursor[owner[i]]++];
+        res = {shard[i].index, output.x[i], output.y[i], output.z[i], output.u[i], output.v[i], output.distance[i],
+               output.status[i]};
+    }
+    std::vector<ShardPoint>().swap(shard);
+    std::vector<ShardResult> returned;
+    if (!exchange(comm, outgoing, result_counts, returned))
+        return false;
+
+    std::vector<double> records(6 * local_count);
+    std::vector<unsigned char> status(local_count, PROJECTION_NOT_DONE);
+    for (const ShardResult &res : returned)
+    {
+        double *r = records.data() + 6 * (res.index - begin);
+        r[0] = res.x, r[1] = res.y, r[2] = res.z, r[3] = res.u, r[4] = res.v, r[5] = res.distance;
+        status[res.index - begin] = res.status;
+    }
+    const double restore_done = MPI_Wtime();
+
+    // 5. 集体写出
+    if (!output_path.empty() && !write_result_file(comm, output_path, count, begin, records, status))
+        return false;
+    const double write_done = MPI_Wtime();
+
+    std::vector<double> values = {static_cast<double>(shard_count), read_done - start, partition_done - read_done,
+                                  project_done - partition_done, restore_done - project_done,
+                                  write_done - restore_done, write_done - start};
+    std::vector<RankSpread> spreads;
+    reduce_spreads(comm, values, spreads);
+    MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_UINT64_T, MPI_SUM, comm);
+
+    stats.ranks = size;
+    stats.points = count;
+    stats.failed = failed;
+    stats.shard_points = spreads[0];
+    stats.read = spreads[1];
+    stats.partition = spreads[2];
+    stats.project = spreads[3];
+    stats.restore = spreads[4];
+    stats.write = spreads[5];
+    stats.total = spreads[6];
+    stats.elapsed = stats.total.max;
+    return true;
+}
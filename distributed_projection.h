@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <mpi.h>
+
+#include "batch_projection.h"
+
+// 多进程分片投影参数（所有rank须一致）
+struct DistributedOptions
+{
+    int num_threads = 1;                     // 每个rank内的投影线程数
+    ProjectionBackend backend = BACKEND_TBB; // rank内的并行后端
+    bool warm_start = false;                 // rank内沿Morton曲线热启动（project_batch_coherent）
+    size_t samples_per_rank = 1024;          // 每个rank为选分割点提供的样本数，越多各rank分到的点数越均衡
+};
+
+// 一个量在各rank上的分布
+struct RankSpread
+{
+    double min = 0.0;
+    double avg = 0.0;
+    double max = 0.0;
+
+    // 负载不均衡度 max / avg：1 表示完全均衡，作业耗时由最慢的rank决定
+    double imbalance() const { return avg > 0.0 ? max / avg : 1.0; }
+};
+
+// 分布式投影统计（所有rank上相同）
+struct DistributedStats
+{
+    int ranks = 0;
+    uint64_t points = 0;     // 全局点数
+    uint64_t failed = 0;     // 状态不为 PROJECTION_OK 的点数
+    RankSpread shard_points; // 各rank分片后实际投影的点数
+    RankSpread read;         // 各阶段耗时（秒）
+    RankSpread partition;
+    RankSpread project;
+    RankSpread restore;
+    RankSpread write;
+    RankSpread total;
+    double elapsed = 0.0;    // 最慢rank的总耗时，吞吐量按它计算
+};
+
+// 多进程分片投影，comm 中所有rank集体调用：
+// 1. 读取：各rank映射同一个点文件，按下标均分后读取自己的一段
+// 2. 分片：在全局包围盒上计算Morton码做样本排序（sample sort），每个rank分到Morton曲线上连续的一段，
+//    空间上紧凑；(Morton码, 下标) 作为排序键，大量点重合时也能均分
+// 3. 投影：rank内按Morton序用已有的线程并行投影（project_batch 或 project_batch_coherent）
+// 4. 送回：结果按原始下标送回读取它的rank
+// 5. 写出：MPI-IO集体写成与 project_stream 相同格式的结果文件（output_path 为空时跳过）
+// 点交换用 MPI_Alltoallv，单个rank收发的点数须小于 2^31
+// 任一rank失败时所有rank都返回false
+bool project_distributed(MPI_Comm comm, const BatchProjector &projector, const std::string &input_path,
+                         const std::string &output_path, const DistributedOptions &options, DistributedStats &stats);
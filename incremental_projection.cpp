@@ -0,0 +1,148 @@
+#include "incremental_projection.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/task_arena.h>
+#include <tbb/enumerable_thread_specific.h>
+
+namespace
+{
+    // 处理第i个点：跳过、热启动或全局求解；reference 与 output 在求解后更新
+    void update_point(const BatchProjector &projector, const IncrementalOptions &options, const PointBatch &input,
+                      PointArrays &reference, const ProjectionBuffers &output, size_t i,
+                      ProjectionWorkspace &workspace, IncrementalStats &stats)
+    {
+        const double x = input.x[i], y = input.y[i], z = input.z[i];
+        const double dx = x - reference.x[i], dy = y - reference.y[i], dz = z - reference.z[i];
+        const double moved = std::sqrt(dx * dx + dy * dy + dz * dz);
+        const bool ok = output.status[i] == PROJECTION_OK;
+
+        // 未移动的点（包括上次失败的点）和位移在阈值内的成功点直接跳过；NaN 位移不会进入此分支
+        if (moved == 0.0 || (ok && moved <= options.skip_distance))
+        {
+            ++stats.skipped;
+            return;
+        }
+        reference.x[i] = x, reference.y[i] = y, reference.z[i] = z;
+
+        if (projector.is_analytic())
+        {
+            projector.project_range(input, output, i, i + 1, workspace);
+            if (output.status[i] == PROJECTION_OK)
+                ++stats.resolved;
+            else
+                ++stats.failed;
+            return;
+        }
+
+        const gp_Pnt p(x, y, z);
+        LocalProjectionResult result;
+        if (ok && projector.refine_point(p, output.u[i], output.v[i], workspace, result, options.max_iterations) &&
+            result.distance <= output.distance[i] + moved + options.distance_slack)
+        {
+            store_projection(output, i, result);
+            ++stats.warm_solved;
+            return;
+        }
+
+        projector.project_point_general(input, output, i, workspace);
+        if (output.status[i] == PROJECTION_OK)
+            ++stats.resolved;
+        else
+            ++stats.failed;
+    }
+
+    void add_stats(IncrementalStats &total, const IncrementalStats &part)
+    {
+        total.skipped += part.skipped;
+        total.warm_solved += part.warm_solved;
+        total.resolved += part.resolved;
+        total.failed += part.failed;
+    }
+}
+
+IncrementalProjection::IncrementalProjection(const BatchProjector &projector, const IncrementalOptions &options)
+    : projector_(projector), options_(options)
+{
+}
+
+void IncrementalProjection::reset()
+{
+    reference_ = PointArrays();
+    results_ = ProjectionResultArrays();
+}
+
+IncrementalStats IncrementalProjection::update(const PointBatch &input, ProjectionBackend backend, int num_threads)
+{
+    IncrementalStats stats;
+    const size_t n = input.count;
+
+    // 首步或点数变化：整批全局求解
+    if (results_.size() != n || reference_.size() != n)
+    {
+        results_.resize(n);
+        project_batch(projector_, input, results_.buffers(), backend, num_threads, &workspaces_);
+        reference_.x.assign(input.x, input.x + n);
+        reference_.y.assign(input.y, input.y + n);
+        reference_.z.assign(input.z, input.z + n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (results_.status[i] == PROJECTION_OK)
+                ++stats.resolved;
+            else
+                ++stats.failed;
+        }
+        return stats;
+    }
+
+    const ProjectionBuffers output = results_.buffers();
+    if (backend == BACKEND_TBB)
+    {
+        tbb::enumerable_thread_specific<IncrementalStats> ets_stats;
+        tbb::task_arena arena(num_threads);
+        arena.execute([&] {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, n, ANALYTIC_BLOCK_SIZE), [&](const tbb::blocked_range<size_t> &r) {
+                ProjectionWorkspace &workspace = workspaces_.local();
+                IncrementalStats &part = ets_stats.local();
+                for (size_t i = r.begin(); i < r.end(); ++i)
+                    update_point(projector_, options_, input, reference_, output, i, workspace, part);
+            });
+        });
+        for (const auto &part : ets_stats)
+            add_stats(stats, part);
+    }
+    else if (backend == BACKEND_OPENMP)
+    {
+#ifdef _OPENMP
+        omp_set_num_threads(num_threads);
+#pragma omp parallel
+        {
+            ProjectionWorkspace &workspace = workspaces_.local();
+            IncrementalStats part;
+            // 跳过的点几乎不花时间，移动的点往往成片出现，用动态调度
+#pragma omp for schedule(dynamic, 256)
+            for (long long i = 0; i < static_cast<long long>(n); ++i)
+                update_point(projector_, options_, input, reference_, output, static_cast<size_t>(i), workspace, part);
+#pragma omp critical
+            add_stats(stats, part);
+        }
+#else
+        std::cerr << "OpenMP not enabled!" << std::endl;
+#endif
+    }
+    else
+    {
+        ProjectionWorkspace &workspace = workspaces_.local();
+        for (size_t i = 0; i < n; ++i)
+            update_point(projector_, options_, input, reference_, output, i, workspace, stats);
+    }
+    return stats;
+}
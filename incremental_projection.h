@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+
+#include "batch_projection.h"
+
+// 增量投影参数
+struct IncrementalOptions
+{
+    double skip_distance = 0.0;   // 相对上次求解位置的位移不超过该值的点直接沿用上次结果（0 表示只跳过未移动的点）
+    int max_iterations = 20;      // 局部Newton最大迭代次数
+    double distance_slack = 1e-7; // 距离上界检查的绝对容差
+};
+
+// 单步统计
+struct IncrementalStats
+{
+    size_t skipped = 0;     // 位移未超过阈值，沿用上次结果
+    size_t warm_solved = 0; // 以上次UV为种子局部求解被接受
+    size_t resolved = 0;    // 全局求解（首步、点数变化、上次失败或局部求解被拒绝）
+    size_t failed = 0;      // 全局求解也失败或输入非有限值
+};
+
+// 逐时间步的增量投影（网格变形、优化迭代中点只做微小移动）：
+// 保存每个点上次求解时的位置和结果，下一步
+// - 位移 |P - P_last| <= skip_distance 的点直接沿用结果（参考位置不更新，慢速漂移累积后仍会重算）
+// - 其余点以上次UV为种子做局部Newton，结果距离不超过 d_last + |P - P_last|（全局最近距离的上界）才接受，
+//   否则回退全局求解；初等曲面的移动点直接走闭式内核
+// 投影器须比本对象活得久；update 不可并发调用
+class IncrementalProjection
+{
+public:
+    explicit IncrementalProjection(const BatchProjector &projector, const IncrementalOptions &options = IncrementalOptions());
+
+    // 投影新一步的点；首次调用或点数与上一步不同时全部全局求解
+    IncrementalStats update(const PointBatch &input, ProjectionBackend backend, int num_threads);
+
+    // 最近一步的结果（每个点一项，与输入同序）
+    const ProjectionResultArrays &results() const { return results_; }
+    const IncrementalOptions &options() const { return options_; }
+    size_t size() const { return results_.size(); }
+
+    // 丢弃保存的状态，下一步全部重新求解
+    void reset();
+
+private:
+    const BatchProjector &projector_;
+    IncrementalOptions options_;
+    PointArrays reference_;          // 各点上次求解时的位置
+    ProjectionResultArrays results_;
+    ProjectionWorkspacePool workspaces_; // 各步共用的线程私有工作区
+};
@@ -0,0 +1,212 @@
+#include "local_projection.h"
+#include "surface_evaluators.h"
+
+#include <cmath>
+#include <algorithm>
+#include <Precision.hxx>
+#include <gp_Vec.hxx>
+
+namespace
+{
+    // 参数折回主周期或截断到参数域
+    inline double fit_param(double t, double tmin, double tmax, bool periodic, double period)
+    {
+        if (periodic)
+        {
+            t = tmin + std::fmod(t - tmin, period);
+            return t < tmin ? t + period : t;
+        }
+        return std::min(std::max(t, tmin), tmax);
+    }
+
+    // 参数落在边界且梯度指向域外时，该方向视为约束
+    inline bool at_bound(double t, double tmin, double tmax, bool periodic, double g)
+    {
+        if (periodic)
+            return false;
+        return (t <= tmin && g > 0.0) || (t >= tmax && g < 0.0);
+    }
+
+    const double ORTHOGONALITY_TOL = 1e-10; // 残差与切向量夹角余弦的收敛阈值
+    const double LOOSE_ORTHOGONALITY_TOL = 1e-6;
+    const int MAX_LINE_SEARCH = 8;
+}
+
+SurfaceParamDomain surface_param_domain(const Handle(Geom_Surface) & surface)
+{
+    SurfaceParamDomain d;
+    surface->Bounds(d.umin, d.umax, d.vmin, d.vmax);
+    d.uperiodic = surface->IsUPeriodic();
+    d.vperiodic = surface->IsVPeriodic();
+    if (d.uperiodic)
+        d.uperiod = surface->UPeriod();
+    if (d.vperiodic)
+        d.vperiod = surface->VPeriod();
+    return d;
+}
+
+namespace
+{
+    template <class Surface>
+    bool local_project_impl(const Surface &surface, const SurfaceParamDomain &domain,
+                            const gp_Pnt &p, double u0, double v0,
+                            LocalProjectionResult &result, int max_iterations)
+    {
+        double u = fit_param(u0, domain.umin, domain.umax, domain.uperiodic, domain.uperiod);
+        double v = fit_param(v0, domain.vmin, domain.vmax, domain.vperiodic, domain.vperiod);
+
+        gp_Pnt S;
+        gp_Vec Su, Sv, Suu, Svv, Suv;
+        surface.D2(u, v, S, Su, Sv, Suu, Svv, Suv);
+        gp_Vec d(p, S); // S - P
+        double f = d.SquareMagnitude();
+
+        result.converged = false;
+        int it = 0;
+        for (; it < max_iterations; ++it)
+        {
+            const double gu = Su.Dot(d), gv = Sv.Dot(d);
+            const double a = Su.SquareMagnitude(), b = Su.Dot(Sv), c = Sv.SquareMagnitude();
+            const double dn = std::sqrt(f);
+            const bool ulock = at_bound(u, domain.umin, domain.umax, domain.uperiodic, gu);
+            const bool vlock = at_bound(v, domain.vmin, domain.vmax, domain.vperiodic, gv);
+
+            // 收敛：点在曲面上，或残差与未被约束的切向量正交
+            if (dn <= Precision::Confusion() ||
+                ((ulock || std::abs(gu) <= ORTHOGONALITY_TOL * dn * std::sqrt(a)) &&
+                 (vlock || std::abs(gv) <= ORTHOGONALITY_TOL * dn * std::sqrt(c))))
+            {
+                result.converged = true;
+                break;
+            }
+
+            // Newton步：H * (du, dv) = -(gu, gv)
+            double h11 = a + Suu.Dot(d), h12 = b + Suv.Dot(d), h22 = c + Svv.Dot(d);
+            double det = h11 * h22 - h12 * h12;
+            if (!(h11 > 0.0 && h22 > 0.0 && det > 0.0))
+            {
+                // Hessian不正定（离曲面较远的凹侧），改用Gauss-Newton近似
+                h11 = a, h12 = b, h22 = c;
+                det = a * c - b * b;
+            }
+
+            double du = 0.0, dv = 0.0;
+            if (ulock && vlock)
+                break;
+            if (ulock)
+            {
+                if (h22 <= 0.0)
+                    break;
+                dv = -gv / h22;
+            }
+            else if (vlock)
+            {
+                if (h11 <= 0.0)
+                    break;
+                du = -gu / h11;
+            }
+            else
+            {
+                if (det <= 0.0) // 奇异参数点（如球面极点），交给全局求解
+                    break;
+                du = -(h22 * gu - h12 * gv) / det;
+                dv = -(h11 * gv - h12 * gu) / det;
+            }
+
+            // 回溯线搜索，保证距离单调下降
+            bool accepted = false;
+            double step = 1.0;
+            for (int ls = 0; ls < MAX_LINE_SEARCH; ++ls, step *= 0.5)
+            {
+                const double un = fit_param(u + step * du, domain.umin, domain.umax, domain.uperiodic, domain.uperiod);
+                const double vn = fit_param(v + step * dv, domain.vmin, domain.vmax, domain.vperiodic, domain.vperiod);
+                gp_Pnt Sn;
+                gp_Vec Sun, Svn, Suun, Svvn, Suvn;
+                surface.D2(un, vn, Sn, Sun, Svn, Suun, Svvn, Suvn);
+                const gp_Vec dnew(p, Sn);
+                const double fn = dnew.SquareMagnitude();
+                if (fn <= f)
+                {
+                    const bool tiny_step = std::abs(step * du) <= Precision::PConfusion() &&
+                                           std::abs(step * dv) <= Precision::PConfusion();
+                    u = un, v = vn, S = Sn, Su = Sun, Sv = Svn, Suu = Suun, Svv = Svvn, Suv = Suvn;
+                    d = dnew, f = fn;
+                    accepted = !tiny_step;
+                    if (tiny_step)
+                        result.converged = true;
+                    break;
+                }
+            }
+            if (!accepted)
+            {
+                // 无法继续下降：数值上已到极小，用宽松正交条件判定
+                if (!result.converged)
+                {
+                    const double dd = std::sqrt(f);
+                    const double gu2 = Su.Dot(d), gv2 = Sv.Dot(d);
+                    result.converged = dd <= Precision::Confusion() ||
+                                       (std::abs(gu2) <= LOOSE_ORTHOGONALITY_TOL * dd * Su.Magnitude() &&
+                                        std::abs(gv2) <= LOOSE_ORTHOGONALITY_TOL * dd * Sv.Magnitude());
+                }
+                break;
+            }
+        }
+
+        result.point = S;
+        result.u = u;
+        result.v = v;
+        result.distance = std::sqrt(f);
+        result.iterations = it;
+        return result.converged;
+    }
+}
+
+bool local_project_point(const Geom_Surface &surface, const SurfaceParamDomain &domain,
+                         const gp_Pnt &p, double u0, double v0,
+                         LocalProjectionResult &result, int max_iterations)
+{
+    return local_project_impl(surface, domain, p, u0, v0, result, max_iterations);
+}
+
+bool local_project_point(const Adaptor3d_Surface &surface, const SurfaceParamDomain &domain,
+                         const gp_Pnt &p, double u0, double v0,
+                         LocalProjectionResult &result, int max_iterations)
+{
+    return local_project_impl(surface, domain, p, u0, v0, result, max_iterations);
+}
+
+bool local_project_point(const PlaneEvaluator &surface, const SurfaceParamDomain &domain, const gp_Pnt &p,
+                         double u0, double v0, LocalProjectionResult &result, int max_iterations)
+{
+    return local_project_impl(surface, domain, p, u0, v0, result, max_iterations);
+}
+
+bool local_project_point(const CylinderEvaluator &surface, const SurfaceParamDomain &domain, const gp_Pnt &p,
+                         double u0, double v0, LocalProjectionResult &result, int max_iterations)
+{
+    return local_project_impl(surface, domain, p, u0, v0, result, max_iterations);
+}
+
+bool local_project_point(const ConeEvaluator &surface, const SurfaceParamDomain &domain, const gp_Pnt &p,
+                         double u0, double v0, LocalProjectionResult &result, int max_iterations)
+{
+    return local_project_impl(surface, domain, p, u0, v0, result, max_iterations);
+}
+
+bool local_project_point(const SphereEvaluator &surface, const SurfaceParamDomain &domain, const gp_Pnt &p,
+                         double u0, double v0, LocalProjectionResult &result, int max_iterations)
+{
+    return local_project_impl(surface, domain, p, u0, v0, result, max_iterations);
+}
+
+bool local_project_point(const TorusEvaluator &surface, const SurfaceParamDomain &domain, const gp_Pnt &p,
+                         double u0, double v0, LocalProjectionResult &result, int max_iterations)
+{
+    return local_project_impl(surface, domain, p, u0, v0, result, max_iterations);
+}
+
+bool local_project_point(const BSplineEvaluator &surface, const SurfaceParamDomain &domain, const gp_Pnt &p,
+                         double u0, double v0, LocalProjectionResult &result, int max_iterations)
+{
+    return local_project_impl(surface, domain, p, u0, v0, result, max_iterations);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <gp_Pnt.hxx>
+#include <Geom_Surface.hxx>
+#include <Adaptor3d_Surface.hxx>
+
+class PlaneEvaluator;
+class CylinderEvaluator;
+class ConeEvaluator;
+class SphereEvaluator;
+class TorusEvaluator;
+class BSplineEvaluator;
+
+// 曲面参数域（非周期方向在Newton迭代中截断，周期方向折回主周期）
+struct SurfaceParamDomain
+{
+    double umin = 0.0, umax = 0.0, vmin = 0.0, vmax = 0.0;
+    bool uperiodic = false, vperiodic = false;
+    double uperiod = 0.0, vperiod = 0.0;
+};
+
+SurfaceParamDomain surface_param_domain(const Handle(Geom_Surface) & surface);
+
+// 局部投影结果
+struct LocalProjectionResult
+{
+    gp_Pnt point;
+    double u = 0.0, v = 0.0;
+    double distance = 0.0;
+    int iterations = 0;
+    bool converged = false;
+};
+
+// 从种子(u0, v0)出发的局部Newton投影：最小化 |S(u,v) - P|^2 / 2
+// Hessian不正定时退化为Gauss-Newton步，并带简单的回溯线搜索
+// 只找种子附近的局部极小，是否为全局最近点由调用者判断
+bool local_project_point(const Geom_Surface &surface, const SurfaceParamDomain &domain,
+                         const gp_Pnt &p, double u0, double v0,
+                         LocalProjectionResult &result, int max_iterations = 20);
+
+// 同上，通过适配器求值（GeomAdaptor_Surface 内部带B样条span缓存，适合线程私有复用）
+bool local_project_point(const Adaptor3d_Surface &surface, const SurfaceParamDomain &domain,
+                         const gp_Pnt &p, double u0, double v0,
+                         LocalProjectionResult &result, int max_iterations = 20);
+
+// 同上，通过非虚特化求值器（见 surface_evaluators.h），求值与迭代内联在一起
+bool local_project_point(const PlaneEvaluator &surface, const SurfaceParamDomain &domain, const gp_Pnt &p,
+                         double u0, double v0, LocalProjectionResult &result, int max_iterations = 20);
+bool local_project_point(const CylinderEvaluator &surface, const SurfaceParamDomain &domain, const gp_Pnt &p,
+                         double u0, double v0, LocalProjectionResult &result, int max_iterations = 20);
+bool local_project_point(const ConeEvaluator &surface, const SurfaceParamDomain &domain, const gp_Pnt &p,
+                         double u0, double v0, LocalProjectionResult &result, int max_iterations = 20);
+bool local_project_point(const SphereEvaluator &surface, const SurfaceParamDomain &domain, const gp_Pnt &p,
+                         double u0, double v0, LocalProjectionResult &result, int max_iterations = 20);
+bool local_project_point(const TorusEvaluator &surface, const SurfaceParamDomain &domain, const gp_Pnt &p,
+                         double u0, double v0, LocalProjectionResult &result, int max_iterations = 20);
+bool local_project_point(const BSplineEvaluator &surface, const SurfaceParamDomain &domain, const gp_Pnt &p,
+                         double u0, double v0, LocalProjectionResult &result, int max_iterations = 20);
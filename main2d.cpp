@@ -1,25 +1,21 @@
-// OpenCASCADEͱ׼ͷļ
-#include <iostream>                        // 
-#include <Standard_Version.hxx>            // OpenCASCADE汾Ϣ
-#include <vtkVersion.h>                    // VTK汾Ϣ
-#include <gp_Circ.hxx>                     // λԲ
-#include <Geom_Circle.hxx>                 // Բ߶
-#include <GeomAPI_ProjectPointOnCurve.hxx> // ͶӰAPI
-#include <BRepBuilderAPI_MakeVertex.hxx>   // 㴴API
-#include <BRepBuilderAPI_MakeEdge.hxx>     // ߴAPI
-#include <TopoDS_Shape.hxx>                // ݽṹ
-#include <V3d_Viewer.hxx>                  // 3D鿴
-#include <AIS_InteractiveContext.hxx>      // 
-#include <WNT_Window.hxx>                  // Windowsش
-#include <windows.h>                       // Windows API
-#include <OpenGl_GraphicDriver.hxx>        // OpenGLͼ
-#include <TopoDS_Edge.hxx>                 // ˱߽ṹ
-#include <AIS_Shape.hxx>                   // ʽ״
-#include <V3d_View.hxx>                    // 3Dͼ
+// OpenCASCADE和标准库头文件
+#include <iostream>                        // 输入输出流库
+#include <string>                          // 字符串
+#include <Standard_Version.hxx>            // OpenCASCADE版本信息
+#include <vtkVersion.h>                    // VTK版本信息
+#include <gp_Circ.hxx>                     // 几何基本圆定义
+#include <Geom_Circle.hxx>                 // 几何圆曲线定义
+#include <GeomAPI_ProjectPointOnCurve.hxx> // 点投影到曲线API
+#include <BRepBuilderAPI_MakeEdge.hxx>     // 边创建API
+#include <TopoDS_Shape.hxx>                // 拓扑数据结构定义
+#include <TopoDS_Edge.hxx>                 // 拓扑边结构
+#include <AIS_Shape.hxx>                   // 交互式形状
+
+#include "point_cloud_view.h"              // 点云显示和（离屏）渲染
 
 int main()
 {
-    // 汾Ϣ
+    // 输出库版本信息
     std::cout << "OpenCASCADE Version: "
               << OCC_VERSION_MAJOR << "."
               << OCC_VERSION_MINOR << "."
@@ -31,15 +27,15 @@ int main()
               << vtkVersion::GetVTKBuildVersion()
               << std::endl;
 
-    // ԲXYƽ棬뾶50
-    gp_Ax2 axis(gp_Pnt(0, 0, 0), gp_Dir(0, 0, 1));            // ϵԭ㣬Z᷽
-    gp_Circ circle(axis, 50.0);                               // Բ
-    circle.SetLocation(gp_Pnt(0, 0, 0));                      // Բλ
-    Handle(Geom_Circle) geomCircle = new Geom_Circle(circle); // תΪ
+    // 创建几何圆（XY平面，半径50）
+    gp_Ax2 axis(gp_Pnt(0, 0, 0), gp_Dir(0, 0, 1));            // 定义坐标系（原点，Z轴方向）
+    gp_Circ circle(axis, 50.0);                               // 创建参数化圆
+    circle.SetLocation(gp_Pnt(0, 0, 0));                      // 设置圆心位置
+    Handle(Geom_Circle) geomCircle = new Geom_Circle(circle); // 转换为几何曲线
 
-    // Ե
-    gp_Pnt point1(20, 40, 0); // ԭʼ1Բڲ
-    gp_Pnt point2(60, 0, 0);  // ԭʼ2Բⲿ
+    // 创建测试点
+    gp_Pnt point1(20, 40, 0); // 原始点1（在圆内部）
+    gp_Pnt point2(60, 0, 0);  // 原始点2（在圆外部）
     std::cout << "Point 1: "
               << point1.X() << ", "
               << point1.Y() << ", "
@@ -49,21 +45,21 @@ int main()
               << point2.Y() << ", "
               << point2.Z() << std::endl;
 
-    // ʼͶӰ
+    // 初始化投影器
     GeomAPI_ProjectPointOnCurve projector;
 
-    // ͶӰһ
-    projector.Init(point1, geomCircle); // ͶӰĿ
-    if (projector.NbPoints() < 1)       // ͶӰ
+    // 投影第一个点
+    projector.Init(point1, geomCircle); // 设置投影目标和曲线
+    if (projector.NbPoints() < 1)       // 检查投影结果
     {
         std::cerr << "Error projecting point1" << std::endl;
         return 1;
     }
-    gp_Pnt projectedPoint1 = projector.NearestPoint();                // ȡͶӰ
-    Standard_Real dist1 = projector.LowerDistance();                  // 
-    Standard_Real parameter1 = projector.Parameter(1);                // ȡͶӰĲֵ
-    std::cout << "Parameter of Point 1: " << parameter1 << std::endl; // ֵ
-    gp_Pnt pointOnCircle1 = geomCircle->Value(parameter1);            // ȡӦĵ㣬ӦprojectedPoint1ͬ
+    gp_Pnt projectedPoint1 = projector.NearestPoint();                // 获取最近投影点
+    Standard_Real dist1 = projector.LowerDistance();                  // 最近距离
+    Standard_Real parameter1 = projector.Parameter(1);                // 获取投影点的参数值
+    std::cout << "Parameter of Point 1: " << parameter1 << std::endl; // 输出参数值
+    gp_Pnt pointOnCircle1 = geomCircle->Value(parameter1);            // 获取参数对应的点，应该与projectedPoint1相同
     std::cout << "Point on Circle: "
               << pointOnCircle1.X() << ", "
               << pointOnCircle1.Y() << ", "
@@ -77,18 +73,18 @@ int main()
     std::cout << "Distance to Point 1: "
               << dist1 << std::endl;
 
-    // ͶӰڶ
+    // 投影第二个点
     projector.Init(point2, geomCircle);
     if (projector.NbPoints() < 1)
     {
         std::cerr << "Error projecting point2" << std::endl;
         return 1;
     }
-    gp_Pnt projectedPoint2 = projector.NearestPoint();                // ȡͶӰ
-    Standard_Real dist2 = projector.LowerDistance();                  // 
-    Standard_Real parameter2 = projector.Parameter(1);                // ȡͶӰĲֵ
-    std::cout << "Parameter of Point 2: " << parameter2 << std::endl; // ֵ
-    gp_Pnt pointOnCircle2 = geomCircle->Value(parameter2);            // ȡӦĵ㣬ӦprojectedPoint2ͬ
+    gp_Pnt projectedPoint2 = projector.NearestPoint();                // 获取最近投影点
+    Standard_Real dist2 = projector.LowerDistance();                  // 最近距离
+    Standard_Real parameter2 = projector.Parameter(1);                // 获取投影点的参数值
+    std::cout << "Parameter of Point 2: " << parameter2 << std::endl; // 输出参数值
+    gp_Pnt pointOnCircle2 = geomCircle->Value(parameter2);            // 获取参数对应的点，应该与projectedPoint2相同
     std::cout << "Point on Circle: "
               << pointOnCircle2.X() << ", "
               << pointOnCircle2.Y() << ", "
@@ -102,60 +98,39 @@ int main()
     std::cout << "Distance to Point 2: "
               << dist2 << std::endl;
 
-    // ʼӻϵͳ
-    Handle(OpenGl_GraphicDriver) graphicDriver = new OpenGl_GraphicDriver(NULL); // OpenGL
-    Handle(V3d_Viewer) viewer = new V3d_Viewer(graphicDriver);                   // 3D鿴
-    Handle(AIS_InteractiveContext) context = new AIS_InteractiveContext(viewer); // 
-
-    // ʾԲ
-    TopoDS_Edge circleEdge = BRepBuilderAPI_MakeEdge(geomCircle);      // ˱
-    Handle(AIS_Shape) aisCircle = new AIS_Shape(circleEdge);           // ʽ״
-    context->SetColor(aisCircle, Quantity_NOC_YELLOW, Standard_False); // ûɫ
-    context->Display(aisCircle, Standard_True);                        // ʾ״
-
-    // ˽ṹ
-    TopoDS_Vertex vertex1 = BRepBuilderAPI_MakeVertex(point1);            // ԭʼ1
-    TopoDS_Vertex vertex2 = BRepBuilderAPI_MakeVertex(point2);            // ԭʼ2
-    TopoDS_Vertex projVert1 = BRepBuilderAPI_MakeVertex(projectedPoint1); // ͶӰ1
-    TopoDS_Vertex projVert2 = BRepBuilderAPI_MakeVertex(projectedPoint2); // ͶӰ2
-
-    // ʾԭʼ㣨ɫ
-    Handle(AIS_Shape) aisPoint1 = new AIS_Shape(vertex1);
-    Handle(AIS_Shape) aisPoint2 = new AIS_Shape(vertex2);
-    context->SetColor(aisPoint1, Quantity_NOC_RED, Standard_False); // úɫ
-    context->SetColor(aisPoint2, Quantity_NOC_RED, Standard_False);
-    context->Display(aisPoint1, Standard_True); // ʾ1
-    context->Display(aisPoint2, Standard_True); // ʾ2
-
-    // ʾͶӰ㣨ɫ
-    Handle(AIS_Shape) aisProj1 = new AIS_Shape(projVert1);
-    Handle(AIS_Shape) aisProj2 = new AIS_Shape(projVert2);
-    context->SetColor(aisProj1, Quantity_NOC_GREEN, Standard_False); // ɫ
-    context->SetColor(aisProj2, Quantity_NOC_GREEN, Standard_False);
-    context->Display(aisProj1, Standard_True); // ʾͶӰ1
-    context->Display(aisProj2, Standard_True); // ʾͶӰ2
-
-    // 3Dͼ
-    HWND hwnd = GetConsoleWindow(); // ȡ̨ھ
-    if (hwnd == NULL)
-    {
-        std::cerr << "Error: Could not get console window" << std::endl;
+    // 初始化可视化系统
+    Handle(AIS_InteractiveContext) context = create_view_context(); // OpenGL驱动、查看器和交互上下文
+
+    // 创建并显示圆边
+    TopoDS_Edge circleEdge = BRepBuilderAPI_MakeEdge(geomCircle);      // 创建拓扑边
+    Handle(AIS_Shape) aisCircle = new AIS_Shape(circleEdge);           // 创建交互式形状
+    context->SetColor(aisCircle, Quantity_NOC_YELLOW, Standard_False); // 设置黄色
+    context->Display(aisCircle, Standard_False);                       // 显示形状
+
+    // 原始点和投影点各作为一个点云显示（每组一个 Graphic3d_ArrayOfPoints）
+    PointArrays originals, projections;
+    originals.push_back(point1);
+    originals.push_back(point2);
+    projections.push_back(projectedPoint1);
+    projections.push_back(projectedPoint2);
+    context->Display(make_point_cloud(originals.batch(), Quantity_NOC_RED), Standard_False);    // 原始点（红色）
+    context->Display(make_point_cloud(projections.batch(), Quantity_NOC_GREEN), Standard_False); // 投影点（绿色）
+
+    // 创建并配置3D视图：Windows下显示在控制台窗口，其它平台离屏渲染到图片
+#ifdef _WIN32
+    const std::string image_path;
+#else
+    const std::string image_path = "circle_projection.ppm";
+#endif
+    Handle(V3d_View) view = render_view(context, V3d_YnegZpos, image_path); // X轴正方向，Z轴负方向
+    if (view.IsNull())
         return 1;
-    }
-    Handle(WNT_Window) window = new WNT_Window(hwnd); // Windows
-    Handle(V3d_View) view = viewer->CreateView();     // 3Dͼ
-    view->SetWindow(window);                          // 
-    view->SetProj(V3d_YnegZpos);                      // XZḺ
-    view->SetTwist(0.0);                              // ͼת
-    if (!window->IsMapped())                          // 鴰ӳ״̬
-    {
-        window->Map(); // ӳ䴰ڵĻ
-    }
-    view->FitAll(); // Զͼ
-    view->Redraw(); // ػͼ
-
-    // ֳ
+#ifdef _WIN32
+    // 保持程序运行
     std::cout << "Press Enter to exit..." << std::endl;
-    std::cin.ignore(); // ȴû
+    std::cin.ignore(); // 等待用户输入
+#else
+    std::cout << "离屏渲染结果: " << image_path << std::endl;
+#endif
     return 0;
 }
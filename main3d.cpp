@@ -1,35 +1,44 @@
 #include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
 #include <gp_Sphere.hxx>
 #include <Geom_SphericalSurface.hxx>
 #include <GeomAPI_ProjectPointOnSurf.hxx>
 #include <BRepPrimAPI_MakeSphere.hxx>
-#include <BRepBuilderAPI_MakeVertex.hxx>
 #include <TopoDS_Shape.hxx>
-#include <V3d_Viewer.hxx>
-#include <AIS_InteractiveContext.hxx>
-#include <WNT_Window.hxx>
-#include <windows.h>
-#include <OpenGl_GraphicDriver.hxx>
 #include <AIS_Shape.hxx>
-#include <V3d_View.hxx>
 
-int main()
+#include "batch_projection.h"
+#include "point_cloud_view.h"
+#include "projection_output.h"
+
+// 用法: DEMO_OCCT_3D [点数] [输出前缀] [显示点数上限]
+// 批量投影 [-100, 100]^3 内的随机点到半径50的球面，结果写成 <前缀>_input.vtp / <前缀>_projected.vtp，
+// 输入点（按距离着色）和投影点（绿色）各作为一个点云显示；非Windows平台离屏渲染到 <前缀>.ppm
+int main(int argc, char **argv)
 {
-    // 壨뾶50
+    const size_t num_points = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : 1000000;
+    const std::string prefix = argc > 2 ? argv[2] : "projection";
+    const size_t max_display = argc > 3 ? static_cast<size_t>(std::strtoull(argv[3], nullptr, 10)) : 2000000;
+
+    // 创建几何球体（半径50）
     gp_Ax3 axis(gp_Pnt(0, 0, 0), gp_Dir(0, 0, 1));
     gp_Sphere sphere(axis, 50.0);
     Handle(Geom_SphericalSurface) geomSphere = new Geom_SphericalSurface(sphere);
 
-    // άԵ
-    gp_Pnt point1(20, 40, 30); // ڵ
-    gp_Pnt point2(60, 0, 40);  // 
+    // 创建三维测试点
+    gp_Pnt point1(20, 40, 30); // 球内点
+    gp_Pnt point2(60, 0, 40);  // 球外点
     std::cout << "Point 1: " << point1.X() << ", " << point1.Y() << ", " << point1.Z() << std::endl;
     std::cout << "Point 2: " << point2.X() << ", " << point2.Y() << ", " << point2.Z() << std::endl;
 
-    // ʼͶӰ
+    // 初始化曲面投影器
     GeomAPI_ProjectPointOnSurf projector;
 
-    // ͶӰһ
+    // 投影第一个点
     projector.Init(point1, geomSphere);
     if (projector.NbPoints() < 1) {
         std::cerr << "Error projecting point1" << std::endl;
@@ -48,7 +57,7 @@ int main()
     std::cout << "Sphere Point 1: " << spherePoint1.X() << ", " 
               << spherePoint1.Y() << ", " << spherePoint1.Z() << std::endl;
     
-    // ͶӰڶ
+    // 投影第二个点
     projector.Init(point2, geomSphere);
     if (projector.NbPoints() < 1) {
         std::cerr << "Error projecting point2" << std::endl;
@@ -68,51 +77,69 @@ int main()
     std::cout << "Sphere Point 2: " << spherePoint2.X() << ", " 
               << spherePoint2.Y() << ", " << spherePoint2.Z() << std::endl;
 
-    // ʼӻϵͳ
-    Handle(OpenGl_GraphicDriver) graphicDriver = new OpenGl_GraphicDriver(NULL);
-    Handle(V3d_Viewer) viewer = new V3d_Viewer(graphicDriver);
-    Handle(AIS_InteractiveContext) context = new AIS_InteractiveContext(viewer);
+    // 批量投影
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> dist(-100.0, 100.0);
+    PointArrays points;
+    points.reserve(num_points);
+    for (size_t i = 0; i < num_points; ++i)
+    {
+        const double x = dist(rng), y = dist(rng), z = dist(rng);
+        points.push_back(gp_Pnt(x, y, z));
+    }
+    ProjectionResultArrays results;
+    results.resize(num_points);
+    BatchProjector batch_projector(geomSphere);
+    const int num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    auto start = std::chrono::steady_clock::now();
+    project_batch(batch_projector, points.batch(), results.buffers(), BACKEND_TBB, num_threads > 0 ? num_threads : 1);
+    std::cout << "批量投影 " << num_points << " 个点耗时: "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " 秒" << std::endl;
+
+    // 结果写成VTK点集（直接从结果缓冲写出），可在ParaView中按 distance 着色查看
+    start = std::chrono::steady_clock::now();
+    if (!write_projection_vtp(prefix + "_input.vtp", prefix + "_projected.vtp", points.batch(), results.buffers()))
+        return 1;
+    std::cout << "已写出 " << prefix << "_input.vtp / " << prefix << "_projected.vtp，耗时: "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " 秒" << std::endl;
 
-    // ʾ
-    // gp_Sphereȡ
+    // 初始化可视化系统
+    Handle(AIS_InteractiveContext) context = create_view_context();
+
+    // 创建并显示球体
+    // 从gp_Sphere中提取构造参数
     gp_Pnt center = sphere.Location();
     Standard_Real radius = sphere.Radius();
     BRepPrimAPI_MakeSphere mkSphere(center, radius);
     TopoDS_Shape sphereShape = mkSphere.Shape();
     Handle(AIS_Shape) aisSphere = new AIS_Shape(sphereShape);
     context->SetColor(aisSphere, Quantity_NOC_YELLOW, Standard_False);
-    context->Display(aisSphere, Standard_True);
-    context->SetDisplayMode(aisSphere, 1, Standard_True);
-
-    // ʾԭʼ㣨ɫ
-    Handle(AIS_Shape) aisPoint1 = new AIS_Shape(BRepBuilderAPI_MakeVertex(point1));
-    Handle(AIS_Shape) aisPoint2 = new AIS_Shape(BRepBuilderAPI_MakeVertex(point2));
-    context->SetColor(aisPoint1, Quantity_NOC_RED, Standard_False);
-    context->SetColor(aisPoint2, Quantity_NOC_RED, Standard_False);
-    context->Display(aisPoint1, Standard_True);
-    context->Display(aisPoint2, Standard_True);
+    context->Display(aisSphere, Standard_False);
+    context->SetDisplayMode(aisSphere, 1, Standard_False);
 
-    // ʾͶӰ㣨ɫ
-    Handle(AIS_Shape) aisProj1 = new AIS_Shape(BRepBuilderAPI_MakeVertex(projectedPoint1));
-    Handle(AIS_Shape) aisProj2 = new AIS_Shape(BRepBuilderAPI_MakeVertex(projectedPoint2));
-    context->SetColor(aisProj1, Quantity_NOC_GREEN, Standard_False);
-    context->SetColor(aisProj2, Quantity_NOC_GREEN, Standard_False);
-    context->Display(aisProj1, Standard_True);
-    context->Display(aisProj2, Standard_True);
+    // 原始点（按到球面的距离着色）和投影点（绿色），各一个点云
+    const ProjectionBuffers output = results.buffers();
+    PointBatch projected;
+    projected.x = output.x, projected.y = output.y, projected.z = output.z;
+    projected.count = num_points;
+    context->Display(make_point_cloud(points.batch(), Quantity_NOC_RED, output.distance, max_display), Standard_False);
+    context->Display(make_point_cloud(projected, Quantity_NOC_GREEN, nullptr, max_display), Standard_False);
 
-    // 3Dͼ
-    HWND hwnd = GetConsoleWindow();
-    Handle(WNT_Window) window = new WNT_Window(hwnd);
-    Handle(V3d_View) view = viewer->CreateView();
-    view->SetWindow(window);
-    view->SetProj(V3d_XposYposZpos);
-    view->SetTwist(0.0);
-    if (!window->IsMapped()) window->Map();
-    view->FitAll();
-    view->Redraw();
-
-    // ֳ
+    // 创建3D视图
+#ifdef _WIN32
+    const std::string image_path;
+#else
+    const std::string image_path = prefix + ".ppm";
+#endif
+    Handle(V3d_View) view = render_view(context, V3d_XposYposZpos, image_path);
+    if (view.IsNull())
+        return 1;
+#ifdef _WIN32
+    // 保持程序运行
     std::cout << "Press Enter to exit..." << std::endl;
     std::cin.ignore();
+#else
+    std::cout << "离屏渲染结果: " << image_path << std::endl;
+#endif
     return 0;
 }
@@ -0,0 +1,112 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <Bnd_Box.hxx>
+#include <BRepBndLib.hxx>
+#include <TopoDS_Shape.hxx>
+
+#include "brep_projection.h"
+
+// 用法: DEMO_OCCT_BREP [模型文件(.igs/.iges/.stp/.step)] [线程数]
+int main(int argc, char **argv)
+{
+    const std::string path = argc > 1 ? argv[1] : "testfile/circle.iges";
+    int num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (argc > 2)
+        num_threads = std::atoi(argv[2]);
+    if (num_threads <= 0)
+        num_threads = 1;
+
+    TopoDS_Shape shape = load_cad_shape(path);
+    if (shape.IsNull())
+        return 1;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    BRepProjector projector(shape);
+    auto end = std::chrono::high_resolution_clock::now();
+    const double build_time = std::chrono::duration<double>(end - start).count();
+    std::cout << "模型: " << path << "，面 " << projector.nb_faces() << " 个，边 " << projector.nb_edges()
+              << " 个，BVH节点 " << projector.nb_nodes() << " 个" << std::endl;
+    std::cout << "预处理耗时: " << build_time << " 秒" << std::endl;
+    if (projector.nb_nodes() == 0)
+    {
+        std::cerr << "模型中没有可投影的面或边" << std::endl;
+        return 1;
+    }
+
+    // 在模型包围盒（各方向放大一半）内随机生成点
+    Bnd_Box bnd;
+    BRepBndLib::Add(shape, bnd);
+    double xmin, ymin, zmin, xmax, ymax, zmax;
+    bnd.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+    const double margin = 0.5 * std::sqrt(bnd.SquareExtent());
+    const int num_points = 200000;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dx(xmin - margin, xmax + margin), dy(ymin - margin, ymax + margin),
+        dz(zmin - margin, zmax + margin);
+    PointArrays points;
+    points.reserve(num_points);
+    for (int i = 0; i < num_points; ++i)
+    {
+        const double x = dx(rng), y = dy(rng), z = dz(rng);
+        points.push_back(gp_Pnt(x, y, z));
+    }
+
+    ProjectionResultArrays results;
+    results.resize(num_points);
+    std::vector<int> element(num_points);
+    std::vector<unsigned char> element_type(num_points);
+    BRepElementBuffers elements;
+    elements.element = element.data();
+    elements.type = element_type.data();
+
+    const ProjectionBackend backends[3] = {BACKEND_SERIAL, BACKEND_TBB, BACKEND_OPENMP};
+    const char *names[3] = {"串行", "TBB", "OpenMP"};
+    double times[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        start = std::chrono::high_resolution_clock::now();
+        project_brep_batch(projector, points.batch(), results.buffers(), elements, backends[k], num_threads);
+        end = std::chrono::high_resolution_clock::now();
+        times[k] = std::chrono::duration<double>(end - start).count();
+        std::cout << names[k] << "BVH投影耗时: " << times[k] << " 秒" << std::endl;
+    }
+
+    // 抽样与逐元素暴力投影比较
+    const int num_checks = std::min(num_points, 2000);
+    int mismatch = 0, failed = 0;
+    BRepProjectionWorkspace workspace;
+    BRepProjectionResult reference;
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_checks; ++i)
+    {
+        const gp_Pnt p(points.x[i], points.y[i], points.z[i]);
+        if (!projector.project_point_brute_force(p, workspace, reference) || results.status[i] != PROJECTION_OK)
+        {
+            ++failed;
+            continue;
+        }
+        if (std::abs(reference.distance - results.distance[i]) > 1e-7)
+            ++mismatch;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    const double brute_time = std::chrono::duration<double>(end - start).count() * num_points / num_checks;
+
+    int on_face = 0, on_edge = 0;
+    for (int i = 0; i < num_points; ++i)
+    {
+        on_face += element_type[i] == BREP_FACE;
+        on_edge += element_type[i] == BREP_EDGE;
+    }
+    std::cout << "最近元素为面/边的点数: " << on_face << " / " << on_edge << std::endl;
+    std::cout << "抽样 " << num_checks << " 点与暴力投影距离不一致点数: " << mismatch << "，失败点数: " << failed << std::endl;
+    std::cout << "暴力投影估算耗时（串行）: " << brute_time << " 秒，BVH串行加速比 " << brute_time / times[0] << std::endl;
+    std::cout << "TBB加速比: " << times[0] / times[1] << "，OpenMP加速比: " << times[0] / times[2]
+              << "（" << num_threads << " 线程）" << std::endl;
+    return 0;
+}
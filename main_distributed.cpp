@@ -0,0 +1,156 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <mpi.h>
+#include <gp_Ax3.hxx>
+#include <gp_Sphere.hxx>
+#include <Geom_SphericalSurface.hxx>
+#include <Geom_BSplineSurface.hxx>
+#include <GeomConvert.hxx>
+
+#include "distributed_projection.h"
+#include "point_stream.h"
+
+namespace
+{
+    void print_spread(const char *name, const RankSpread &s)
+    {
+        std::cout << "  " << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(4)
+                  << std::setw(10) << s.min << std::setw(10) << s.avg << std::setw(10) << s.max
+                  << std::setprecision(2) << std::setw(10) << s.imbalance() << std::endl;
+    }
+}
+
+// 用法: mpirun -np <进程数> DEMO_OCCT_MPI <输入点文件> <结果文件> [每进程线程数] [--generate 点数] [--nurbs] [--warm]
+// 投影到半径50的球面（--nurbs 时用其NURBS表示）；--generate 由 rank 0 先在 [-100, 100]^3 内生成随机点写入输入文件
+// 每进程线程数默认取本机硬件线程数除以本机上的进程数，单机多进程测试时不会超额订阅
+int main(int argc, char **argv)
+{
+    int provided = 0;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided); // 只有主线程调用MPI，TBB工作线程不调用
+    int rank = 0, size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (argc < 3)
+    {
+        if (rank == 0)
+            std::cerr << "用法: mpirun -np <进程数> " << argv[0]
+                      << " <输入点文件> <结果文件> [每进程线程数] [--generate 点数] [--nurbs] [--warm]" << std::endl;
+        MPI_Finalize();
+        return 1;
+    }
+    const std::string input_path = argv[1];
+    const std::string output_path = argv[2];
+
+    // 同一节点上的进程数，用于默认线程数
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+    int node_ranks = 1;
+    MPI_Comm_size(node_comm, &node_ranks);
+    MPI_Comm_free(&node_comm);
+
+    DistributedOptions options;
+    options.num_threads = static_cast<int>(std::thread::hardware_concurrency()) / node_ranks;
+    uint64_t generate = 0;
+    bool nurbs = false;
+    for (int i = 3; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--generate") == 0 && i + 1 < argc)
+            generate = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--nurbs") == 0)
+            nurbs = true;
+        else if (std::strcmp(argv[i], "--warm") == 0)
+            options.warm_start = true;
+        else
+            options.num_threads = std::atoi(argv[i]);
+    }
+    if (options.num_threads <= 0)
+        options.num_threads = 1;
+
+    if (generate > 0)
+    {
+        int ok = 1;
+        if (rank == 0)
+        {
+            std::mt19937_64 rng(42);
+            std::uniform_real_distribution<double> dist(-100.0, 100.0);
+            ok = write_point_file(input_path, generate, 1 << 20, [&](uint64_t begin, uint64_t end, double *xyz) {
+                for (uint64_t i = 0; i < 3 * (end - begin); ++i)
+                    xyz[i] = dist(rng);
+            });
+            if (ok)
+                std::cout << "已生成 " << generate << " 个点: " << input_path << std::endl;
+            else
+                std::cerr << "无法写入点文件: " << input_path << std::endl;
+        }
+        MPI_Bcast(&ok, 1, MPI_INT, 0, MPI_COMM_WORLD); // 其它rank等生成完成后再读
+        if (!ok)
+        {
+            MPI_Finalize();
+            return 1;
+        }
+    }
+
+    const double sphere_radius = 50.0;
+    Handle(Geom_SphericalSurface) sphere = new Geom_SphericalSurface(gp_Sphere(gp_Ax3(gp_Pnt(0, 0, 0), gp_Dir(0, 0, 1)), sphere_radius));
+    Handle(Geom_Surface) surface = sphere;
+    if (nurbs)
+        surface = GeomConvert::SurfaceToBSplineSurface(sphere);
+    BatchProjector projector(surface);
+
+    DistributedStats stats;
+    if (!project_distributed(MPI_COMM_WORLD, projector, input_path, output_path, options, stats))
+    {
+        MPI_Finalize();
+        return 1;
+    }
+
+    int exit_code = 0;
+    if (rank == 0)
+    {
+        std::cout << "分布式投影（" << (nurbs ? "NURBS球面" : "解析球面") << (options.warm_start ? "，热启动" : "")
+                  << "）: " << stats.points << " 个点，" << stats.ranks << " 个进程 × " << options.num_threads
+                  << " 线程，耗时 " << stats.elapsed << " 秒（" << stats.points / stats.elapsed / 1e6
+                  << " 百万点/秒），失败点数: " << stats.failed << std::endl;
+        std::cout << "各进程分布（最小 / 平均 / 最大，不均衡度 = 最大 / 平均）:" << std::endl;
+        std::cout << "  " << std::left << std::setw(12) << "" << std::right << std::setw(10) << "min" << std::setw(10)
+                  << "avg" << std::setw(10) << "max" << std::setw(10) << "max/avg" << std::endl;
+        print_spread("points(M)", {stats.shard_points.min / 1e6, stats.shard_points.avg / 1e6, stats.shard_points.max / 1e6});
+        print_spread("read", stats.read);
+        print_spread("partition", stats.partition);
+        print_spread("project", stats.project);
+        print_spread("restore", stats.restore);
+        print_spread("write", stats.write);
+        print_spread("total", stats.total);
+        std::cout << std::defaultfloat;
+
+        // 重新映射结果文件，检查投影点是否都在球面上
+        MappedFile result;
+        if (!result.open_read(output_path))
+            exit_code = 1;
+        else
+        {
+            const ResultFileHeader *header = reinterpret_cast<const ResultFileHeader *>(result.data());
+            const double *records = reinterpret_cast<const double *>(result.data() + header->record_offset);
+            const unsigned char *status = result.data() + header->status_offset;
+            uint64_t off_surface = 0;
+            for (uint64_t i = 0; i < header->count; ++i)
+            {
+                const double *r = records + 6 * i;
+                if (status[i] == PROJECTION_OK && std::abs(std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]) - sphere_radius) > 1e-6)
+                    ++off_surface;
+            }
+            std::cout << "不在球面上的投影点: " << off_surface << std::endl;
+            exit_code = off_surface == 0 ? 0 : 1;
+        }
+    }
+    MPI_Bcast(&exit_code, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Finalize();
+    return exit_code;
+}
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <TopoDS_Shape.hxx>
+
+#include "projection_service.h"
+
+namespace
+{
+    std::atomic<bool> interrupted(false);
+
+    void on_interrupt(int)
+    {
+        interrupted = true;
+    }
+
+    void print_usage(const char *program)
+    {
+        std::cerr << "用法: " << program << " serve <模型文件(.igs/.iges/.stp/.step)> <套接字路径> [线程数] [每连接在途请求数]\n"
+                  << "      " << program << " client <套接字路径> [每批点数] [批数]" << std::endl;
+    }
+
+    // 加载模型并预处理一次，之后常驻等待请求，Ctrl+C 退出
+    int serve(const std::string &model_path, const std::string &socket_path, const ServiceOptions &options)
+    {
+        TopoDS_Shape shape = load_cad_shape(model_path);
+        if (shape.IsNull())
+            return 1;
+        const auto start = std::chrono::steady_clock::now();
+        BRepProjector projector(shape);
+        const double build_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (projector.nb_nodes() == 0)
+        {
+            std::cerr << "模型中没有可投影的面或边" << std::endl;
+            return 1;
+        }
+
+        ProjectionService service(projector, options);
+        if (!service.listen(socket_path))
+            return 1;
+        std::cout << "模型: " << model_path << "，面 " << projector.nb_faces() << " 个，边 " << projector.nb_edges()
+                  << " 个，预处理耗时 " << build_time << " 秒" << std::endl;
+        std::cout << "投影服务已启动: " << socket_path << "，线程数 " << options.num_threads << "（Ctrl+C 退出）" << std::endl;
+
+        // 信号处理函数里只置标志，由监视线程调用 stop()
+        std::signal(SIGINT, on_interrupt);
+        std::signal(SIGTERM, on_interrupt);
+        std::atomic<bool> finished(false);
+        std::thread watcher([&] {
+            while (!interrupted && !finished)
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            service.stop();
+        });
+        service.run();
+        finished = true;
+        watcher.join();
+
+        const ServiceStats stats = service.stats();
+        std::cout << "服务已停止：连接 " << stats.connections << " 个，请求 " << stats.requests << " 个，点 "
+                  << stats.points << " 个" << std::endl;
+        return 0;
+    }
+
+    // 发送线程连续发出全部批次，主线程按顺序接收，统计吞吐量；再测一次单请求往返延迟
+    int client(const std::string &socket_path, size_t batch_points, int nb_batches)
+    {
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<double> dist(-100.0, 100.0);
+        PointArrays points;
+        points.reserve(batch_points);
+        for (size_t i = 0; i < batch_points; ++i)
+        {
+            const double x = dist(rng), y = dist(rng), z = dist(rng);
+            points.push_back(gp_Pnt(x, y, z));
+        }
+
+        ProjectionClient connection;
+        if (!connection.connect(socket_path))
+            return 1;
+
+        const auto start = std::chrono::steady_clock::now();
+        std::atomic<bool> send_failed(false);
+        std::thread sender([&] {
+            for (int b = 0; b < nb_batches; ++b)
+            {
+                if (!connection.send(points.batch(), static_cast<uint64_t>(b)))
+                {
+                    send_failed = true;
+                    return;
+                }
+            }
+        });
+        ProjectionResultArrays results;
+        std::vector<int> element;
+        std::vector<unsigned char> type;
+        uint64_t failed = 0;
+        int received = 0;
+        for (; received < nb_batches; ++received)
+        {
+            uint64_t id = 0;
+            ServiceStatus status = SERVICE_OK;
+            if (!connection.receive(id, results, &element, &type, &status) || id != static_cast<uint64_t>(received))
+            {
+                std::cerr << "接收第 " << received << " 批结果失败（服务端状态 " << status << "）" << std::endl;
+                break;
+            }
+            for (size_t i = 0; i < results.size(); ++i)
+                failed += results.status[i] != PROJECTION_OK;
+        }
+        sender.join(); // 服务端出错时会断开连接，发送线程随之返回
+        if (send_failed || received < nb_batches)
+            return 1;
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double total = static_cast<double>(batch_points) * nb_batches;
+        std::cout << "流水线投影 " << nb_batches << " 批 × " << batch_points << " 点，耗时 " << elapsed << " 秒（"
+                  << total / elapsed / 1e6 << " 百万点/秒），失败点数 " << failed << std::endl;
+
+        const auto round_trip = std::chrono::steady_clock::now();
+        if (!connection.project(points.batch(0, std::min<size_t>(batch_points, 1000)), results, &element, &type))
+            return 1;
+        std::cout << "单请求往返（" << results.size() << " 点）: "
+                  << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - round_trip).count()
+                  << " 毫秒" << std::endl;
+        return 0;
+    }
+}
+
+// 常驻本地投影服务：网格生成器等调用方通过Unix域套接字批量提交投影请求，
+// 省去每次启动进程、读取模型和预处理曲面的开销
+int main(int argc, char **argv)
+{
+    if (argc >= 4 && std::strcmp(argv[1], "serve") == 0)
+    {
+        ServiceOptions options;
+        options.num_threads = static_cast<int>(std::thread::hardware_concurrency());
+        if (argc > 4)
+            options.num_threads = std::atoi(argv[4]);
+        if (argc > 5)
+            options.max_in_flight = static_cast<size_t>(std::strtoull(argv[5], nullptr, 10));
+        if (options.num_threads <= 0)
+            options.num_threads = 1;
+        return serve(argv[2], argv[3], options);
+    }
+    if (argc >= 3 && std::strcmp(argv[1], "client") == 0)
+    {
+        const size_t batch_points = argc > 3 ? static_cast<size_t>(std::strtoull(argv[3], nullptr, 10)) : 100000;
+        const int nb_batches = argc > 4 ? std::atoi(argv[4]) : 20;
+        if (batch_points == 0 || nb_batches <= 0)
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return client(argv[2], batch_points, nb_batches);
+    }
+    print_usage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <TopoDS_Shape.hxx>
+
+#include "brep_projection.h"
+#include "cgns_snapping.h"
+
+// 用法: DEMO_OCCT_SNAP [网格.cgns] [模型.igs|.stp] [输出.cgns] [选项]
+// 选项: --bc 名称（可重复）  --chunk 每块节点数  --threads 线程数  --max-distance 距离  --backend serial|omp|tbb
+int main(int argc, char **argv)
+{
+    std::string positional[3] = {"testfile/circle.cgns", "testfile/circle.iges", "circle_snapped.cgns"};
+    int nb_positional = 0;
+    SnapOptions options;
+    options.num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--bc") == 0 && has_value)
+            options.boundaries.push_back(argv[++i]);
+        else if (std::strcmp(argv[i], "--chunk") == 0 && has_value)
+            options.chunk_nodes = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (std::strcmp(argv[i], "--threads") == 0 && has_value)
+            options.num_threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--max-distance") == 0 && has_value)
+            options.max_distance = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--backend") == 0 && has_value)
+        {
+            const std::string name = argv[++i];
+            options.backend = name == "serial" ? BACKEND_SERIAL : name == "omp" ? BACKEND_OPENMP : BACKEND_TBB;
+        }
+        else if (nb_positional < 3 && argv[i][0] != '-')
+            positional[nb_positional++] = argv[i];
+        else
+        {
+            std::cerr << "未知参数: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    if (options.num_threads <= 0)
+        options.num_threads = 1;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    TopoDS_Shape shape = load_cad_shape(positional[1]);
+    if (shape.IsNull())
+        return 1;
+    BRepProjector projector(shape);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "模型: " << positional[1] << "，面 " << projector.nb_faces() << " 个，边 " << projector.nb_edges()
+              << " 个，读取与预处理耗时 " << std::chrono::duration<double>(end - start).count() << " 秒" << std::endl;
+
+    SnapStats stats;
+    start = std::chrono::high_resolution_clock::now();
+    if (!snap_cgns_mesh(positional[0], positional[2], projector, options, stats))
+        return 1;
+    end = std::chrono::high_resolution_clock::now();
+
+    std::cout << "网格: " << positional[0] << " -> " << positional[2] << "，区域 " << stats.zones << " 个" << std::endl;
+    std::cout << "边界节点: " << stats.boundary_nodes << "，已贴合 " << stats.snapped << "，超出距离未移动 "
+              << stats.rejected << "，投影失败 " << stats.failed << std::endl;
+    std::cout << "最大移动距离: " << stats.max_displacement << std::endl;
+    std::cout << "总耗时: " << std::chrono::duration<double>(end - start).count() << " 秒（读取 " << stats.read_time
+              << "，投影 " << stats.project_time << "，写回 " << stats.write_time << "，"
+              << options.num_threads << " 线程）" << std::endl;
+    return stats.failed == 0 ? 0 : 2;
+}
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <gp_Ax3.hxx>
+#include <gp_Sphere.hxx>
+#include <Geom_SphericalSurface.hxx>
+
+#include "point_stream.h"
+
+// 用法: DEMO_OCCT_STREAM <输入点文件> <结果文件> [线程数] [块大小] [--generate 点数]
+// 投影到半径50的球面；--generate 先在 [-100, 100]^3 内生成随机点写入输入文件
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "用法: " << argv[0] << " <输入点文件> <结果文件> [线程数] [块大小] [--generate 点数]" << std::endl;
+        return 1;
+    }
+    const std::string input_path = argv[1];
+    const std::string output_path = argv[2];
+    StreamOptions options;
+    options.num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    uint64_t generate = 0;
+    int positional = 0;
+    for (int i = 3; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--generate") == 0 && i + 1 < argc)
+            generate = std::strtoull(argv[++i], nullptr, 10);
+        else if (positional++ == 0)
+            options.num_threads = std::atoi(argv[i]);
+        else
+            options.chunk_size = static_cast<size_t>(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (options.num_threads <= 0)
+        options.num_threads = 1;
+
+    if (generate > 0)
+    {
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<double> dist(-100.0, 100.0);
+        const bool ok = write_point_file(input_path, generate, 1 << 20, [&](uint64_t begin, uint64_t end, double *xyz) {
+            for (uint64_t i = 0; i < 3 * (end - begin); ++i)
+                xyz[i] = dist(rng);
+        });
+        if (!ok)
+        {
+            std::cerr << "无法写入点文件: " << input_path << std::endl;
+            return 1;
+        }
+        std::cout << "已生成 " << generate << " 个点: " << input_path << std::endl;
+    }
+
+    const double sphere_radius = 50.0;
+    Handle(Geom_SphericalSurface) sphere = new Geom_SphericalSurface(gp_Sphere(gp_Ax3(gp_Pnt(0, 0, 0), gp_Dir(0, 0, 1)), sphere_radius));
+    BatchProjector projector(sphere);
+
+    StreamStats stats;
+    if (!project_stream(projector, input_path, output_path, options, stats))
+        return 1;
+    std::cout << "流式投影 " << stats.points << " 个点，" << stats.chunks << " 块，耗时 " << stats.elapsed << " 秒（"
+              << stats.points / stats.elapsed / 1e6 << " 百万点/秒）" << std::endl;
+    std::cout << "块缓冲内存: " << stats.buffer_bytes / (1024.0 * 1024.0) << " MB，失败点数: " << stats.failed << std::endl;
+
+    // 重新映射结果文件，检查投影点是否都在球面上
+    MappedFile result;
+    if (!result.open_read(output_path))
+        return 1;
+    const ResultFileHeader *header = reinterpret_cast<const ResultFileHeader *>(result.data());
+    const double *records = reinterpret_cast<const double *>(result.data() + header->record_offset);
+    const unsigned char *status = result.data() + header->status_offset;
+    uint64_t off_surface = 0;
+    for (uint64_t i = 0; i < header->count; ++i)
+    {
+        const double *r = records + 6 * i;
+        if (status[i] == PROJECTION_OK && std::abs(std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]) - sphere_radius) > 1e-6)
+            ++off_surface;
+    }
+    std::cout << "不在球面上的投影点: " << off_surface << std::endl;
+    return off_surface == 0 ? 0 : 1;
+}
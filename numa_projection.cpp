@@ -0,0 +1,364 @@
+#include "numa_projection.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/partitioner.h>
+#include <tbb/task_arena.h>
+
+namespace
+{
+#ifndef _WIN32
+    // 解析 "0-3,8,10-11" 形式的CPU列表
+    std::vector<int> parse_cpu_list(const std::string &text)
+    {
+        std::vector<int> cpus;
+        std::stringstream ss(text);
+        std::string item;
+        while (std::getline(ss, item, ','))
+        {
+            if (item.empty() || item[0] < '0' || item[0] > '9')
+                continue;
+            const size_t dash = item.find('-');
+            const int first = std::atoi(item.c_str());
+            const int last = dash == std::string::npos ? first : std::atoi(item.c_str() + dash + 1);
+            for (int c = first; c <= last; ++c)
+                cpus.push_back(c);
+        }
+        return cpus;
+    }
+
+    std::vector<int> read_cpu_list(const std::string &path)
+    {
+        std::ifstream in(path);
+        std::string text;
+        std::getline(in, text);
+        return parse_cpu_list(text);
+    }
+
+    // 超线程的第二个及以后的逻辑CPU排在后面，使每个节点的前几个分片落在不同的物理核上
+    bool is_secondary_thread(int cpu)
+    {
+        const std::vector<int> siblings =
+            read_cpu_list("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list");
+        return !siblings.empty() && *std::min_element(siblings.begin(), siblings.end()) != cpu;
+    }
+#endif
+
+    // 执行分片期间把当前线程绑定到分片的CPU/节点，析构时恢复
+    class ScopedAffinity
+    {
+    public:
+        ScopedAffinity(const NumaTopology &topology, ThreadPinning pinning, int node, int cpu)
+        {
+            if (pinning == PIN_NONE || node < 0 || node >= topology.nb_nodes())
+                return;
+            const std::vector<int> single(1, cpu);
+            const std::vector<int> &cpus = pinning == PIN_CORE && cpu >= 0 ? single : topology.node_cpus[node];
+            if (cpus.empty())
+                return;
+#ifdef _WIN32
+            // 只能绑定到一个处理器组内：取第一个CPU所在的组
+            GROUP_AFFINITY affinity = {};
+            affinity.Group = static_cast<WORD>(cpus.front() / 64);
+            for (int c : cpus)
+            {
+                if (c / 64 == affinity.Group)
+                    affinity.Mask |= KAFFINITY(1) << (c % 64);
+            }
+            active_ = SetThreadGroupAffinity(GetCurrentThread(), &affinity, &saved_) != 0;
+#else
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int c : cpus)
+            {
+                if (c < CPU_SETSIZE)
+                    CPU_SET(c, &set);
+            }
+            active_ = pthread_getaffinity_np(pthread_self(), sizeof(saved_), &saved_) == 0 &&
+                      pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+        }
+
+        ~ScopedAffinity()
+        {
+            if (!active_)
+                return;
+#ifdef _WIN32
+            SetThreadGroupAffinity(GetCurrentThread(), &saved_, nullptr);
+#else
+            pthread_setaffinity_np(pthread_self(), sizeof(saved_), &saved_);
+#endif
+        }
+
+        ScopedAffinity(const ScopedAffinity &) = delete;
+        ScopedAffinity &operator=(const ScopedAffinity &) = delete;
+
+    private:
+        bool active_ = false;
+#ifdef _WIN32
+        GROUP_AFFINITY saved_ = {};
+#else
+        cpu_set_t saved_;
+#endif
+    };
+}
+
+int NumaTopology::nb_cpus() const
+{
+    int n = 0;
+    for (const auto &cpus : node_cpus)
+        n += static_cast<int>(cpus.size());
+    return n;
+}
+
+NumaTopology NumaTopology::detect()
+{
+    NumaTopology topology;
+#ifdef _WIN32
+    ULONG highest = 0;
+    if (GetNumaHighestNodeNumber(&highest))
+    {
+        for (ULONG node = 0; node <= highest; ++node)
+        {
+            GROUP_AFFINITY affinity = {};
+            if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &affinity) || affinity.Mask == 0)
+                continue;
+            std::vector<int> cpus;
+            for (int bit = 0; bit < 64; ++bit)
+            {
+                if (affinity.Mask & (KAFFINITY(1) << bit))
+                    cpus.push_back(affinity.Group * 64 + bit);
+            }
+            topology.node_cpus.push_back(cpus);
+        }
+    }
+#else
+    cpu_set_t allowed;
+    const bool has_allowed = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+    std::vector<std::pair<int, std::vector<int>>> nodes;
+    if (DIR *dir = opendir("/sys/devices/system/node"))
+    {
+        while (dirent *entry = readdir(dir))
+        {
+            const std::string name = entry->d_name;
+            if (name.compare(0, 4, "node") != 0 || name.size() == 4 || name[4] < '0' || name[4] > '9')
+                continue;
+            std::vector<int> cpus;
+            for (int c : read_cpu_list("/sys/devices/system/node/" + name + "/cpulist"))
+            {
+                if (!has_allowed || (c < CPU_SETSIZE && CPU_ISSET(c, &allowed)))
+                    cpus.push_back(c);
+            }
+            if (!cpus.empty()) // 跳过只有内存没有CPU的节点
+                nodes.emplace_back(std::atoi(name.c_str() + 4), cpus);
+        }
+        closedir(dir);
+    }
+    std::sort(nodes.begin(), nodes.end());
+    for (const auto &node : nodes)
+    {
+        std::vector<std::pair<bool, int>> order;
+        for (int c : node.second)
+            order.emplace_back(is_secondary_thread(c), c);
+        std::sort(order.begin(), order.end());
+        std::vector<int> cpus;
+        for (const auto &entry : order)
+            cpus.push_back(entry.second);
+        topology.node_cpus.push_back(cpus);
+    }
+#endif
+    if (topology.node_cpus.empty())
+    {
+        const int hw = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        topology.node_cpus.resize(1);
+        for (int c = 0; c < hw; ++c)
+            topology.node_cpus[0].push_back(c);
+    }
+    return topology;
+}
+
+NumaExecutor::NumaExecutor(const NumaTopology &topology, int num_threads, ThreadPinning pinning, ProjectionBackend backend)
+    : topology_(topology), num_threads_(backend == BACKEND_SERIAL ? 1 : std::max(num_threads, 1)),
+      pinning_(pinning), backend_(backend)
+{
+    if (topology_.node_cpus.empty())
+        topology_ = NumaTopology::detect();
+
+    // 分片数按节点CPU数比例分配（最大余数法），节点内依次取CPU
+    const int nodes = topology_.nb_nodes();
+    const int total = std::max(topology_.nb_cpus(), 1);
+    std::vector<int> share(nodes);
+    std::vector<std::pair<double, int>> remainders;
+    int assigned = 0;
+    for (int k = 0; k < nodes; ++k)
+    {
+        const double exact = static_cast<double>(num_threads_) * topology_.node_cpus[k].size() / total;
+        share[k] = static_cast<int>(exact);
+        assigned += share[k];
+        remainders.emplace_back(share[k] - exact, k); // 余数越大越靠前
+    }
+    std::sort(remainders.begin(), remainders.end());
+    for (int k = 0; assigned < num_threads_; k = (k + 1) % nodes, ++assigned)
+        ++share[remainders[k].second];
+
+    for (int k = 0; k < nodes; ++k)
+    {
+        const std::vector<int> &cpus = topology_.node_cpus[k];
+        for (int j = 0; j < share[k]; ++j)
+        {
+            thread_node_.push_back(k);
+            thread_cpu_.push_back(cpus[j % cpus.size()]);
+        }
+    }
+}
+
+std::vector<NumaPlacement> NumaExecutor::plan(size_t count) const
+{
+    std::vector<NumaPlacement> parts(num_threads_);
+    for (int t = 0; t < num_threads_; ++t)
+    {
+        parts[t].node = thread_node_[t];
+        parts[t].cpu = thread_cpu_[t];
+        parts[t].begin = count * t / num_threads_;
+        parts[t].end = count * (t + 1) / num_threads_;
+    }
+    return parts;
+}
+
+void NumaExecutor::run(size_t count, const std::function<void(int, const NumaPlacement &)> &body,
+                       std::vector<double> *thread_times) const
+{
+    const std::vector<NumaPlacement> parts = plan(count);
+    std::vector<double> times(num_threads_, 0.0);
+    auto task = [&](int t) {
+        ScopedAffinity affinity(topology_, pinning_, parts[t].node, parts[t].cpu);
+        const auto start = std::chrono::steady_clock::now();
+        body(t, parts[t]);
+        times[t] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    switch (backend_)
+    {
+    case BACKEND_OPENMP:
+#ifdef _OPENMP
+        // schedule(static, 1)：第t个分片固定由第t个OpenMP线程执行
+#pragma omp parallel for schedule(static, 1) num_threads(num_threads_)
+        for (int t = 0; t < num_threads_; ++t)
+            task(t);
+        break;
+#endif
+        // 未启用OpenMP时退回TBB
+    case BACKEND_TBB:
+    {
+        // simple_partitioner + 粒度1：每个分片单独成为一个任务
+        tbb::task_arena arena(num_threads_);
+        arena.execute([&] {
+            tbb::parallel_for(tbb::blocked_range<int>(0, num_threads_, 1), [&](const tbb::blocked_range<int> &r) {
+                for (int t = r.begin(); t != r.end(); ++t)
+                    task(t);
+            }, tbb::simple_partitioner());
+        });
+        break;
+    }
+    default:
+        for (int t = 0; t < num_threads_; ++t)
+            task(t);
+        break;
+    }
+
+    if (thread_times)
+        thread_times->swap(times);
+}
+
+std::vector<double> NumaExecutor::node_throughput(size_t count, const std::vector<double> &thread_times) const
+{
+    const std::vector<NumaPlacement> parts = plan(count);
+    std::vector<double> points(topology_.nb_nodes(), 0.0), slowest(topology_.nb_nodes(), 0.0);
+    for (size_t t = 0; t < parts.size() && t < thread_times.size(); ++t)
+    {
+        points[parts[t].node] += static_cast<double>(parts[t].end - parts[t].begin);
+        slowest[parts[t].node] = std::max(slowest[parts[t].node], thread_times[t]);
+    }
+    std::vector<double> throughput(points.size(), 0.0);
+    for (size_t k = 0; k < points.size(); ++k)
+        throughput[k] = slowest[k] > 0.0 ? points[k] / slowest[k] : 0.0;
+    return throughput;
+}
+
+void NumaBatchBuffers::allocate(size_t count)
+{
+    // new T[n] 对基本类型不做初始化，大块内存的物理页要到首次写入时才分配
+    count_ = count;
+    x_.reset(new double[count]), y_.reset(new double[count]), z_.reset(new double[count]);
+    px_.reset(new double[count]), py_.reset(new double[count]), pz_.reset(new double[count]);
+    u_.reset(new double[count]), v_.reset(new double[count]), distance_.reset(new double[count]);
+    status_.reset(new unsigned char[count]);
+}
+
+void NumaBatchBuffers::first_touch(const NumaExecutor &executor, const PointBatch &source)
+{
+    executor.run(count_, [&](int, const NumaPlacement &part) {
+        std::copy(source.x + part.begin, source.x + part.end, x_.get() + part.begin);
+        std::copy(source.y + part.begin, source.y + part.end, y_.get() + part.begin);
+        std::copy(source.z + part.begin, source.z + part.end, z_.get() + part.begin);
+        double *outputs[6] = {px_.get(), py_.get(), pz_.get(), u_.get(), v_.get(), distance_.get()};
+        for (double *out : outputs)
+            std::fill(out + part.begin, out + part.end, 0.0);
+        std::fill(status_.get() + part.begin, status_.get() + part.end, static_cast<unsigned char>(PROJECTION_NOT_DONE));
+    });
+}
+
+PointBatch NumaBatchBuffers::input() const
+{
+    PointBatch b;
+    b.x = x_.get();
+    b.y = y_.get();
+    b.z = z_.get();
+    b.count = count_;
+    return b;
+}
+
+ProjectionBuffers NumaBatchBuffers::output() const
+{
+    ProjectionBuffers b;
+    b.x = px_.get();
+    b.y = py_.get();
+    b.z = pz_.get();
+    b.u = u_.get();
+    b.v = v_.get();
+    b.distance = distance_.get();
+    b.status = status_.get();
+    return b;
+}
+
+void project_batch_numa(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output,
+                        const NumaExecutor &executor, std::vector<double> *thread_times)
+{
+    executor.run(input.count, [&](int, const NumaPlacement &part) {
+        ProjectionWorkspace workspace; // 绑定后构造，工作区内存也在本节点
+        projector.project_range(input, output, part.begin, part.end, workspace);
+    }, thread_times);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "batch_projection.h"
+
+// NUMA拓扑：每个节点的逻辑CPU编号（只包含当前进程允许使用的CPU）
+// Windows 上CPU编号为 处理器组 * 64 + 组内编号
+struct NumaTopology
+{
+    std::vector<std::vector<int>> node_cpus;
+
+    int nb_nodes() const { return static_cast<int>(node_cpus.size()); }
+    int nb_cpus() const;
+
+    // Linux 读 /sys/devices/system/node，Windows 用 GetNumaNodeProcessorMaskEx；
+    // 无法识别时退化为一个包含全部硬件线程的节点
+    static NumaTopology detect();
+};
+
+// 线程绑定方式
+enum ThreadPinning
+{
+    PIN_NONE = 0, // 不绑定（对照组，首次触碰落在哪个节点取决于调度）
+    PIN_CORE,     // 每个分片绑定到一个逻辑CPU
+    PIN_SOCKET    // 每个分片绑定到所在节点的全部CPU
+};
+
+// 一个静态分片：所在节点、绑定的CPU、处理的下标区间
+struct NumaPlacement
+{
+    int node = 0;
+    int cpu = -1;
+    size_t begin = 0, end = 0;
+};
+
+// NUMA感知执行器：
+// - 分片按节点连续分组（各节点的分片数按CPU数比例分配），下标区间静态等分，
+//   同一节点的分片处理相邻区间，因此每个节点的数据是连续的一段
+// - 执行分片的任务先把当前线程绑定到分片的CPU/节点，结束后恢复原来的亲和性；
+//   绑定跟着分片走，无论线程池中哪个线程领到分片，首次触碰和投影都在同一节点上
+class NumaExecutor
+{
+public:
+    NumaExecutor(const NumaTopology &topology, int num_threads, ThreadPinning pinning, ProjectionBackend backend);
+
+    int num_threads() const { return num_threads_; }
+    ThreadPinning pinning() const { return pinning_; }
+    const NumaTopology &topology() const { return topology_; }
+
+    // count 个点的静态划分，共 num_threads() 个分片
+    std::vector<NumaPlacement> plan(size_t count) const;
+
+    // 每个分片执行一次 body(分片序号, 分片)；thread_times 非空时返回各分片耗时（秒）
+    void run(size_t count, const std::function<void(int, const NumaPlacement &)> &body,
+             std::vector<double> *thread_times = nullptr) const;
+
+    // 各节点吞吐量（点/秒）：节点的点数 / 该节点最慢分片的耗时
+    std::vector<double> node_throughput(size_t count, const std::vector<double> &thread_times) const;
+
+private:
+    NumaTopology topology_;
+    int num_threads_;
+    ThreadPinning pinning_;
+    ProjectionBackend backend_;
+    std::vector<int> thread_node_, thread_cpu_;
+};
+
+// 只分配不初始化的SoA输入输出缓冲，由执行器按分片首次触碰，
+// 使每段数据的物理页落在处理它的线程所在的节点（操作系统默认的首次触碰策略）
+class NumaBatchBuffers
+{
+public:
+    void allocate(size_t count);
+    // 并行拷贝输入并清零输出，分片与 executor.plan(size()) 一致
+    void first_touch(const NumaExecutor &executor, const PointBatch &source);
+
+    size_t size() const { return count_; }
+    PointBatch input() const;
+    ProjectionBuffers output() const;
+
+private:
+    size_t count_ = 0;
+    std::unique_ptr<double[]> x_, y_, z_;
+    std::unique_ptr<double[]> px_, py_, pz_, u_, v_, distance_;
+    std::unique_ptr<unsigned char[]> status_;
+};
+
+// NUMA感知批量投影：每个分片在绑定后构造自己的工作区，投影其静态区间
+void project_batch_numa(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output,
+                        const NumaExecutor &executor, std::vector<double> *thread_times = nullptr);
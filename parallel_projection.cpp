@@ -2,20 +2,37 @@
 #include <vector>
 #include <random>
 #include <chrono>
+#include <cstdlib>
+#include <thread>
 #include <gp_Sphere.hxx>
 #include <Geom_SphericalSurface.hxx>
 #include <GeomAPI_ProjectPointOnSurf.hxx>
 #include <gp_Pnt.hxx>
 
+#include <GeomConvert.hxx>
+#include <Geom_BSplineSurface.hxx>
+#include <Geom_Circle.hxx>
+#include <Geom_BSplineCurve.hxx>
+
+#include "batch_projection.h"
+#include "coherent_projection.h"
+#include "seed_cache.h"
+#include "incremental_projection.h"
+#include "schedule_tuner.h"
+#include "curve_projection.h"
+#include "projection_profiler.h"
+#include "simd_kernels.h"
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
 #include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
 #include <tbb/task_arena.h>
 #include <tbb/enumerable_thread_specific.h>
 
-// ɲϵά
+// 随机生成不在球面上的三维点
 void generate_random_points(std::vector<gp_Pnt> &points, int num_points, double min, double max, double sphere_radius)
 {
     std::mt19937 rng(42);
@@ -28,35 +45,52 @@ void generate_random_points(std::vector<gp_Pnt> &points, int num_points, double
             x = dist(rng);
             y = dist(rng);
             z = dist(rng);
-        } while (std::sqrt(x * x + y * y + z * z) < sphere_radius * 0.95); // ֤㲻
+        } while (std::sqrt(x * x + y * y + z * z) < sphere_radius * 0.95); // 保证点不在球面上
         points.emplace_back(x, y, z);
     }
 }
 
-// ͶӰÿֻһprojectorЧʸߣ
+// 用给定的 projector 投影单点（插桩时分别计时 Init 和结果提取）
+inline void project_point_profiled(GeomAPI_ProjectPointOnSurf &projector, const gp_Pnt &point, const Handle(Geom_SphericalSurface) & sphere, gp_Pnt &projected)
+{
+    {
+        PROJ_PROFILE_PHASE(PROFILE_INIT);
+        projector.Init(point, sphere);
+    }
+#ifdef PROJECTION_PROFILE
+    if (projector.NbPoints() == 0)
+        PROJ_PROFILE_FAILURE();
+#endif
+    PROJ_PROFILE_PHASE(PROFILE_EXTRACT);
+    projected = projector.NearestPoint();
+}
+
+// 串行投影（每次只构造一次projector，效率高）
 void project_points_serial_fast(const std::vector<gp_Pnt> &points, std::vector<gp_Pnt> &projected, const Handle(Geom_SphericalSurface) & sphere)
 {
-    GeomAPI_ProjectPointOnSurf projector; // ֻһ projectorٹ/Ч
+    GeomAPI_ProjectPointOnSurf projector; // 只构造一次 projector，减少构造/析构开销，提高效率
+    PROJ_PROFILE_CHUNK();
+    PROJ_PROFILE_POINTS(points.size());
     for (size_t i = 0; i < points.size(); ++i)
     {
-        projector.Init(points[i], sphere);
-        projected[i] = projector.NearestPoint();
+        project_point_profiled(projector, points[i], sphere, projected[i]);
     }
 }
 
-// OpenMPͶӰÿֻ߳һprojectorЧʸߣ
+// OpenMP并行投影（每线程只构造一次projector，效率高）
 void project_points_omp_fast(const std::vector<gp_Pnt> &points, std::vector<gp_Pnt> &projected, const Handle(Geom_SphericalSurface) & sphere, int num_threads)
 {
 #ifdef _OPENMP
     omp_set_num_threads(num_threads);
 #pragma omp parallel
     {
-        GeomAPI_ProjectPointOnSurf projector; // ÿֻ߳һ projectorٹ/Ч
-#pragma omp for
+        GeomAPI_ProjectPointOnSurf projector; // 每个线程只构造一次 projector，减少构造/析构开销，提高效率
+        PROJ_PROFILE_CHUNK(); // 静态调度下每个线程的整段分片即一个块；nowait 使隐式栅栏的等待计入空闲
+#pragma omp for nowait
         for (int i = 0; i < static_cast<int>(points.size()); ++i)
         {
-            projector.Init(points[i], sphere);
-            projected[i] = projector.NearestPoint();
+            PROJ_PROFILE_POINTS(1);
+            project_point_profiled(projector, points[i], sphere, projected[i]);
         }
     }
 #else
@@ -64,20 +98,23 @@ void project_points_omp_fast(const std::vector<gp_Pnt> &points, std::vector<gp_P
 #endif
 }
 
-// TBBͶӰÿֻ߳һprojectorЧʸߣ
+// TBB并行投影（每线程只构造一次projector，效率高）
 void project_points_tbb_fast(const std::vector<gp_Pnt> &points, std::vector<gp_Pnt> &projected, const Handle(Geom_SphericalSurface) & sphere, int num_threads)
 {
     tbb::enumerable_thread_specific<GeomAPI_ProjectPointOnSurf> ets_projector;
     tbb::task_arena arena(num_threads);
+    // 用 blocked_range 形式（划分方式与逐下标重载相同），以便按TBB实际分出的块插桩
     arena.execute([&]
-                  { tbb::parallel_for(size_t(0), points.size(), [&](size_t i)
+                  { tbb::parallel_for(tbb::blocked_range<size_t>(0, points.size()), [&](const tbb::blocked_range<size_t> &r)
                                       {
-            auto& projector = ets_projector.local(); // ÿֻ߳һ projectorٹ/Ч
-            projector.Init(points[i], sphere);
-            projected[i] = projector.NearestPoint(); }); });
+            auto& projector = ets_projector.local(); // 每个线程只构造一次 projector，减少构造/析构开销，提高效率
+            PROJ_PROFILE_CHUNK();
+            PROJ_PROFILE_POINTS(r.size());
+            for (size_t i = r.begin(); i != r.end(); ++i)
+                project_point_profiled(projector, points[i], sphere, projected[i]); }); });
 }
 
-// ͶӰÿζµprojectorЧʵͣԱȣ
+// 串行投影（每次都构造新的projector，效率低，仅作对比）
 void project_points_serial(const std::vector<gp_Pnt> &points, std::vector<gp_Pnt> &projected, const Handle(Geom_SphericalSurface) & sphere)
 {
     for (size_t i = 0; i < points.size(); ++i)
@@ -87,7 +124,7 @@ void project_points_serial(const std::vector<gp_Pnt> &points, std::vector<gp_Pnt
     }
 }
 
-// OpenMPͶӰÿζµprojectorЧʵͣԱȣ
+// OpenMP并行投影（每次都构造新的projector，效率低，仅作对比）
 void project_points_omp(const std::vector<gp_Pnt> &points, std::vector<gp_Pnt> &projected, const Handle(Geom_SphericalSurface) & sphere, int num_threads)
 {
 #ifdef _OPENMP
@@ -103,7 +140,7 @@ void project_points_omp(const std::vector<gp_Pnt> &points, std::vector<gp_Pnt> &
 #endif
 }
 
-// TBBͶӰÿζµprojectorЧʵͣԱȣ
+// TBB并行投影（每次都构造新的projector，效率低，仅作对比）
 void project_points_tbb(const std::vector<gp_Pnt> &points, 
                         std::vector<gp_Pnt> &projected, 
                         const Handle(Geom_SphericalSurface) & sphere, 
@@ -118,49 +155,112 @@ void project_points_tbb(const std::vector<gp_Pnt> &points,
     });
 }
 
-int main()
+// 统计不在球面上的投影点数（SoA结果，投影失败的点也计入）
+int count_not_on_sphere(const ProjectionResultArrays &projected, double sphere_radius)
+{
+    int not_on_sphere = 0;
+    for (size_t i = 0; i < projected.size(); ++i)
+    {
+        double dist = std::sqrt(projected.x[i] * projected.x[i] + projected.y[i] * projected.y[i] + projected.z[i] * projected.z[i]);
+        if (projected.status[i] != PROJECTION_OK || std::abs(dist - sphere_radius) > 1e-8)
+            ++not_on_sphere;
+    }
+    return not_on_sphere;
+}
+
+// 统计与参考结果不一致的点数
+int count_mismatch(const std::vector<gp_Pnt> &reference, const ProjectionResultArrays &projected)
+{
+    int mismatch = 0;
+    for (size_t i = 0; i < reference.size(); ++i)
+    {
+        if (reference[i].Distance(projected.point(i)) > 1e-8)
+            ++mismatch;
+    }
+    return mismatch;
+}
+
+int main(int argc, char **argv)
 {
-    int num_points = 8000000; // ɵ
-    int num_threads = 12;     // ߳ɵ
+    int num_points = 8000000; // 点的数量，可调整
+    int num_threads = argc > 1 ? std::atoi(argv[1]) : static_cast<int>(std::thread::hardware_concurrency()); // 线程数，默认取全部硬件线程
+    if (num_threads < 1)
+        num_threads = 1;
     
-    // 
+    // 创建球面
     double sphere_radius = 50.0;
     gp_Ax3 axis(gp_Pnt(0, 0, 0), gp_Dir(0, 0, 1));
     gp_Sphere sphere(axis, sphere_radius);
     Handle(Geom_SphericalSurface) geomSphere = new Geom_SphericalSurface(sphere);
 
-    // 
+    // 生成随机点
     std::vector<gp_Pnt> points;
     points.reserve(num_points);
     generate_random_points(points, num_points, -100.0, 100.0, sphere_radius);
 
-    // 洢
+    // 结果存储
     std::vector<gp_Pnt> projected_tbb(num_points);
     std::vector<gp_Pnt> projected_omp(num_points);
     std::vector<gp_Pnt> projected_serial(num_points);
 
-    // ͶӰ
+    // 串行投影
     auto t1 = std::chrono::high_resolution_clock::now();
+    PROJ_PROFILE_SESSION_BEGIN("serial GeomAPI", 1);
     project_points_serial_fast(points, projected_serial, geomSphere);
+    PROJ_PROFILE_SESSION_END();
     auto t2 = std::chrono::high_resolution_clock::now();
+    PROJ_PROFILE_REPORT(std::cout);
     double serial_time = std::chrono::duration<double>(t2 - t1).count();
-    std::cout << "ͶӰʱ: " << serial_time << " " << std::endl;
+    std::cout << "串行投影耗时: " << serial_time << " 秒" << std::endl;
 
-    // TBBͶӰ
+    // TBB并行投影
     t1 = std::chrono::high_resolution_clock::now();
+    PROJ_PROFILE_SESSION_BEGIN("TBB GeomAPI", num_threads);
     project_points_tbb_fast(points, projected_tbb, geomSphere, num_threads);
+    PROJ_PROFILE_SESSION_END();
     t2 = std::chrono::high_resolution_clock::now();
+    PROJ_PROFILE_REPORT(std::cout);
     double tbb_time = std::chrono::duration<double>(t2 - t1).count();
-    std::cout << "TBBͶӰʱ: " << tbb_time << " " << std::endl;
+    std::cout << "TBB并行投影耗时: " << tbb_time << " 秒" << std::endl;
 
-    // OpenMPͶӰ
+    // OpenMP并行投影
     t1 = std::chrono::high_resolution_clock::now();
+    PROJ_PROFILE_SESSION_BEGIN("OpenMP GeomAPI", num_threads);
     project_points_omp_fast(points, projected_omp, geomSphere, num_threads);
+    PROJ_PROFILE_SESSION_END();
     t2 = std::chrono::high_resolution_clock::now();
+    PROJ_PROFILE_REPORT(std::cout);
     double omp_time = std::chrono::duration<double>(t2 - t1).count();
-    std::cout << "OpenMPͶӰʱ: " << omp_time << " " << std::endl;
+    std::cout << "OpenMP并行投影耗时: " << omp_time << " 秒" << std::endl;
 
-    // TBBͶӰǷϣĽʽ
+    // 批量投影（SoA输入输出，球面走闭式内核，结果与通用投影逐点比对）
+    PointArrays points_soa;
+    points_soa.reserve(num_points);
+    for (const auto &pt : points)
+        points_soa.push_back(pt);
+    BatchProjector batch_projector(geomSphere);
+    ProjectionResultArrays projected_batch;
+    projected_batch.resize(num_points);
+    int analytic_not_on_sphere[3], analytic_mismatch[3];
+    double analytic_times[3];
+    const ProjectionBackend analytic_backends[3] = {BACKEND_SERIAL, BACKEND_TBB, BACKEND_OPENMP};
+    const char *analytic_names[3] = {"闭式串行", "闭式TBB", "闭式OpenMP"};
+    for (int k = 0; k < 3; ++k)
+    {
+        t1 = std::chrono::high_resolution_clock::now();
+        PROJ_PROFILE_SESSION_BEGIN(k == 0 ? "serial analytic" : k == 1 ? "TBB analytic" : "OpenMP analytic", k == 0 ? 1 : num_threads);
+        project_batch(batch_projector, points_soa.batch(), projected_batch.buffers(), analytic_backends[k], num_threads);
+        PROJ_PROFILE_SESSION_END();
+        t2 = std::chrono::high_resolution_clock::now();
+        PROJ_PROFILE_REPORT(std::cout);
+        analytic_times[k] = std::chrono::duration<double>(t2 - t1).count();
+        std::cout << analytic_names[k] << "投影耗时: " << analytic_times[k] << " 秒" << std::endl;
+        analytic_not_on_sphere[k] = count_not_on_sphere(projected_batch, sphere_radius);
+        analytic_mismatch[k] = count_mismatch(projected_serial, projected_batch);
+    }
+    const double analytic_serial_time = analytic_times[0];
+
+    // 检查TBB投影点是否在球面上（根据球的解析表达式）
     int tbb_not_on_sphere = 0;
     for (const auto &pt : projected_tbb)
     {
@@ -170,9 +270,9 @@ int main()
             ++tbb_not_on_sphere;
         }
     }
-    std::cout << "TBBͶӰ㲻ϵ: " << tbb_not_on_sphere << std::endl;
+    std::cout << "TBB投影点不在球面上的数量: " << tbb_not_on_sphere << std::endl;
 
-    // OpenMPͶӰǷ
+    // 检查OpenMP投影点是否在球面上
     int omp_not_on_sphere = 0;
     for (const auto &pt : projected_omp)
     {
@@ -182,9 +282,9 @@ int main()
             ++omp_not_on_sphere;
         }
     }
-    std::cout << "OpenMPͶӰ㲻ϵ: " << omp_not_on_sphere << std::endl;
+    std::cout << "OpenMP投影点不在球面上的数量: " << omp_not_on_sphere << std::endl;
 
-    // ֤ͶӰ봮ͶӰһ
+    // 验证并行投影与串行投影结果一致性
     int mismatch_tbb = 0, mismatch_omp = 0;
     for (int i = 0; i < num_points; ++i)
     {
@@ -193,20 +293,26 @@ int main()
         if (projected_serial[i].Distance(projected_omp[i]) > 1e-8)
             ++mismatch_omp;
     }
-    std::cout << "TBBͶӰһµ: " << mismatch_tbb << std::endl;
-    std::cout << "OpenMPͶӰһµ: " << mismatch_omp << std::endl;
+    std::cout << "串行与TBB投影结果不一致点数: " << mismatch_tbb << std::endl;
+    std::cout << "串行与OpenMP投影结果不一致点数: " << mismatch_omp << std::endl;
+
+    for (int k = 0; k < 3; ++k)
+    {
+        std::cout << analytic_names[k] << "投影点不在球面上的数量: " << analytic_not_on_sphere[k] << std::endl;
+        std::cout << "串行与" << analytic_names[k] << "投影结果不一致点数: " << analytic_mismatch[k] << std::endl;
+    }
 
-    // ٱȺͲЧ
+    // 计算加速比和并行效率
     double tbb_speedup = serial_time / tbb_time;
     double omp_speedup = serial_time / omp_time;
     double tbb_efficiency = tbb_speedup / num_threads * 100.0;
     double omp_efficiency = omp_speedup / num_threads * 100.0;
     
-    // ܶԱȱ
-    std::cout << "\n=================== ͶӰܶԱ ==============" << std::endl;
-    std::cout << "ʽ      | ߳ |   ʱ(s) |  ٱ | Ч(%)" << std::endl;
+    // 输出性能对比表格
+    std::cout << "\n=================== 并行投影性能对比 ==============" << std::endl;
+    std::cout << "方式      | 线程数 |   耗时(s) |  加速比 | 并行效率(%)" << std::endl;
     std::cout << "----------------------------------------------------" << std::endl;
-    std::cout << "    | "
+    std::cout << "串行    | "
               << std::setw(6) << 1 << " | "
               << std::fixed << std::setprecision(3) << std::setw(8) << serial_time << " | "
               << std::fixed << std::setprecision(2) << std::setw(7) << 1.0 << " | "
@@ -221,7 +327,238 @@ int main()
               << std::fixed << std::setprecision(3) << std::setw(8) << omp_time << " | "
               << std::fixed << std::setprecision(2) << std::setw(7) << omp_speedup << " | "
               << std::setw(10) << std::fixed << std::setprecision(2) << omp_efficiency << std::endl;
+    // 闭式投影：加速比相对通用串行投影，并行效率相对闭式串行投影
+    const char *analytic_rows[3] = {"闭式串行", "闭式TBB ", "闭式OMP "};
+    for (int k = 0; k < 3; ++k)
+    {
+        int threads = k == 0 ? 1 : num_threads;
+        double speedup = serial_time / analytic_times[k];
+        double efficiency = analytic_serial_time / analytic_times[k] / threads * 100.0;
+        std::cout << analytic_rows[k] << "| "
+                  << std::setw(6) << threads << " | "
+                  << std::fixed << std::setprecision(3) << std::setw(8) << analytic_times[k] << " | "
+                  << std::fixed << std::setprecision(2) << std::setw(7) << speedup << " | "
+                  << std::setw(10) << std::fixed << std::setprecision(2) << efficiency << std::endl;
+    }
     std::cout << "====================================================" << std::endl;
 
+    // NURBS球面：OCCT逐点求解 vs 预处理曲面（共享采样网格+Newton） vs Morton排序+邻点UV热启动
+    // 取前一部分点，OCCT通用求解较慢
+    const int nurbs_points = std::min(num_points, 200000);
+    Handle(Geom_BSplineSurface) nurbsSphere = GeomConvert::SurfaceToBSplineSurface(geomSphere);
+    t1 = std::chrono::high_resolution_clock::now();
+    BatchProjector nurbs_projector(nurbsSphere); // 构建一次 PreparedSurface，所有线程共享
+    t2 = std::chrono::high_resolution_clock::now();
+    double nurbs_prepare_time = std::chrono::duration<double>(t2 - t1).count();
+    BatchProjector nurbs_occt_projector(nurbsSphere, false);
+    BatchProjector nurbs_mixed_projector(nurbsSphere, true, PRECISION_MIXED); // 单精度SIMD种子搜索 + 双精度Newton
+    const PointBatch nurbs_input = points_soa.batch(0, nurbs_points);
+    ProjectionResultArrays nurbs_occt, nurbs_prepared, nurbs_warm, nurbs_mixed;
+    nurbs_occt.resize(nurbs_points);
+    nurbs_mixed.resize(nurbs_points);
+    nurbs_prepared.resize(nurbs_points);
+    nurbs_warm.resize(nurbs_points);
+
+    t1 = std::chrono::high_resolution_clock::now();
+    PROJ_PROFILE_SESSION_BEGIN("TBB NURBS GeomAPI", num_threads);
+    project_batch(nurbs_occt_projector, nurbs_input, nurbs_occt.buffers(), BACKEND_TBB, num_threads);
+    PROJ_PROFILE_SESSION_END();
+    t2 = std::chrono::high_resolution_clock::now();
+    PROJ_PROFILE_REPORT(std::cout);
+    double nurbs_occt_time = std::chrono::duration<double>(t2 - t1).count();
+
+    t1 = std::chrono::high_resolution_clock::now();
+    PROJ_PROFILE_SESSION_BEGIN("TBB NURBS prepared", num_threads);
+    project_batch(nurbs_projector, nurbs_input, nurbs_prepared.buffers(), BACKEND_TBB, num_threads);
+    PROJ_PROFILE_SESSION_END();
+    t2 = std::chrono::high_resolution_clock::now();
+    PROJ_PROFILE_REPORT(std::cout);
+    double nurbs_prepared_time = std::chrono::duration<double>(t2 - t1).count();
+
+    t1 = std::chrono::high_resolution_clock::now();
+    project_batch(nurbs_mixed_projector, nurbs_input, nurbs_mixed.buffers(), BACKEND_TBB, num_threads);
+    t2 = std::chrono::high_resolution_clock::now();
+    double nurbs_mixed_time = std::chrono::duration<double>(t2 - t1).count();
+
+    t1 = std::chrono::high_resolution_clock::now();
+    WarmStartStats warm_stats = project_batch_coherent(nurbs_projector, nurbs_input, nurbs_warm.buffers(), BACKEND_TBB, num_threads);
+    t2 = std::chrono::high_resolution_clock::now();
+    double nurbs_warm_time = std::chrono::duration<double>(t2 - t1).count();
+
+    int prepared_mismatch = 0, warm_mismatch = 0, mixed_mismatch = 0;
+    for (int i = 0; i < nurbs_points; ++i)
+    {
+        if (nurbs_prepared.status[i] != nurbs_occt.status[i] || nurbs_occt.point(i).Distance(nurbs_prepared.point(i)) > 1e-8)
+            ++prepared_mismatch;
+        if (nurbs_warm.status[i] != nurbs_occt.status[i] || nurbs_occt.point(i).Distance(nurbs_warm.point(i)) > 1e-8)
+            ++warm_mismatch;
+        if (nurbs_mixed.status[i] != nurbs_occt.status[i] || nurbs_occt.point(i).Distance(nurbs_mixed.point(i)) > 1e-8)
+            ++mixed_mismatch;
+    }
+    const PreparedSurface *prepared = nurbs_projector.prepared();
+    std::cout << "\nNURBS球面投影（" << nurbs_points << " 点，TBB " << num_threads << " 线程）" << std::endl;
+    if (prepared)
+        std::cout << "预处理曲面: " << prepared->nb_u_samples() << " x " << prepared->nb_v_samples() << " 采样, "
+                  << prepared->nb_patches() << " 个补丁, 求值器 " << surface_evaluator_name(prepared->evaluator_kind())
+                  << ", 构建耗时 " << nurbs_prepare_time << " 秒" << std::endl;
+    std::cout << "OCCT逐点求解耗时: " << nurbs_occt_time << " 秒" << std::endl;
+    std::cout << "预处理曲面求解耗时: " << nurbs_prepared_time << " 秒，加速比 " << nurbs_occt_time / nurbs_prepared_time
+              << "，不一致点数 " << prepared_mismatch << std::endl;
+    std::cout << "混合精度求解耗时（" << simd_level_name(simd_level()) << "）: " << nurbs_mixed_time << " 秒，加速比 "
+              << nurbs_occt_time / nurbs_mixed_time << "，不一致点数 " << mixed_mismatch
+              << "，不在球面上的点数 " << count_not_on_sphere(nurbs_mixed, sphere_radius) << std::endl;
+    std::cout << "热启动求解耗时: " << nurbs_warm_time << " 秒，加速比 " << nurbs_occt_time / nurbs_warm_time
+              << "，不一致点数 " << warm_mismatch << std::endl;
+    std::cout << "热启动接受/全局求解/失败点数: " << warm_stats.warm_accepted << " / "
+              << warm_stats.global_solved << " / " << warm_stats.failed << std::endl;
+
+    // 种子缓存：构建一次并存盘，重新加载后模拟下一轮迭代的投影
+    SeedCache seed_cache, loaded_cache;
+    t1 = std::chrono::high_resolution_clock::now();
+    seed_cache.build(nurbs_projector, num_threads);
+    t2 = std::chrono::high_resolution_clock::now();
+    const double cache_build_time = std::chrono::duration<double>(t2 - t1).count();
+    const std::string cache_path = "nurbs_sphere.seedcache";
+    t1 = std::chrono::high_resolution_clock::now();
+    const bool cache_loaded = seed_cache.save(cache_path) && loaded_cache.load(cache_path, nurbs_projector);
+    t2 = std::chrono::high_resolution_clock::now();
+    const double cache_io_time = std::chrono::duration<double>(t2 - t1).count();
+    ProjectionResultArrays nurbs_cached;
+    nurbs_cached.resize(nurbs_points);
+    t1 = std::chrono::high_resolution_clock::now();
+    SeedCacheStats cache_stats = project_batch_cached(cache_loaded ? loaded_cache : seed_cache, nurbs_projector, nurbs_input,
+                                                      nurbs_cached.buffers(), BACKEND_TBB, num_threads);
+    t2 = std::chrono::high_resolution_clock::now();
+    const double nurbs_cached_time = std::chrono::duration<double>(t2 - t1).count();
+    int cached_mismatch = 0;
+    for (int i = 0; i < nurbs_points; ++i)
+    {
+        if (nurbs_cached.status[i] != nurbs_occt.status[i] || nurbs_occt.point(i).Distance(nurbs_cached.point(i)) > 1e-8)
+            ++cached_mismatch;
+    }
+    std::cout << "种子缓存: " << seed_cache.nb_cells() << " 个单元（叶单元 " << seed_cache.nb_leaves() << "），构建耗时 "
+              << cache_build_time << " 秒，存盘+加载耗时 " << cache_io_time << " 秒" << (cache_loaded ? "" : "（加载失败）") << std::endl;
+    std::cout << "缓存求解耗时: " << nurbs_cached_time << " 秒，加速比 " << nurbs_occt_time / nurbs_cached_time
+              << "，不一致点数 " << cached_mismatch << std::endl;
+    std::cout << "缓存命中/拒绝/未命中/失败点数: " << cache_stats.hits << " / " << cache_stats.rejected << " / "
+              << cache_stats.misses << " / " << cache_stats.failed << std::endl;
+
+    // 增量投影：模拟网格变形，每步只有十分之一的点做小幅移动
+    PointArrays moving;
+    moving.x.assign(nurbs_input.x, nurbs_input.x + nurbs_points);
+    moving.y.assign(nurbs_input.y, nurbs_input.y + nurbs_points);
+    moving.z.assign(nurbs_input.z, nurbs_input.z + nurbs_points);
+    IncrementalProjection incremental(nurbs_projector);
+    incremental.update(moving.batch(), BACKEND_TBB, num_threads);
+    std::mt19937 step_rng(7);
+    std::uniform_real_distribution<double> step_offset(-0.05, 0.05);
+    ProjectionResultArrays nurbs_step;
+    nurbs_step.resize(nurbs_points);
+    std::cout << "增量投影（每步移动 " << nurbs_points / 10 << " 点）" << std::endl;
+    for (int step = 1; step <= 3; ++step)
+    {
+        for (int i = step; i < nurbs_points; i += 10)
+        {
+            moving.x[i] += step_offset(step_rng);
+            moving.y[i] += step_offset(step_rng);
+            moving.z[i] += step_offset(step_rng);
+        }
+        t1 = std::chrono::high_resolution_clock::now();
+        IncrementalStats step_stats = incremental.update(moving.batch(), BACKEND_TBB, num_threads);
+        t2 = std::chrono::high_resolution_clock::now();
+        const double step_time = std::chrono::duration<double>(t2 - t1).count();
+        t1 = std::chrono::high_resolution_clock::now();
+        project_batch(nurbs_projector, moving.batch(), nurbs_step.buffers(), BACKEND_TBB, num_threads);
+        t2 = std::chrono::high_resolution_clock::now();
+        const double full_time = std::chrono::duration<double>(t2 - t1).count();
+        const ProjectionResultArrays &step_result = incremental.results();
+        int step_mismatch = 0;
+        for (int i = 0; i < nurbs_points; ++i)
+        {
+            if (step_result.status[i] != nurbs_step.status[i] || nurbs_step.point(i).Distance(step_result.point(i)) > 1e-8)
+                ++step_mismatch;
+        }
+        std::cout << "第 " << step << " 步: 增量 " << step_time << " 秒 / 整批 " << full_time << " 秒，跳过/热启动/全局求解/失败点数: "
+                  << step_stats.skipped << " / " << step_stats.warm_solved << " / " << step_stats.resolved << " / "
+                  << step_stats.failed << "，不一致点数 " << step_mismatch << std::endl;
+    }
+
+    // 调度自动调优：在实际几何上标定调度器/粒度/工作区复用方式，结果按曲面签名缓存到文件
+    const std::string schedule_path = "projection_schedule.cache";
+    ScheduleTuner tuner;
+    tuner.load(schedule_path);
+    const BatchProjector *tuned_projectors[2] = {&batch_projector, &nurbs_projector};
+    const PointBatch tuned_inputs[2] = {points_soa.batch(), nurbs_input};
+    const char *tuned_names[2] = {"解析球面", "NURBS球面"};
+    std::cout << "\n调度自动调优（" << num_threads << " 线程，缓存文件 " << schedule_path << "）" << std::endl;
+    for (int k = 0; k < 2; ++k)
+    {
+        bool cached = false;
+        t1 = std::chrono::high_resolution_clock::now();
+        const ScheduleConfig schedule = tuner.select(*tuned_projectors[k], tuned_inputs[k], num_threads, TuneOptions(), &cached);
+        t2 = std::chrono::high_resolution_clock::now();
+        const double tune_time = std::chrono::duration<double>(t2 - t1).count();
+        ProjectionResultArrays tuned_result;
+        tuned_result.resize(tuned_inputs[k].count);
+        t1 = std::chrono::high_resolution_clock::now();
+        project_batch_scheduled(*tuned_projectors[k], tuned_inputs[k], tuned_result.buffers(), schedule, num_threads);
+        t2 = std::chrono::high_resolution_clock::now();
+        std::cout << tuned_names[k] << ": " << schedule_kind_name(schedule.kind) << "，粒度 " << schedule.grain
+                  << (schedule.reuse_workspace ? "，每线程工作区" : "，每块新建工作区") << (cached ? "（命中缓存" : "（标定")
+                  << " " << tune_time << " 秒），投影耗时 " << std::chrono::duration<double>(t2 - t1).count()
+                  << " 秒，不在球面上的点数 " << count_not_on_sphere(tuned_result, sphere_radius) << std::endl;
+    }
+    tuner.save(schedule_path);
+
+    // 曲线投影：XY平面内与球面同半径的圆（闭式内核），及其NURBS表示（span分段+Newton vs OCCT逐点求解）
+    Handle(Geom_Circle) circle = new Geom_Circle(gp_Ax2(gp_Pnt(0, 0, 0), gp_Dir(0, 0, 1)), sphere_radius);
+    CurveProjector circle_projector(circle);
+    ProjectionResultArrays circle_result;
+    circle_result.resize(num_points);
+    const ProjectionBackend curve_backends[3] = {BACKEND_SERIAL, BACKEND_TBB, BACKEND_OPENMP};
+    const char *curve_names[3] = {"串行", "TBB", "OpenMP"};
+    std::cout << "\n圆曲线投影（" << num_points << " 点，" << num_threads << " 线程）" << std::endl;
+    for (int k = 0; k < 3; ++k)
+    {
+        t1 = std::chrono::high_resolution_clock::now();
+        project_curve_batch(circle_projector, points_soa.batch(), circle_result.buffers(), curve_backends[k], num_threads);
+        t2 = std::chrono::high_resolution_clock::now();
+        int not_on_circle = 0;
+        for (int i = 0; i < num_points; ++i)
+        {
+            const double r = std::sqrt(circle_result.x[i] * circle_result.x[i] + circle_result.y[i] * circle_result.y[i]);
+            if (circle_result.status[i] != PROJECTION_OK || std::abs(r - sphere_radius) > 1e-8 || std::abs(circle_result.z[i]) > 1e-8)
+                ++not_on_circle;
+        }
+        std::cout << curve_names[k] << "闭式投影耗时: " << std::chrono::duration<double>(t2 - t1).count()
+                  << " 秒，不在圆上的点数 " << not_on_circle << std::endl;
+    }
+
+    Handle(Geom_BSplineCurve) nurbsCircle = GeomConvert::CurveToBSplineCurve(circle);
+    CurveProjector nurbs_curve_projector(nurbsCircle);
+    CurveProjector nurbs_curve_occt(nurbsCircle, false);
+    ProjectionResultArrays curve_occt, curve_span;
+    curve_occt.resize(nurbs_points);
+    curve_span.resize(nurbs_points);
+    t1 = std::chrono::high_resolution_clock::now();
+    project_curve_batch(nurbs_curve_occt, nurbs_input, curve_occt.buffers(), BACKEND_TBB, num_threads);
+    t2 = std::chrono::high_resolution_clock::now();
+    double curve_occt_time = std::chrono::duration<double>(t2 - t1).count();
+    t1 = std::chrono::high_resolution_clock::now();
+    project_curve_batch(nurbs_curve_projector, nurbs_input, curve_span.buffers(), BACKEND_TBB, num_threads);
+    t2 = std::chrono::high_resolution_clock::now();
+    double curve_span_time = std::chrono::duration<double>(t2 - t1).count();
+    int curve_mismatch = 0;
+    for (int i = 0; i < nurbs_points; ++i)
+    {
+        if (curve_span.status[i] != curve_occt.status[i] || curve_occt.point(i).Distance(curve_span.point(i)) > 1e-8)
+            ++curve_mismatch;
+    }
+    std::cout << "NURBS圆投影（" << nurbs_points << " 点，" << nurbs_curve_projector.nb_spans() << " 个span）: OCCT逐点求解 "
+              << curve_occt_time << " 秒，span分段求解 " << curve_span_time << " 秒，加速比 "
+              << curve_occt_time / curve_span_time << "，不一致点数 " << curve_mismatch << std::endl;
+
+    // 插桩构建时导出各会话的 Chrome trace
+    PROJ_PROFILE_EXPORT("projection_trace.json");
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "point_cloud_view.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <Graphic3d_ArrayOfPoints.hxx>
+#include <OpenGl_GraphicDriver.hxx>
+#include <V3d_Viewer.hxx>
+
+#ifdef _WIN32
+#include <WNT_Window.hxx>
+#include <windows.h>
+#else
+#include <Aspect_DisplayConnection.hxx>
+#include <Xw_Window.hxx>
+#endif
+
+namespace
+{
+    const int OFFSCREEN_WIDTH = 1280;
+    const int OFFSCREEN_HEIGHT = 960;
+
+    inline bool finite_point(const PointBatch &points, size_t i)
+    {
+        return std::isfinite(points.x[i]) && std::isfinite(points.y[i]) && std::isfinite(points.z[i]);
+    }
+
+    // t ∈ [0, 1] 映射为 蓝 → 绿 → 红
+    Quantity_Color scalar_color(double t)
+    {
+        t = std::min(std::max(t, 0.0), 1.0);
+        return Quantity_Color(t, 1.0 - std::abs(2.0 * t - 1.0), 1.0 - t, Quantity_TOC_RGB);
+    }
+}
+
+Handle(AIS_PointCloud) make_point_cloud(const PointBatch &points, const Quantity_Color &color, const double *scalar,
+                                        size_t max_points)
+{
+    const size_t stride = max_points > 0 && points.count > max_points ? (points.count + max_points - 1) / max_points : 1;
+
+    double smin = std::numeric_limits<double>::infinity(), smax = -smin;
+    if (scalar)
+    {
+        for (size_t i = 0; i < points.count; i += stride)
+        {
+            if (finite_point(points, i) && std::isfinite(scalar[i]))
+                smin = std::min(smin, scalar[i]), smax = std::max(smax, scalar[i]);
+        }
+    }
+    const double range = smax > smin ? smax - smin : 1.0;
+
+    const int capacity = static_cast<int>((points.count + stride - 1) / stride);
+    Handle(Graphic3d_ArrayOfPoints) array = new Graphic3d_ArrayOfPoints(std::max(capacity, 1), scalar != nullptr);
+    for (size_t i = 0; i < points.count; i += stride)
+    {
+        if (!finite_point(points, i))
+            continue;
+        const gp_Pnt p(points.x[i], points.y[i], points.z[i]);
+        if (scalar)
+            array->AddVertex(p, scalar_color(std::isfinite(scalar[i]) ? (scalar[i] - smin) / range : 1.0));
+        else
+            array->AddVertex(p);
+    }
+
+    Handle(AIS_PointCloud) cloud = new AIS_PointCloud();
+    cloud->SetPoints(array);
+    if (!scalar)
+        cloud->SetColor(color);
+    return cloud;
+}
+
+Handle(AIS_InteractiveContext) create_view_context()
+{
+#ifdef _WIN32
+    Handle(OpenGl_GraphicDriver) driver = new OpenGl_GraphicDriver(NULL);
+#else
+    Handle(Aspect_DisplayConnection) display = new Aspect_DisplayConnection();
+    Handle(OpenGl_GraphicDriver) driver = new OpenGl_GraphicDriver(display);
+#endif
+    Handle(V3d_Viewer) viewer = new V3d_Viewer(driver);
+    viewer->SetDefaultLights();
+    viewer->SetLightOn();
+    return new AIS_InteractiveContext(viewer);
+}
+
+Handle(V3d_View) render_view(const Handle(AIS_InteractiveContext) & context, V3d_TypeOfOrientation orientation,
+                             const std::string &image_path)
+{
+    const Handle(V3d_Viewer) &viewer = context->CurrentViewer();
+    Handle(V3d_View) view = viewer->CreateView();
+#ifdef _WIN32
+    HWND hwnd = GetConsoleWindow();
+    if (hwnd == NULL)
+    {
+        std::cerr << "Error: Could not get console window" << std::endl;
+        return Handle(V3d_View)();
+    }
+    Handle(WNT_Window) window = new WNT_Window(hwnd);
+#else
+    Handle(OpenGl_GraphicDriver) driver = Handle(OpenGl_GraphicDriver)::DownCast(viewer->Driver());
+    Handle(Xw_Window) window = new Xw_Window(driver->GetDisplayConnection(), "projection", 0, 0, OFFSCREEN_WIDTH,
+                                             OFFSCREEN_HEIGHT);
+    window->SetVirtual(Standard_True); // 不映射到屏幕，只在离屏缓冲中渲染
+#endif
+    view->SetWindow(window);
+    view->SetProj(orientation);
+    view->SetTwist(0.0);
+    if (!window->IsMapped() && !window->IsVirtual())
+        window->Map();
+    view->FitAll();
+    view->Redraw();
+
+    if (!image_path.empty() && !view->Dump(image_path.c_str()))
+    {
+        std::cerr << "Failed to write image: " << image_path << std::endl;
+        return Handle(V3d_View)();
+    }
+    return view;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <AIS_InteractiveContext.hxx>
+#include <AIS_PointCloud.hxx>
+#include <Quantity_Color.hxx>
+#include <V3d_TypeOfOrientation.hxx>
+#include <V3d_View.hxx>
+
+#include "batch_projection.h"
+
+// 把点集做成一个点云展示对象：所有点放进一个 Graphic3d_ArrayOfPoints，一次绘制调用，
+// 取代每点一个 AIS_Shape 顶点的做法（后者超过几千个点就无法交互）
+// - scalar 非空时按其取值范围逐点着色（蓝→绿→红），否则统一用 color
+// - max_points > 0 且点数更多时等间隔抽取，限制显存占用；坐标非有限值的点跳过
+Handle(AIS_PointCloud) make_point_cloud(const PointBatch &points, const Quantity_Color &color,
+                                        const double *scalar = nullptr, size_t max_points = 0);
+
+// 创建OpenGL图形驱动、查看器和交互上下文（灯光为默认设置）
+Handle(AIS_InteractiveContext) create_view_context();
+
+// 为上下文的查看器建立一个视图，按 orientation 摆放并适配全部对象后渲染：
+// - Windows：绑定控制台窗口显示，image_path 非空时另存截图
+// - 其它平台：不映射到屏幕的虚拟窗口离屏渲染（仍需X显示连接，无显示器时可用Xvfb），画面写到 image_path
+// 图片格式按扩展名，.ppm 不依赖图像库；失败时返回空句柄
+Handle(V3d_View) render_view(const Handle(AIS_InteractiveContext) & context, V3d_TypeOfOrientation orientation,
+                             const std::string &image_path);
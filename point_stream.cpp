@@ -0,0 +1,373 @@
+#include "point_stream.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <tbb/parallel_pipeline.h>
+#include <tbb/concurrent_queue.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/task_arena.h>
+
+namespace
+{
+    uint64_t page_size()
+    {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwAllocationGranularity;
+#else
+        return static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    // 流水线中流动的一块数据（缓冲复用，不随块重新分配）
+    struct StreamChunk
+    {
+        uint64_t begin = 0;
+        size_t count = 0;
+        PointArrays input;
+        ProjectionResultArrays output;
+    };
+
+    const char POINT_MAGIC[8] = {'O', 'C', 'C', 'T', 'P', 'T', 'S', '\0'};
+    const char RESULT_MAGIC[8] = {'O', 'C', 'C', 'T', 'P', 'R', 'J', '\0'};
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open_read(const std::string &path)
+{
+    close();
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+    {
+        file_ = nullptr;
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0)
+    {
+        close();
+        return false;
+    }
+    size_ = static_cast<uint64_t>(size.QuadPart);
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_)
+        data_ = static_cast<unsigned char *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (!data_)
+    {
+        close();
+        return false;
+    }
+    writable_ = false;
+    return true;
+}
+
+bool MappedFile::create(const std::string &path, uint64_t size)
+{
+    close();
+    file_ = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+    {
+        file_ = nullptr;
+        return false;
+    }
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+                                  static_cast<DWORD>(size & 0xffffffffULL), nullptr);
+    if (mapping_)
+        data_ = static_cast<unsigned char *>(MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+    if (!data_)
+    {
+        close();
+        return false;
+    }
+    size_ = size;
+    writable_ = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mapping_)
+        CloseHandle(mapping_);
+    if (file_)
+        CloseHandle(file_);
+    data_ = nullptr, mapping_ = nullptr, file_ = nullptr;
+    size_ = 0;
+}
+
+void MappedFile::flush(uint64_t offset, uint64_t length) const
+{
+    if (!writable_ || !data_ || length == 0)
+        return;
+    FlushViewOfFile(data_ + offset, static_cast<SIZE_T>(length)); // 只发起写回，不等待落盘
+}
+
+void MappedFile::release(uint64_t, uint64_t) const
+{
+    // 只读映射页由系统按需回收
+}
+
+#else
+
+bool MappedFile::open_read(const std::string &path)
+{
+    close();
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || st.st_size == 0)
+    {
+        close();
+        return false;
+    }
+    size_ = static_cast<uint64_t>(st.st_size);
+    void *p = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+    data_ = static_cast<unsigned char *>(p);
+    madvise(data_, size_, MADV_SEQUENTIAL); // 顺序读取，内核加大预读
+    writable_ = false;
+    return true;
+}
+
+bool MappedFile::create(const std::string &path, uint64_t size)
+{
+    close();
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+        return false;
+    if (size == 0 || ftruncate(fd_, static_cast<off_t>(size)) != 0)
+    {
+        close();
+        return false;
+    }
+    void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+    data_ = static_cast<unsigned char *>(p);
+    size_ = size;
+    writable_ = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data_)
+        munmap(data_, size_);
+    if (fd_ >= 0)
+        ::close(fd_);
+    data_ = nullptr, fd_ = -1;
+    size_ = 0;
+}
+
+void MappedFile::flush(uint64_t offset, uint64_t length) const
+{
+    if (!writable_ || !data_ || length == 0)
+        return;
+    const uint64_t page = page_size();
+    const uint64_t begin = offset / page * page;
+    msync(data_ + begin, offset + length - begin, MS_ASYNC);
+}
+
+void MappedFile::release(uint64_t offset, uint64_t length) const
+{
+    if (writable_ || !data_ || length == 0)
+        return;
+    // 只释放完全落在区间内的页，相邻块共享的页留给下一块
+    const uint64_t page = page_size();
+    const uint64_t begin = (offset + page - 1) / page * page;
+    const uint64_t end = (offset + length) / page * page;
+    if (end > begin)
+        madvise(data_ + begin, end - begin, MADV_DONTNEED);
+}
+
+#endif
+
+bool open_point_file(const std::string &path, MappedFile &file, const double *&xyz, uint64_t &count)
+{
+    if (!file.open_read(path))
+    {
+        std::cerr << "Failed to map point file: " << path << std::endl;
+        return false;
+    }
+    const PointFileHeader *header = reinterpret_cast<const PointFileHeader *>(file.data());
+    if (file.size() >= sizeof(PointFileHeader) && std::memcmp(header->magic, POINT_MAGIC, sizeof(POINT_MAGIC)) == 0)
+    {
+        // 先限定 header_size 再用除法比较点数，损坏的 count 不会在乘法中溢出
+        if (header->version != 1 || header->header_size % sizeof(double) != 0 ||
+            header->header_size < sizeof(PointFileHeader) || header->header_size > file.size() ||
+            header->count > (file.size() - header->header_size) / (3 * sizeof(double)))
+        {
+            std::cerr << "Corrupt point file header: " << path << std::endl;
+            return false;
+        }
+        xyz = reinterpret_cast<const double *>(file.data() + header->header_size);
+        count = header->count;
+        return true;
+    }
+
+    // 无文件头：裸 xyz double 序列
+    if (file.size() % (3 * sizeof(double)) != 0)
+    {
+        std::cerr << "Point file size is not a multiple of 24 bytes: " << path << std::endl;
+        return false;
+    }
+    xyz = reinterpret_cast<const double *>(file.data());
+    count = file.size() / (3 * sizeof(double));
+    return true;
+}
+
+ResultFileHeader make_result_header(uint64_t count)
+{
+    // 结果文件：文件头 | 记录区（按8字节对齐） | 状态区
+    ResultFileHeader header;
+    std::memcpy(header.magic, RESULT_MAGIC, sizeof(RESULT_MAGIC));
+    header.version = 1;
+    header.header_size = sizeof(ResultFileHeader);
+    header.count = count;
+    header.record_offset = (sizeof(ResultFileHeader) + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+    header.status_offset = header.record_offset + count * 6 * sizeof(double);
+    return header;
+}
+
+bool project_stream(const BatchProjector &projector, const std::string &input_path, const std::string &output_path,
+                    const StreamOptions &options, StreamStats &stats)
+{
+    stats = StreamStats();
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    MappedFile input;
+    const double *xyz = nullptr;
+    uint64_t count = 0;
+    if (!open_point_file(input_path, input, xyz, count))
+        return false;
+    const uint64_t input_offset = reinterpret_cast<const unsigned char *>(xyz) - input.data();
+
+    const ResultFileHeader header = make_result_header(count);
+    MappedFile output;
+    if (!output.create(output_path, header.status_offset + count))
+    {
+        std::cerr << "Failed to create result file: " << output_path << std::endl;
+        return false;
+    }
+    std::memcpy(output.data(), &header, sizeof(header));
+    double *records = reinterpret_cast<double *>(output.data() + header.record_offset);
+    unsigned char *status = output.data() + header.status_offset;
+
+    const int num_threads = std::max(options.num_threads, 1);
+    const size_t chunk_size = std::max<size_t>(options.chunk_size, 1);
+    const size_t live = options.max_live_chunks ? options.max_live_chunks : 2 * static_cast<size_t>(num_threads);
+
+    // 块缓冲池：存活块数受令牌数限制，池永远不会取空
+    std::vector<std::unique_ptr<StreamChunk>> chunks(live);
+    tbb::concurrent_queue<StreamChunk *> pool;
+    for (auto &chunk : chunks)
+    {
+        chunk.reset(new StreamChunk);
+        chunk->input.reserve(chunk_size);
+        chunk->output.resize(chunk_size);
+        pool.push(chunk.get());
+    }
+    stats.buffer_bytes = live * chunk_size * (9 * sizeof(double) + 1);
+
+    tbb::enumerable_thread_specific<ProjectionWorkspace> ets_workspace;
+    std::atomic<uint64_t> failed(0);
+    uint64_t next = 0;
+    tbb::task_arena arena(num_threads);
+    arena.execute([&] {
+        tbb::parallel_pipeline(
+            live,
+            tbb::make_filter<void, StreamChunk *>(tbb::filter_mode::serial_in_order,
+                                                  [&](tbb::flow_control &fc) -> StreamChunk * {
+                                                      if (next >= count)
+                                                      {
+                                                          fc.stop();
+                                                          return nullptr;
+                                                      }
+                                                      StreamChunk *chunk = nullptr;
+                                                      pool.try_pop(chunk);
+                                                      chunk->begin = next;
+                                                      chunk->count = static_cast<size_t>(std::min<uint64_t>(chunk_size, count - next));
+                                                      next += chunk->count;
+
+                                                      // 交错坐标拷成SoA，随后释放已读的输入页
+                                                      const double *src = xyz + 3 * chunk->begin;
+                                                      chunk->input.x.resize(chunk->count);
+                                                      chunk->input.y.resize(chunk->count);
+                                                      chunk->input.z.resize(chunk->count);
+                                                      for (size_t i = 0; i < chunk->count; ++i)
+                                                      {
+                                                          chunk->input.x[i] = src[3 * i];
+                                                          chunk->input.y[i] = src[3 * i + 1];
+                                                          chunk->input.z[i] = src[3 * i + 2];
+                                                      }
+                                                      input.release(input_offset + chunk->begin * 3 * sizeof(double),
+                                                                    chunk->count * 3 * sizeof(double));
+                                                      return chunk;
+                                                  }) &
+                tbb::make_filter<StreamChunk *, StreamChunk *>(tbb::filter_mode::parallel,
+                                                               [&](StreamChunk *chunk) {
+                                                                   projector.project_range(chunk->input.batch(), chunk->output.buffers(),
+                                                                                           0, chunk->count, ets_workspace.local());
+                                                                   return chunk;
+                                                               }) &
+                tbb::make_filter<StreamChunk *, void>(tbb::filter_mode::parallel,
+                                                      [&](StreamChunk *chunk) {
+                                                          // 各块写入不相交的区域，可并行
+                                                          double *dst = records + 6 * chunk->begin;
+                                                          const ProjectionResultArrays &r = chunk->output;
+                                                          uint64_t chunk_failed = 0;
+                                                          for (size_t i = 0; i < chunk->count; ++i)
+                                                          {
+                                                              dst[6 * i] = r.x[i], dst[6 * i + 1] = r.y[i], dst[6 * i + 2] = r.z[i];
+                                                              dst[6 * i + 3] = r.u[i], dst[6 * i + 4] = r.v[i], dst[6 * i + 5] = r.distance[i];
+                                                              status[chunk->begin + i] = r.status[i];
+                                                              chunk_failed += r.status[i] != PROJECTION_OK;
+                                                          }
+                                                          output.flush(header.record_offset + chunk->begin * 6 * sizeof(double),
+                                                                       chunk->count * 6 * sizeof(double));
+                                                          output.flush(header.status_offset + chunk->begin, chunk->count);
+                                                          failed += chunk_failed;
+                                                          pool.push(chunk);
+                                                      }));
+    });
+
+    stats.points = count;
+    stats.chunks = (count + chunk_size - 1) / chunk_size;
+    stats.failed = failed;
+    stats.elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    return true;
+}
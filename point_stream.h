@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "batch_projection.h"
+
+// 内存映射文件（Windows: CreateFileMapping/MapViewOfFile；其它平台: mmap）
+// 不可复制；析构时解除映射并关闭文件
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open_read(const std::string &path);              // 只读映射整个文件
+    bool create(const std::string &path, uint64_t size);  // 创建（截断）指定大小的文件并读写映射
+    void close();
+
+    bool is_open() const { return data_ != nullptr; }
+    unsigned char *data() const { return data_; }
+    uint64_t size() const { return size_; }
+
+    // 异步写回 [offset, offset + length) 的脏页，限制未落盘数据量
+    void flush(uint64_t offset, uint64_t length) const;
+    // 已读完的只读区域提示系统回收物理页（不支持的平台为空操作）
+    void release(uint64_t offset, uint64_t length) const;
+
+private:
+    unsigned char *data_ = nullptr;
+    uint64_t size_ = 0;
+    bool writable_ = false;
+#ifdef _WIN32
+    void *file_ = nullptr;
+    void *mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+// 点文件：可以是裸 xyz double 序列（文件大小为24的整数倍），也可以带如下文件头
+struct PointFileHeader
+{
+    char magic[8];          // "OCCTPTS"
+    uint32_t version;       // 1
+    uint32_t header_size;   // 文件头字节数，坐标从该偏移开始
+    uint64_t count;         // 点数，坐标按 x, y, z 交错存放
+};
+
+// 投影结果文件：文件头 + count 条记录 (x, y, z, u, v, distance) + count 个状态字节
+struct ResultFileHeader
+{
+    char magic[8];          // "OCCTPRJ"
+    uint32_t version;       // 1
+    uint32_t header_size;
+    uint64_t count;
+    uint64_t record_offset; // 记录区偏移，每条记录6个double
+    uint64_t status_offset; // 状态区偏移，每点一个 ProjectionStatus
+};
+
+// count 个点的结果文件头，文件总大小为 status_offset + count
+ResultFileHeader make_result_header(uint64_t count);
+
+// 打开点文件（自动识别文件头），xyz指向映射内存中的第一个坐标
+bool open_point_file(const std::string &path, MappedFile &file, const double *&xyz, uint64_t &count);
+
+// 写入带文件头的点文件（按块经映射内存写出，用于生成测试数据）
+// generator(begin, end, xyz) 填充 [begin, end) 的交错坐标
+template <class Generator>
+bool write_point_file(const std::string &path, uint64_t count, size_t chunk_size, Generator generator);
+
+// 流式投影参数
+struct StreamOptions
+{
+    size_t chunk_size = 16384;  // 每块点数
+    int num_threads = 1;
+    size_t max_live_chunks = 0; // 同时在流水线中的块数上限（即缓冲数），0 表示 2 * num_threads
+};
+
+// 流式投影统计
+struct StreamStats
+{
+    uint64_t points = 0;
+    uint64_t chunks = 0;
+    uint64_t failed = 0;     // 状态不为 PROJECTION_OK 的点数
+    double elapsed = 0.0;    // 秒
+    size_t buffer_bytes = 0; // 流水线块缓冲占用的内存
+};
+
+// 读取 → 投影 → 写出 三级流水线（tbb::parallel_pipeline）：
+// - 读取级（串行有序）把映射输入中的一块交错坐标拷成SoA，并释放已读页
+// - 投影级（并行）用线程私有工作区调用 BatchProjector::project_range
+// - 写出级（并行，各块写入不相交区域）把结果写进映射输出，并异步写回该块所在的页
+// 同时存活的块数有上限，内存占用只取决于块大小和线程数，与总点数无关
+bool project_stream(const BatchProjector &projector, const std::string &input_path, const std::string &output_path,
+                    const StreamOptions &options, StreamStats &stats);
+
+template <class Generator>
+bool write_point_file(const std::string &path, uint64_t count, size_t chunk_size, Generator generator)
+{
+    MappedFile file;
+    if (!file.create(path, sizeof(PointFileHeader) + count * 3 * sizeof(double)))
+        return false;
+    PointFileHeader header = {{'O', 'C', 'C', 'T', 'P', 'T', 'S', '\0'}, 1, sizeof(PointFileHeader), count};
+    *reinterpret_cast<PointFileHeader *>(file.data()) = header;
+    double *xyz = reinterpret_cast<double *>(file.data() + sizeof(PointFileHeader));
+    for (uint64_t begin = 0; begin < count; begin += chunk_size)
+    {
+        const uint64_t end = std::min<uint64_t>(begin + chunk_size, count);
+        generator(begin, end, xyz + 3 * begin);
+        file.flush(sizeof(PointFileHeader) + begin * 3 * sizeof(double), (end - begin) * 3 * sizeof(double));
+    }
+    return true;
+}
@@ -0,0 +1,360 @@
+#include "prepared_surface.h"
+#include "simd_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <Precision.hxx>
+#include <Geom_BSplineSurface.hxx>
+#include <Geom_RectangularTrimmedSurface.hxx>
+
+namespace
+{
+    const int DEFAULT_SAMPLES = 33;              // 非B样条曲面每个方向的采样数
+    const int MAX_PATCHES_PER_DIRECTION = 16;    // 每个方向的补丁数上限
+    const int NB_EXTRA_SEEDS = 2;                // 首个种子之外最多再尝试的种子数
+
+    // 生成一个方向上的采样参数：有节点时每个节点区间等分 (degree + 1) 段，否则均匀采样
+    void build_params(double tmin, double tmax, const std::vector<double> &knots, int degree, int cap,
+                      std::vector<double> &out)
+    {
+        out.clear();
+        const size_t spans = knots.size() > 1 ? knots.size() - 1 : 0;
+        if (spans > 0 && static_cast<int>(spans) < cap)
+        {
+            int per_span = std::max(2, degree + 1);
+            if (static_cast<int>(spans) * per_span + 1 > cap)
+                per_span = std::max(1, (cap - 1) / static_cast<int>(spans));
+            for (size_t k = 0; k < spans; ++k)
+            {
+                for (int s = 0; s < per_span; ++s)
+                    out.push_back(knots[k] + (knots[k + 1] - knots[k]) * s / per_span);
+            }
+            out.push_back(knots.back());
+            return;
+        }
+        const int n = std::min(cap, DEFAULT_SAMPLES);
+        for (int i = 0; i < n; ++i)
+            out.push_back(tmin + (tmax - tmin) * i / (n - 1));
+    }
+
+    // 取参数域内的去重节点
+    void collect_knots(const Handle(Geom_BSplineSurface) & bspline, bool u_dir, double tmin, double tmax,
+                       std::vector<double> &knots)
+    {
+        knots.clear();
+        const int nb = u_dir ? bspline->NbUKnots() : bspline->NbVKnots();
+        for (int i = 1; i <= nb; ++i)
+        {
+            const double t = u_dir ? bspline->UKnot(i) : bspline->VKnot(i);
+            if (t >= tmin - Precision::PConfusion() && t <= tmax + Precision::PConfusion())
+                knots.push_back(std::min(std::max(t, tmin), tmax));
+        }
+    }
+
+    inline double box_dist2(const double box[6], double x, double y, double z)
+    {
+        const double dx = std::max(std::max(box[0] - x, x - box[3]), 0.0);
+        const double dy = std::max(std::max(box[1] - y, y - box[4]), 0.0);
+        const double dz = std::max(std::max(box[2] - z, z - box[5]), 0.0);
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    std::atomic<uint64_t> next_prepared_id(1);
+}
+
+PreparedSurface::PreparedSurface(const Handle(Geom_Surface) & surface, int max_samples_per_direction,
+                                 ProjectionPrecision precision)
+    : id_(next_prepared_id.fetch_add(1, std::memory_order_relaxed)), surface_(surface), precision_(precision)
+{
+    if (surface_.IsNull())
+        return;
+    domain_ = surface_param_domain(surface_);
+    if (Precision::IsInfinite(domain_.umin) || Precision::IsInfinite(domain_.umax) ||
+        Precision::IsInfinite(domain_.vmin) || Precision::IsInfinite(domain_.vmax))
+        return;
+
+    const int cap = std::max(max_samples_per_direction, 3);
+    int udeg = 0, vdeg = 0;
+    if (Handle(Geom_BSplineSurface) bspline = Handle(Geom_BSplineSurface)::DownCast(surface_))
+    {
+        collect_knots(bspline, true, domain_.umin, domain_.umax, uknots_);
+        collect_knots(bspline, false, domain_.vmin, domain_.vmax, vknots_);
+        udeg = bspline->UDegree();
+        vdeg = bspline->VDegree();
+    }
+    build_params(domain_.umin, domain_.umax, uknots_, udeg, cap, us_);
+    build_params(domain_.vmin, domain_.vmax, vknots_, vdeg, cap, vs_);
+
+    // 采样网格
+    const int nu = nb_u_samples(), nv = nb_v_samples();
+    sx_.resize(static_cast<size_t>(nu) * nv);
+    sy_.resize(sx_.size());
+    sz_.resize(sx_.size());
+    gp_Pnt p;
+    for (int i = 0; i < nu; ++i)
+    {
+        for (int j = 0; j < nv; ++j)
+        {
+            surface_->D0(us_[i], vs_[j], p);
+            const size_t k = static_cast<size_t>(i) * nv + j;
+            sx_[k] = p.X(), sy_[k] = p.Y(), sz_[k] = p.Z();
+        }
+    }
+
+    // 补丁包围盒：包住补丁内采样点，再按网格单元中心点偏离双线性插值的最大值放大
+    const int cells_u = (nu - 1 + MAX_PATCHES_PER_DIRECTION - 1) / MAX_PATCHES_PER_DIRECTION;
+    const int cells_v = (nv - 1 + MAX_PATCHES_PER_DIRECTION - 1) / MAX_PATCHES_PER_DIRECTION;
+    for (int i0 = 0; i0 < nu - 1; i0 += cells_u)
+    {
+        for (int j0 = 0; j0 < nv - 1; j0 += cells_v)
+        {
+            Patch patch;
+            patch.i0 = i0, patch.i1 = std::min(i0 + cells_u, nu - 1);
+            patch.j0 = j0, patch.j1 = std::min(j0 + cells_v, nv - 1);
+            patch.f_begin = patch.f_count = 0;
+            patch.box[0] = patch.box[1] = patch.box[2] = std::numeric_limits<double>::max();
+            patch.box[3] = patch.box[4] = patch.box[5] = -std::numeric_limits<double>::max();
+            double deviation = 0.0;
+            for (int i = patch.i0; i <= patch.i1; ++i)
+            {
+                for (int j = patch.j0; j <= patch.j1; ++j)
+                {
+                    const size_t k = static_cast<size_t>(i) * nv + j;
+                    patch.box[0] = std::min(patch.box[0], sx_[k]), patch.box[3] = std::max(patch.box[3], sx_[k]);
+                    patch.box[1] = std::min(patch.box[1], sy_[k]), patch.box[4] = std::max(patch.box[4], sy_[k]);
+                    patch.box[2] = std::min(patch.box[2], sz_[k]), patch.box[5] = std::max(patch.box[5], sz_[k]);
+                    if (i == patch.i1 || j == patch.j1)
+                        continue;
+                    const size_t k10 = k + nv, k01 = k + 1, k11 = k + nv + 1;
+                    surface_->D0(0.5 * (us_[i] + us_[i + 1]), 0.5 * (vs_[j] + vs_[j + 1]), p);
+                    const double mx = 0.25 * (sx_[k] + sx_[k10] + sx_[k01] + sx_[k11]);
+                    const double my = 0.25 * (sy_[k] + sy_[k10] + sy_[k01] + sy_[k11]);
+                    const double mz = 0.25 * (sz_[k] + sz_[k10] + sz_[k01] + sz_[k11]);
+                    deviation = std::max(deviation, p.Distance(gp_Pnt(mx, my, mz)));
+                }
+            }
+            const double pad = 1.5 * deviation + Precision::Confusion();
+            for (int c = 0; c < 3; ++c)
+            {
+                patch.box[c] -= pad;
+                patch.box[c + 3] += pad;
+            }
+            patches_.push_back(patch);
+        }
+    }
+    valid_ = !patches_.empty();
+    if (valid_ && precision_ == PRECISION_MIXED)
+        build_float_samples();
+    if (valid_)
+        select_evaluator();
+}
+
+void PreparedSurface::select_evaluator()
+{
+    if (span_table_.init(surface_))
+    {
+        evaluator_kind_ = EVALUATOR_BSPLINE;
+        return;
+    }
+    // 裁剪后的初等曲面（不走闭式投影内核，但Newton求值仍可用闭式公式）
+    Handle(Geom_Surface) basis = surface_;
+    while (Handle(Geom_RectangularTrimmedSurface) trimmed = Handle(Geom_RectangularTrimmedSurface)::DownCast(basis))
+        basis = trimmed->BasisSurface();
+    if (!analytic_surface_init(basis, evaluator_analytic_))
+        return;
+    switch (evaluator_analytic_.type)
+    {
+    case ANALYTIC_PLANE:
+        evaluator_kind_ = EVALUATOR_PLANE;
+        break;
+    case ANALYTIC_CYLINDER:
+        evaluator_kind_ = EVALUATOR_CYLINDER;
+        break;
+    case ANALYTIC_CONE:
+        evaluator_kind_ = EVALUATOR_CONE;
+        break;
+    case ANALYTIC_SPHERE:
+        evaluator_kind_ = EVALUATOR_SPHERE;
+        break;
+    case ANALYTIC_TORUS:
+        evaluator_kind_ = EVALUATOR_TORUS;
+        break;
+    default:
+        break;
+    }
+}
+
+void PreparedSurface::build_float_samples()
+{
+    double lo[3] = {sx_[0], sy_[0], sz_[0]}, hi[3] = {sx_[0], sy_[0], sz_[0]};
+    for (size_t k = 0; k < sx_.size(); ++k)
+    {
+        lo[0] = std::min(lo[0], sx_[k]), hi[0] = std::max(hi[0], sx_[k]);
+        lo[1] = std::min(lo[1], sy_[k]), hi[1] = std::max(hi[1], sy_[k]);
+        lo[2] = std::min(lo[2], sz_[k]), hi[2] = std::max(hi[2], sz_[k]);
+    }
+    for (int c = 0; c < 3; ++c)
+        fcenter_[c] = 0.5 * (lo[c] + hi[c]);
+
+    // 补丁内的采样点连续存放，SIMD内核一次扫描整个补丁（相邻补丁共享的边界采样各存一份）
+    const size_t nv = vs_.size();
+    for (Patch &patch : patches_)
+    {
+        patch.f_begin = fx_.size();
+        for (int i = patch.i0; i <= patch.i1; ++i)
+        {
+            for (int j = patch.j0; j <= patch.j1; ++j)
+            {
+                const size_t k = static_cast<size_t>(i) * nv + j;
+                fx_.push_back(static_cast<float>(sx_[k] - fcenter_[0]));
+                fy_.push_back(static_cast<float>(sy_[k] - fcenter_[1]));
+                fz_.push_back(static_cast<float>(sz_[k] - fcenter_[2]));
+                findex_.push_back(static_cast<unsigned>(k));
+            }
+        }
+        patch.f_count = fx_.size() - patch.f_begin;
+    }
+}
+
+void PreparedSurface::bind(Scratch &scratch) const
+{
+    if (scratch.owner == id_)
+        return;
+    scratch.adaptor.Load(surface_);
+    scratch.patch_bounds.resize(patches_.size());
+    scratch.patch_best_dist2.resize(patches_.size());
+    scratch.patch_best.resize(patches_.size());
+    scratch.owner = id_;
+}
+
+void PreparedSurface::scan_patch(const Patch &patch, const gp_Pnt &p, size_t &best, double &best_dist2) const
+{
+    const double px = p.X(), py = p.Y(), pz = p.Z();
+    if (precision_ == PRECISION_MIXED)
+    {
+        // 单精度选出补丁内最近采样点，再用双精度重算其距离，剪枝和种子排序仍按双精度比较
+        float d2f;
+        const size_t k = nearest_point_f32(&fx_[patch.f_begin], &fy_[patch.f_begin], &fz_[patch.f_begin], patch.f_count,
+                                           static_cast<float>(px - fcenter_[0]), static_cast<float>(py - fcenter_[1]),
+                                           static_cast<float>(pz - fcenter_[2]), d2f);
+        const size_t s = findex_[patch.f_begin + k];
+        const double dx = sx_[s] - px, dy = sy_[s] - py, dz = sz_[s] - pz;
+        const double d2 = dx * dx + dy * dy + dz * dz;
+        if (d2 < best_dist2)
+        {
+            best_dist2 = d2;
+            best = s;
+        }
+        return;
+    }
+    const size_t nv = vs_.size();
+    for (int i = patch.i0; i <= patch.i1; ++i)
+    {
+        const size_t row = static_cast<size_t>(i) * nv;
+        for (size_t k = row + patch.j0; k <= row + patch.j1; ++k)
+        {
+            const double dx = sx_[k] - px, dy = sy_[k] - py, dz = sz_[k] - pz;
+            const double d2 = dx * dx + dy * dy + dz * dz;
+            if (d2 < best_dist2)
+            {
+                best_dist2 = d2;
+                best = k;
+            }
+        }
+    }
+}
+
+size_t PreparedSurface::nearest_sample(const gp_Pnt &p, Scratch &scratch, double &sample_dist2) const
+{
+    bind(scratch);
+    const size_t nb = patches_.size();
+    size_t first = 0;
+    for (size_t k = 0; k < nb; ++k)
+    {
+        scratch.patch_bounds[k] = box_dist2(patches_[k].box, p.X(), p.Y(), p.Z());
+        scratch.patch_best_dist2[k] = std::numeric_limits<double>::infinity();
+        if (scratch.patch_bounds[k] < scratch.patch_bounds[first])
+            first = k;
+    }
+
+    // 先扫描下界最小的补丁，再只扫描下界小于当前最近采样距离的补丁
+    size_t best = 0;
+    sample_dist2 = std::numeric_limits<double>::infinity();
+    scan_patch(patches_[first], p, scratch.patch_best[first], scratch.patch_best_dist2[first]);
+    best = scratch.patch_best[first];
+    sample_dist2 = scratch.patch_best_dist2[first];
+    for (size_t k = 0; k < nb; ++k)
+    {
+        if (k == first || scratch.patch_bounds[k] >= sample_dist2)
+            continue;
+        scan_patch(patches_[k], p, scratch.patch_best[k], scratch.patch_best_dist2[k]);
+        if (scratch.patch_best_dist2[k] < sample_dist2)
+        {
+            sample_dist2 = scratch.patch_best_dist2[k];
+            best = scratch.patch_best[k];
+        }
+    }
+    return best;
+}
+
+bool PreparedSurface::refine(const gp_Pnt &p, double u0, double v0, Scratch &scratch, LocalProjectionResult &result,
+                             int max_iterations) const
+{
+    return with_evaluator(scratch, [&](const auto &evaluator) {
+        return local_project_point(evaluator, domain_, p, u0, v0, result, max_iterations);
+    });
+}
+
+bool PreparedSurface::project(const gp_Pnt &p, Scratch &scratch, LocalProjectionResult &result) const
+{
+    return with_evaluator(scratch, [&](const auto &evaluator) { return project(p, scratch, evaluator, result); });
+}
+
+template <class Evaluator>
+bool PreparedSurface::project(const gp_Pnt &p, Scratch &scratch, const Evaluator &evaluator, LocalProjectionResult &result) const
+{
+    if (!valid_)
+        return false;
+
+    double sample_dist2 = 0.0;
+    const size_t seed = nearest_sample(p, scratch, sample_dist2);
+    bool found = local_project_point(evaluator, domain_, p, sample_u(seed), sample_v(seed), result);
+
+    // 其它已扫描补丁若包围盒下界小于当前解的距离，可能含有更近的局部极小，
+    // 按补丁内最近采样点由近到远再试几个种子
+    LocalProjectionResult candidate;
+    const double bound = found ? result.distance * result.distance : sample_dist2;
+    for (int extra = 0; extra < NB_EXTRA_SEEDS; ++extra)
+    {
+        size_t next = patches_.size();
+        for (size_t k = 0; k < patches_.size(); ++k)
+        {
+            if (scratch.patch_best[k] == seed || scratch.patch_bounds[k] >= bound ||
+                !std::isfinite(scratch.patch_best_dist2[k]))
+                continue;
+            if (next == patches_.size() || scratch.patch_best_dist2[k] < scratch.patch_best_dist2[next])
+                next = k;
+        }
+        if (next == patches_.size())
+            break;
+        const size_t s = scratch.patch_best[next];
+        scratch.patch_best_dist2[next] = std::numeric_limits<double>::infinity(); // 标记已尝试
+        if (local_project_point(evaluator, domain_, p, sample_u(s), sample_v(s), candidate) &&
+            (!found || candidate.distance < result.distance))
+        {
+            result = candidate;
+            found = true;
+        }
+    }
+    return found;
+}
+
+template bool PreparedSurface::project(const gp_Pnt &, Scratch &, const Adaptor3d_Surface &, LocalProjectionResult &) const;
+template bool PreparedSurface::project(const gp_Pnt &, Scratch &, const PlaneEvaluator &, LocalProjectionResult &) const;
+template bool PreparedSurface::project(const gp_Pnt &, Scratch &, const CylinderEvaluator &, LocalProjectionResult &) const;
+template bool PreparedSurface::project(const gp_Pnt &, Scratch &, const ConeEvaluator &, LocalProjectionResult &) const;
+template bool PreparedSurface::project(const gp_Pnt &, Scratch &, const SphereEvaluator &, LocalProjectionResult &) const;
+template bool PreparedSurface::project(const gp_Pnt &, Scratch &, const TorusEvaluator &, LocalProjectionResult &) const;
+template bool PreparedSurface::project(const gp_Pnt &, Scratch &, const BSplineEvaluator &, LocalProjectionResult &) const;
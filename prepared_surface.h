@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <gp_Pnt.hxx>
+#include <Geom_Surface.hxx>
+#include <GeomAdaptor_Surface.hxx>
+
+#include "local_projection.h"
+#include "surface_evaluators.h"
+
+// 最近采样点搜索的精度
+// PRECISION_MIXED：另存一份单精度采样网格（按补丁连续存放），用运行时分派的SIMD内核扫描，
+// 数据量减半、每条指令处理的点数加倍；选出的种子仍用双精度Newton求解，最终结果精度不变
+enum ProjectionPrecision
+{
+    PRECISION_DOUBLE = 0,
+    PRECISION_MIXED
+};
+
+// 预处理曲面：每个 Handle(Geom_Surface) 只构建一次，之后被所有工作线程只读共享
+// - UV采样网格（B样条按节点区间对齐加密，其它曲面均匀采样）
+// - 按网格块划分的补丁包围盒，用于剪枝最近采样点搜索
+// - B样条节点区间（去重后的节点），供种子和Newton求解定位span
+// - 特化求值器：B样条/Bezier的span幂基系数表，初等曲面（如裁剪后的）的闭式求值，Newton迭代不经过虚调用
+// 每个线程只需持有一个廉价的 Scratch（求值适配器和候选缓冲）
+class PreparedSurface
+{
+public:
+    // 线程私有状态，可默认构造，首次使用时绑定到具体的 PreparedSurface；
+    // 按对象编号而非地址识别绑定对象，跨批次复用时不会误认地址相同的新对象
+    struct Scratch
+    {
+        uint64_t owner = 0;
+        GeomAdaptor_Surface adaptor;      // 线程私有求值器，内部缓存当前B样条span的多项式系数
+        std::vector<double> patch_bounds; // 各补丁包围盒到查询点的距离平方下界
+        std::vector<double> patch_best_dist2; // 已扫描补丁内最近采样点的距离平方（未扫描为无穷大）
+        std::vector<size_t> patch_best;       // 已扫描补丁内最近采样点下标
+    };
+
+    // 每个方向的采样数上限；参数域无限（如拉伸面）时 is_valid() 为false
+    explicit PreparedSurface(const Handle(Geom_Surface) & surface, int max_samples_per_direction = 256,
+                             ProjectionPrecision precision = PRECISION_DOUBLE);
+
+    bool is_valid() const { return valid_; }
+    ProjectionPrecision precision() const { return precision_; }
+    const Handle(Geom_Surface) & surface() const { return surface_; }
+    const SurfaceParamDomain &domain() const { return domain_; }
+    int nb_u_samples() const { return static_cast<int>(us_.size()); }
+    int nb_v_samples() const { return static_cast<int>(vs_.size()); }
+    size_t nb_patches() const { return patches_.size(); }
+    const std::vector<double> &u_knots() const { return uknots_; }
+    const std::vector<double> &v_knots() const { return vknots_; }
+    SurfaceEvaluatorKind evaluator_kind() const { return evaluator_kind_; }
+    const BSplineSpanTable &span_table() const { return span_table_; }
+
+    // 全局投影：剪枝搜索最近采样点作为种子，再做局部Newton求解
+    // Newton不收敛时返回false，由调用者回退到 GeomAPI_ProjectPointOnSurf
+    bool project(const gp_Pnt &p, Scratch &scratch, LocalProjectionResult &result) const;
+
+    // 同上，使用调用者构造的求值器（批处理按 with_evaluator 分派一次，整块点共用）
+    template <class Evaluator>
+    bool project(const gp_Pnt &p, Scratch &scratch, const Evaluator &evaluator, LocalProjectionResult &result) const;
+
+    // 按 evaluator_kind() 构造具体求值器并调用 f(const Evaluator &)，返回 f 的结果；
+    // 无特化时传入 scratch 中的适配器
+    template <class F>
+    decltype(auto) with_evaluator(Scratch &scratch, F &&f) const
+    {
+        switch (evaluator_kind_)
+        {
+        case EVALUATOR_PLANE:
+            return f(PlaneEvaluator(evaluator_analytic_));
+        case EVALUATOR_CYLINDER:
+            return f(CylinderEvaluator(evaluator_analytic_));
+        case EVALUATOR_CONE:
+            return f(ConeEvaluator(evaluator_analytic_));
+        case EVALUATOR_SPHERE:
+            return f(SphereEvaluator(evaluator_analytic_));
+        case EVALUATOR_TORUS:
+            return f(TorusEvaluator(evaluator_analytic_));
+        case EVALUATOR_BSPLINE:
+            return f(BSplineEvaluator(span_table_));
+        default:
+            bind(scratch);
+            return f(static_cast<const Adaptor3d_Surface &>(scratch.adaptor));
+        }
+    }
+
+    // 从给定种子做局部求解（热启动用），使用线程私有适配器求值
+    bool refine(const gp_Pnt &p, double u0, double v0, Scratch &scratch, LocalProjectionResult &result,
+                int max_iterations = 20) const;
+
+    // 最近采样点搜索，返回采样点下标（i * nv + j），sample_dist2为其距离平方
+    size_t nearest_sample(const gp_Pnt &p, Scratch &scratch, double &sample_dist2) const;
+
+    double sample_u(size_t index) const { return us_[index / vs_.size()]; }
+    double sample_v(size_t index) const { return vs_[index % vs_.size()]; }
+
+private:
+    // 补丁：采样网格中 [i0, i1] x [j0, j1] 的一块，包围盒已按弦高偏差放大
+    struct Patch
+    {
+        double box[6]; // xmin, ymin, zmin, xmax, ymax, zmax
+        int i0, i1, j0, j1;
+        size_t f_begin, f_count; // 单精度采样在 fx_ 等数组中的区间（仅 PRECISION_MIXED）
+    };
+
+    void bind(Scratch &scratch) const;
+    void scan_patch(const Patch &patch, const gp_Pnt &p, size_t &best, double &best_dist2) const;
+    void build_float_samples();
+    void select_evaluator();
+
+    uint64_t id_;                           // 进程内唯一编号（从1开始），供 Scratch 识别绑定对象
+    Handle(Geom_Surface) surface_;
+    SurfaceParamDomain domain_;
+    bool valid_ = false;
+    std::vector<double> us_, vs_;           // 采样参数
+    std::vector<double> sx_, sy_, sz_;      // 采样点坐标（SoA，下标 i * nv + j）
+    std::vector<Patch> patches_;
+    std::vector<double> uknots_, vknots_;   // B样条去重节点，非B样条为空
+    ProjectionPrecision precision_ = PRECISION_DOUBLE;
+    double fcenter_[3] = {0.0, 0.0, 0.0};   // 单精度坐标相对采样包围盒中心存放，减小舍入误差
+    std::vector<float> fx_, fy_, fz_;       // 单精度采样（按补丁连续）
+    std::vector<unsigned> findex_;          // 对应的采样点下标 i * nv + j
+    SurfaceEvaluatorKind evaluator_kind_ = EVALUATOR_ADAPTOR;
+    AnalyticSurface evaluator_analytic_;    // 初等曲面求值器的参数
+    BSplineSpanTable span_table_;
+};
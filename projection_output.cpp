@@ -0,0 +1,187 @@
+#include "projection_output.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    const size_t VTP_CHUNK_POINTS = 1 << 16; // 坐标交错和顶点下标生成的块大小
+
+    bool little_endian()
+    {
+        const uint16_t probe = 1;
+        return *reinterpret_cast<const unsigned char *>(&probe) == 1;
+    }
+
+    const char *field_type(const VtpField &field)
+    {
+        return field.f64 ? "Float64" : field.i32 ? "Int32" : "UInt8";
+    }
+
+    size_t field_bytes(const VtpField &field)
+    {
+        return field.f64 ? sizeof(double) : field.i32 ? sizeof(int) : 1;
+    }
+
+    const void *field_data(const VtpField &field)
+    {
+        return field.f64 ? static_cast<const void *>(field.f64)
+                         : field.i32 ? static_cast<const void *>(field.i32) : static_cast<const void *>(field.u8);
+    }
+
+    // appended 区的一块：UInt64 字节数 + 数据
+    void write_block_header(std::ofstream &out, uint64_t bytes)
+    {
+        out.write(reinterpret_cast<const char *>(&bytes), sizeof(bytes));
+    }
+
+    // 顶点单元的 connectivity（0..n-1）或 offsets（1..n），按块生成
+    template <class Index>
+    void write_vertex_indices(std::ofstream &out, size_t count, Index first)
+    {
+        std::vector<Index> chunk(std::min(count, VTP_CHUNK_POINTS));
+        for (size_t begin = 0; begin < count; begin += VTP_CHUNK_POINTS)
+        {
+            const size_t n = std::min(VTP_CHUNK_POINTS, count - begin);
+            for (size_t i = 0; i < n; ++i)
+                chunk[i] = static_cast<Index>(begin + i) + first;
+            out.write(reinterpret_cast<const char *>(chunk.data()), n * sizeof(Index));
+        }
+    }
+}
+
+bool write_vtp_points(const std::string &path, const PointBatch &points, const std::vector<VtpField> &fields)
+{
+    for (const VtpField &field : fields)
+    {
+        if (!field.f64 && !field.i32 && !field.u8)
+        {
+            std::cerr << "Empty VTP field: " << field.name << std::endl;
+            return false;
+        }
+    }
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+    {
+        std::cerr << "Failed to create VTP file: " << path << std::endl;
+        return false;
+    }
+
+    const size_t n = points.count;
+    const bool wide = n > static_cast<size_t>(INT32_MAX); // 顶点下标超出 Int32 时改用 Int64
+    const size_t index_bytes = wide ? sizeof(int64_t) : sizeof(int32_t);
+
+    // 各数组在 appended 区中的偏移：字段、坐标、connectivity、offsets
+    uint64_t offset = 0;
+    std::vector<uint64_t> field_offsets;
+    for (const VtpField &field : fields)
+    {
+        field_offsets.push_back(offset);
+        offset += sizeof(uint64_t) + field_bytes(field) * n;
+    }
+    const uint64_t points_offset = offset;
+    offset += sizeof(uint64_t) + 3 * sizeof(double) * n;
+    const uint64_t connectivity_offset = offset;
+    offset += sizeof(uint64_t) + index_bytes * n;
+    const uint64_t offsets_offset = offset;
+
+    const char *index_type = wide ? "Int64" : "Int32";
+    out << "<?xml version=\"1.0\"?>\n"
+        << "<VTKFile type=\"PolyData\" version=\"1.0\" byte_order=\"" << (little_endian() ? "LittleEndian" : "BigEndian")
+        << "\" header_type=\"UInt64\">\n"
+        << "  <PolyData>\n"
+        << "    <Piece NumberOfPoints=\"" << n << "\" NumberOfVerts=\"" << n
+        << "\" NumberOfLines=\"0\" NumberOfStrips=\"0\" NumberOfPolys=\"0\">\n";
+    out << "      <PointData";
+    if (!fields.empty())
+        out << " Scalars=\"" << fields.front().name << "\"";
+    out << ">\n";
+    for (size_t k = 0; k < fields.size(); ++k)
+        out << "        <DataArray type=\"" << field_type(fields[k]) << "\" Name=\"" << fields[k].name
+            << "\" format=\"appended\" offset=\"" << field_offsets[k] << "\"/>\n";
+    out << "      </PointData>\n"
+        << "      <Points>\n"
+        << "        <DataArray type=\"Float64\" NumberOfComponents=\"3\" format=\"appended\" offset=\"" << points_offset << "\"/>\n"
+        << "      </Points>\n"
+        << "      <Verts>\n"
+        << "        <DataArray type=\"" << index_type << "\" Name=\"connectivity\" format=\"appended\" offset=\""
+        << connectivity_offset << "\"/>\n"
+        << "        <DataArray type=\"" << index_type << "\" Name=\"offsets\" format=\"appended\" offset=\""
+        << offsets_offset << "\"/>\n"
+        << "      </Verts>\n"
+        << "    </Piece>\n"
+        << "  </PolyData>\n"
+        << "  <AppendedData encoding=\"raw\">\n   _";
+
+    for (const VtpField &field : fields)
+    {
+        write_block_header(out, field_bytes(field) * n);
+        out.write(static_cast<const char *>(field_data(field)), field_bytes(field) * n);
+    }
+
+    write_block_header(out, 3 * sizeof(double) * n);
+    std::vector<double> xyz(3 * std::min(n, VTP_CHUNK_POINTS));
+    for (size_t begin = 0; begin < n; begin += VTP_CHUNK_POINTS)
+    {
+        const size_t count = std::min(VTP_CHUNK_POINTS, n - begin);
+        for (size_t i = 0; i < count; ++i)
+        {
+            xyz[3 * i] = points.x[begin + i];
+            xyz[3 * i + 1] = points.y[begin + i];
+            xyz[3 * i + 2] = points.z[begin + i];
+        }
+        out.write(reinterpret_cast<const char *>(xyz.data()), 3 * sizeof(double) * count);
+    }
+
+    write_block_header(out, index_bytes * n);
+    if (wide)
+        write_vertex_indices<int64_t>(out, n, 0);
+    else
+        write_vertex_indices<int32_t>(out, n, 0);
+    write_block_header(out, index_bytes * n);
+    if (wide)
+        write_vertex_indices<int64_t>(out, n, 1);
+    else
+        write_vertex_indices<int32_t>(out, n, 1);
+
+    out << "\n  </AppendedData>\n</VTKFile>\n";
+    if (!out)
+    {
+        std::cerr << "Failed to write VTP file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool write_projection_vtp(const std::string &input_path, const std::string &projected_path, const PointBatch &input,
+                          const ProjectionBuffers &output)
+{
+    VtpField distance, status, u, v;
+    distance.name = "distance", distance.f64 = output.distance;
+    status.name = "status", status.u8 = output.status;
+    u.name = "u", u.f64 = output.u;
+    v.name = "v", v.f64 = output.v;
+
+    std::vector<VtpField> fields;
+    if (output.distance)
+        fields.push_back(distance);
+    if (output.status)
+        fields.push_back(status);
+    if (!input_path.empty() && !write_vtp_points(input_path, input, fields))
+        return false;
+
+    if (projected_path.empty())
+        return true;
+    if (output.u)
+        fields.push_back(u);
+    if (output.v)
+        fields.push_back(v);
+    PointBatch projected;
+    projected.x = output.x;
+    projected.y = output.y;
+    projected.z = output.z;
+    projected.count = input.count;
+    return write_vtp_points(projected_path, projected, fields);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "batch_projection.h"
+
+// 点数据中的一个字段，三种类型取其一；指针指向调用者的数组（至少 count 个元素），写出时不复制
+struct VtpField
+{
+    std::string name;
+    const double *f64 = nullptr;
+    const int *i32 = nullptr;
+    const unsigned char *u8 = nullptr;
+};
+
+// 把点集写成 VTK XML PolyData（.vtp，appended raw 二进制），每个点一个顶点单元，ParaView 可直接打开
+// - 字段从调用者的数组直接写入文件；坐标要交错成 xyz，经一个固定大小的块缓冲写出，不复制整批数据
+// - 第一个字段作为默认着色标量
+// 文件大小约为 (24 + 各字段字节数 + 8) * 点数（超过 2^31 个点时顶点单元改用64位下标）
+bool write_vtp_points(const std::string &path, const PointBatch &points, const std::vector<VtpField> &fields);
+
+// 投影结果写成两份点集（路径为空的一份跳过）：
+// - input_path：输入点，字段 distance、status
+// - projected_path：投影点，字段 distance、status、u、v（输出缓冲中为空的字段不写）
+bool write_projection_vtp(const std::string &input_path, const std::string &projected_path, const PointBatch &input,
+                          const ProjectionBuffers &output);
@@ -0,0 +1,210 @@
+#include "projection_profiler.h"
+
+#ifdef PROJECTION_PROFILE
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    // 各线程缓存的会话计数指针，generation 变化后重新注册
+    thread_local uint64_t cached_generation = 0;
+    thread_local ThreadProfile *cached_profile = nullptr;
+
+    void write_json_string(std::ostream &os, const std::string &s)
+    {
+        os << '"';
+        for (char c : s)
+        {
+            if (c == '"' || c == '\\')
+                os << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20)
+                os << ' ';
+            else
+                os << c;
+        }
+        os << '"';
+    }
+}
+
+ProjectionProfiler &ProjectionProfiler::instance()
+{
+    static ProjectionProfiler profiler;
+    return profiler;
+}
+
+int64_t ProjectionProfiler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ProjectionProfiler::begin_session(const std::string &name, int num_threads)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<Session> session(new Session);
+    session->name = name;
+    session->num_threads = std::max(num_threads, 1);
+    session->begin = now();
+    active_ = session.get();
+    sessions_.push_back(std::move(session));
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+void ProjectionProfiler::end_session()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!active_)
+        return;
+    active_->end = now();
+    active_ = nullptr;
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+ThreadProfile *ProjectionProfiler::local()
+{
+    // 快路径：一次原子读 + 线程局部变量比较
+    if (cached_generation == generation_.load(std::memory_order_acquire))
+        return cached_profile;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    cached_generation = generation_.load(std::memory_order_relaxed);
+    cached_profile = nullptr;
+    if (active_)
+    {
+        std::unique_ptr<ThreadProfile> profile(new ThreadProfile);
+        profile->index = static_cast<int>(active_->threads.size());
+        profile->events.reserve(1024);
+        cached_profile = profile.get();
+        active_->threads.push_back(std::move(profile));
+    }
+    return cached_profile;
+}
+
+void ProjectionProfiler::report(std::ostream &os) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sessions_.empty() || sessions_.back().get() == active_)
+        return;
+    const Session &s = *sessions_.back();
+    const double wall = (s.end - s.begin) * 1e-6;
+    const int slots = std::max(s.num_threads, static_cast<int>(s.threads.size()));
+
+    const std::ios_base::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << "Profile [" << s.name << "]: wall " << std::fixed << std::setprecision(3) << wall << " ms, "
+       << s.threads.size() << "/" << s.num_threads << " threads active" << std::endl;
+    os << "  tid   chunks      points  failures   busy(ms)   init(ms) extract(ms)   idle(ms)" << std::endl;
+
+    double total_busy = 0.0, max_busy = 0.0;
+    for (const auto &t : s.threads)
+    {
+        const double busy = t->busy_ns * 1e-6;
+        total_busy += busy;
+        max_busy = std::max(max_busy, busy);
+        os << std::setw(5) << t->index << std::setw(9) << t->chunks << std::setw(12) << t->points
+           << std::setw(10) << t->failures << std::setprecision(3)
+           << std::setw(11) << busy
+           << std::setw(11) << t->phase_ns[PROFILE_INIT] * 1e-6
+           << std::setw(12) << t->phase_ns[PROFILE_EXTRACT] * 1e-6
+           << std::setw(11) << std::max(wall - busy, 0.0) << std::endl;
+    }
+
+    // 未参与的线程按忙碌时间0计入：max/mean 衡量最慢线程拖长了多少，空闲率衡量线程时间的浪费
+    const double mean_busy = total_busy / slots;
+    const double idle_ratio = wall > 0.0 ? std::max(1.0 - total_busy / (wall * slots), 0.0) : 0.0;
+    os << "  load imbalance (max/mean busy): " << std::setprecision(3) << (mean_busy > 0.0 ? max_busy / mean_busy : 1.0)
+       << ", idle: " << std::setprecision(1) << idle_ratio * 100.0 << "% of " << slots << " x wall" << std::endl;
+    os.flags(flags);
+    os.precision(precision);
+}
+
+bool ProjectionProfiler::export_chrome_trace(const std::string &path) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ofstream out(path);
+    if (!out)
+    {
+        std::cerr << "Failed to write trace file: " << path << std::endl;
+        return false;
+    }
+    const int64_t origin = sessions_.empty() ? 0 : sessions_.front()->begin;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&]() {
+        if (!first)
+            out << ",";
+        out << "\n";
+        first = false;
+    };
+    for (size_t k = 0; k < sessions_.size(); ++k)
+    {
+        const Session &s = *sessions_[k];
+        const int pid = static_cast<int>(k) + 1;
+        separator();
+        out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"args\":{\"name\":";
+        write_json_string(out, s.name);
+        out << "}}";
+        for (const auto &t : s.threads)
+        {
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << t->index
+                << ",\"args\":{\"name\":\"worker " << t->index << "\"}}";
+            for (const ThreadProfile::Event &e : t->events)
+            {
+                separator();
+                out << "{\"name\":\"chunk\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << t->index
+                    << ",\"ts\":" << (e.begin - origin) * 1e-3 << ",\"dur\":" << (e.end - e.begin) * 1e-3
+                    << ",\"args\":{\"points\":" << e.points << "}}";
+            }
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+void ProjectionProfiler::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    sessions_.clear();
+    active_ = nullptr;
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+ProfileChunkScope::ProfileChunkScope()
+    : profile_(ProjectionProfiler::instance().local())
+{
+    if (profile_ && profile_->depth++ == 0)
+    {
+        begin_ = ProjectionProfiler::now();
+        points_ = profile_->points;
+    }
+}
+
+ProfileChunkScope::~ProfileChunkScope()
+{
+    if (!profile_ || --profile_->depth != 0)
+        return;
+    const int64_t end = ProjectionProfiler::now();
+    ++profile_->chunks;
+    profile_->busy_ns += end - begin_;
+    profile_->events.push_back({begin_, end, profile_->points - points_});
+}
+
+ProfilePhaseScope::ProfilePhaseScope(ProfilePhase phase)
+    : profile_(ProjectionProfiler::instance().local()), phase_(phase)
+{
+    if (profile_)
+        begin_ = ProjectionProfiler::now();
+}
+
+ProfilePhaseScope::~ProfilePhaseScope()
+{
+    if (profile_)
+        profile_->phase_ns[phase_] += ProjectionProfiler::now() - begin_;
+}
+
+#endif
@@ -0,0 +1,146 @@
+#pragma once
+
+// 投影热路径的可选插桩：每线程计数（块数、点数、NbPoints()==0 失败数）、
+// Init 与结果提取耗时、空闲时间，输出负载不均衡报告和 Chrome/Perfetto trace JSON。
+// 只在定义 PROJECTION_PROFILE 时编译（CMake 选项 DEMO_OCCT_PROFILE），
+// 否则所有 PROJ_PROFILE_* 宏展开为空语句，没有任何运行时开销。
+
+#ifdef PROJECTION_PROFILE
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 逐点计时的阶段
+enum ProfilePhase
+{
+    PROFILE_INIT = 0, // GeomAPI_ProjectPointOnSurf::Init
+    PROFILE_EXTRACT,  // NearestPoint / LowerDistanceParameters / LowerDistance
+    PROFILE_PHASE_COUNT
+};
+
+// 一个线程在一次会话中的计数（独占缓存行，只由所属线程写入）
+struct alignas(64) ThreadProfile
+{
+    struct Event
+    {
+        int64_t begin, end; // 纳秒，相对 ProjectionProfiler::now() 的时钟
+        uint64_t points;
+    };
+
+    int index = 0;         // 本会话内的注册顺序，即 trace 中的 tid
+    int depth = 0;         // 块作用域嵌套深度，只记录最外层
+    uint64_t chunks = 0;
+    uint64_t points = 0;
+    uint64_t failures = 0;
+    int64_t busy_ns = 0;   // 处于块作用域内的时间
+    int64_t phase_ns[PROFILE_PHASE_COUNT] = {};
+    std::vector<Event> events;
+};
+
+// 会话 = 一次并行投影运行（如某个后端的一次批量投影）
+// begin_session/end_session 由调用者在并行区之外配对调用；各线程在首次进入插桩点时自动注册
+class ProjectionProfiler
+{
+public:
+    static ProjectionProfiler &instance();
+    static int64_t now(); // 单调时钟，纳秒
+
+    void begin_session(const std::string &name, int num_threads);
+    void end_session();
+
+    // 当前线程在活动会话中的计数，没有活动会话时返回 nullptr
+    ThreadProfile *local();
+
+    // 最近一次会话的每线程统计和负载不均衡指标
+    void report(std::ostream &os) const;
+    // 所有会话写成 Chrome trace（chrome://tracing 或 ui.perfetto.dev 打开），每个会话一个 pid
+    bool export_chrome_trace(const std::string &path) const;
+    void clear();
+
+private:
+    struct Session
+    {
+        std::string name;
+        int num_threads = 1;
+        int64_t begin = 0, end = 0;
+        std::vector<std::unique_ptr<ThreadProfile>> threads;
+    };
+
+    ProjectionProfiler() = default;
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Session>> sessions_;
+    Session *active_ = nullptr;              // 受 mutex_ 保护
+    std::atomic<uint64_t> generation_{1};    // 会话开始/结束时递增，使各线程的缓存指针失效
+};
+
+// 块作用域：一次 project_range 或一个线程的循环分片
+class ProfileChunkScope
+{
+public:
+    ProfileChunkScope();
+    ~ProfileChunkScope();
+    ProfileChunkScope(const ProfileChunkScope &) = delete;
+    ProfileChunkScope &operator=(const ProfileChunkScope &) = delete;
+
+private:
+    ThreadProfile *profile_;
+    int64_t begin_ = 0;
+    uint64_t points_ = 0;
+};
+
+// 阶段作用域：累计到当前线程的 phase_ns
+class ProfilePhaseScope
+{
+public:
+    explicit ProfilePhaseScope(ProfilePhase phase);
+    ~ProfilePhaseScope();
+    ProfilePhaseScope(const ProfilePhaseScope &) = delete;
+    ProfilePhaseScope &operator=(const ProfilePhaseScope &) = delete;
+
+private:
+    ThreadProfile *profile_;
+    ProfilePhase phase_;
+    int64_t begin_ = 0;
+};
+
+inline void profile_add_points(uint64_t n)
+{
+    if (ThreadProfile *p = ProjectionProfiler::instance().local())
+        p->points += n;
+}
+
+inline void profile_add_failure()
+{
+    if (ThreadProfile *p = ProjectionProfiler::instance().local())
+        ++p->failures;
+}
+
+#define PROJ_PROFILE_CAT_(a, b) a##b
+#define PROJ_PROFILE_CAT(a, b) PROJ_PROFILE_CAT_(a, b)
+#define PROJ_PROFILE_CHUNK() ProfileChunkScope PROJ_PROFILE_CAT(proj_profile_chunk_, __LINE__)
+#define PROJ_PROFILE_PHASE(phase) ProfilePhaseScope PROJ_PROFILE_CAT(proj_profile_phase_, __LINE__)(phase)
+#define PROJ_PROFILE_POINTS(n) profile_add_points(n)
+#define PROJ_PROFILE_FAILURE() profile_add_failure()
+#define PROJ_PROFILE_SESSION_BEGIN(name, threads) ProjectionProfiler::instance().begin_session(name, threads)
+#define PROJ_PROFILE_SESSION_END() ProjectionProfiler::instance().end_session()
+#define PROJ_PROFILE_REPORT(os) ProjectionProfiler::instance().report(os)
+#define PROJ_PROFILE_EXPORT(path) ProjectionProfiler::instance().export_chrome_trace(path)
+
+#else
+
+#define PROJ_PROFILE_CHUNK() ((void)0)
+#define PROJ_PROFILE_PHASE(phase) ((void)0)
+#define PROJ_PROFILE_POINTS(n) ((void)0)
+#define PROJ_PROFILE_FAILURE() ((void)0)
+#define PROJ_PROFILE_SESSION_BEGIN(name, threads) ((void)0)
+#define PROJ_PROFILE_SESSION_END() ((void)0)
+#define PROJ_PROFILE_REPORT(os) ((void)0)
+#define PROJ_PROFILE_EXPORT(path) ((void)0)
+
+#endif
@@ -0,0 +1,569 @@
+#include "projection_service.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <afunix.h>
+#else
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+static_assert(sizeof(ServiceRequestHeader) == 24, "request header layout");
+static_assert(sizeof(ServiceResponseHeader) == 32, "response header layout");
+
+namespace
+{
+#ifdef _WIN32
+    using socket_handle = SOCKET;
+    const socket_handle NO_SOCKET = INVALID_SOCKET;
+
+    // Windows 10 1803 起 Winsock 支持 AF_UNIX
+    bool socket_startup()
+    {
+        static const bool started = [] {
+            WSADATA data;
+            return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }();
+        return started;
+    }
+
+    void close_socket(socket_handle s)
+    {
+        closesocket(s);
+    }
+
+    void shutdown_socket(socket_handle s)
+    {
+        shutdown(s, SD_BOTH);
+    }
+#else
+    using socket_handle = int;
+    const socket_handle NO_SOCKET = -1;
+
+    bool socket_startup()
+    {
+        return true;
+    }
+
+    void close_socket(socket_handle s)
+    {
+        ::close(s);
+    }
+
+    void shutdown_socket(socket_handle s)
+    {
+        shutdown(s, SHUT_RDWR);
+    }
+#endif
+
+    const size_t SERVICE_GRAIN_SIZE = 64; // 与BRep批量投影相同的划分粒度
+    const size_t MAX_IO_CHUNK = 1 << 30;  // 单次 send/recv 的字节数上限（Windows 的长度参数是 int）
+
+    bool make_address(const std::string &path, sockaddr_un &address)
+    {
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path))
+        {
+            std::cerr << "Invalid socket path: " << path << std::endl;
+            return false;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size());
+        return true;
+    }
+
+    bool read_exact(socket_handle s, void *data, size_t size)
+    {
+        char *p = static_cast<char *>(data);
+        while (size > 0)
+        {
+            const int n = static_cast<int>(recv(s, p, static_cast<int>(std::min(size, MAX_IO_CHUNK)), 0));
+            if (n <= 0)
+            {
+#ifndef _WIN32
+                if (n < 0 && errno == EINTR)
+                    continue;
+#endif
+                return false;
+            }
+            p += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool write_all(socket_handle s, const void *data, size_t size)
+    {
+#ifdef MSG_NOSIGNAL
+        const int flags = MSG_NOSIGNAL; // 对端已关闭时返回错误而不是触发 SIGPIPE
+#else
+        const int flags = 0;
+#endif
+        const char *p = static_cast<const char *>(data);
+        while (size > 0)
+        {
+            const int n = static_cast<int>(::send(s, p, static_cast<int>(std::min(size, MAX_IO_CHUNK)), flags));
+            if (n <= 0)
+            {
+#ifndef _WIN32
+                if (n < 0 && errno == EINTR)
+                    continue;
+#endif
+                return false;
+            }
+            p += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // 连接上在途的一个请求（缓冲按连接复用，只在请求变大时增长）
+    struct ServiceBatch
+    {
+        ServiceRequestHeader request;
+        ServiceStatus status = SERVICE_OK;
+        bool projected = false; // 投影已完成，可以写回（由 ServiceQueue::mutex 保护）
+        size_t count = 0;
+        PointArrays input;
+        ProjectionResultArrays output;
+        std::vector<int> element;
+        std::vector<unsigned char> type;
+
+        void resize(size_t n)
+        {
+            count = n;
+            input.x.resize(n);
+            input.y.resize(n);
+            input.z.resize(n);
+            output.resize(n);
+            element.resize(n);
+            type.resize(n);
+        }
+    };
+
+    // 一个连接的在途请求：读线程把读入的请求按顺序放进 pending 并提交投影，
+    // 写线程按同样的顺序等待投影完成后写回，再把缓冲还给 free
+    struct ServiceQueue
+    {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<ServiceBatch *> pending;
+        std::vector<ServiceBatch *> free;
+        bool reading_done = false;
+    };
+
+    bool write_response(socket_handle s, const ServiceBatch &batch)
+    {
+        const ServiceResponseHeader header = {SERVICE_RESPONSE_MAGIC, SERVICE_PROTOCOL_VERSION, batch.request.id,
+                                              batch.count, static_cast<uint32_t>(batch.status), 0};
+        const size_t n = batch.count;
+        const ProjectionResultArrays &r = batch.output;
+        if (!write_all(s, &header, sizeof(header)))
+            return false;
+        if (n == 0)
+            return true;
+        return write_all(s, r.x.data(), n * sizeof(double)) && write_all(s, r.y.data(), n * sizeof(double)) &&
+               write_all(s, r.z.data(), n * sizeof(double)) && write_all(s, r.u.data(), n * sizeof(double)) &&
+               write_all(s, r.v.data(), n * sizeof(double)) && write_all(s, r.distance.data(), n * sizeof(double)) &&
+               write_all(s, r.status.data(), n) && write_all(s, batch.type.data(), n) &&
+               write_all(s, batch.element.data(), n * sizeof(int));
+    }
+}
+
+struct ProjectionService::Impl
+{
+    struct Connection
+    {
+        socket_handle socket = NO_SOCKET;
+        std::thread thread;
+        std::atomic<bool> done{false};
+    };
+
+    Impl(const BRepProjector &p, const ServiceOptions &o)
+        : projector(p), options(o), arena(std::max(o.num_threads, 1), 0)
+    {
+        arena.initialize();
+    }
+
+    void serve(Connection &connection);
+    void project(ServiceBatch &batch);
+
+    const BRepProjector &projector;
+    ServiceOptions options;
+    tbb::task_arena arena;                                         // 常驻线程池，所有连接共用；只运行投影，不做套接字读写
+    tbb::enumerable_thread_specific<BRepProjectionWorkspace> workspaces; // 跨请求保留的线程私有工作区
+    socket_handle listener = NO_SOCKET;
+    std::string socket_path;
+    std::atomic<bool> stopping{false};
+    std::mutex mutex;                                              // 保护 connections
+    std::list<std::unique_ptr<Connection>> connections;
+    std::atomic<uint64_t> nb_connections{0}, nb_requests{0}, nb_points{0};
+};
+
+void ProjectionService::Impl::project(ServiceBatch &batch)
+{
+    const PointBatch input = batch.input.batch();
+    const ProjectionBuffers output = batch.output.buffers();
+    BRepElementBuffers elements;
+    elements.element = batch.element.data();
+    elements.type = batch.type.data();
+    // 在 arena 的任务中运行（由 enqueue 提交），嵌套的 parallel_for 使用同一个线程池
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, batch.count, SERVICE_GRAIN_SIZE), [&](const tbb::blocked_range<size_t> &r) {
+        projector.project_range(input, output, elements, r.begin(), r.end(), workspaces.local());
+    });
+}
+
+void ProjectionService::Impl::serve(Connection &connection)
+{
+    // 阻塞的套接字读写只在本连接的读线程（当前线程）和写线程中进行，arena 的工作线程只做投影，
+    // 空闲的长连接不会占住线程池
+    const socket_handle s = connection.socket;
+    const size_t live = std::max<size_t>(options.max_in_flight, 1);
+    std::vector<std::unique_ptr<ServiceBatch>> batches(live);
+    ServiceQueue queue;
+    for (auto &batch : batches)
+    {
+        batch.reset(new ServiceBatch);
+        queue.free.push_back(batch.get());
+    }
+    std::atomic<bool> closing(false); // 写回失败后不再读取新请求、不再写回
+
+    std::thread writer([&] {
+        for (;;)
+        {
+            ServiceBatch *batch = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(queue.mutex);
+                queue.changed.wait(lock, [&] {
+                    return queue.pending.empty() ? queue.reading_done : queue.pending.front()->projected;
+                });
+                if (queue.pending.empty())
+                    return;
+                batch = queue.pending.front();
+                queue.pending.pop_front();
+            }
+            if (!closing)
+            {
+                if (!write_response(s, *batch))
+                {
+                    closing = true;
+                    shutdown_socket(s); // 唤醒阻塞在 recv 中的读线程；套接字仍由本连接持有
+                }
+                else if (batch->status == SERVICE_OK)
+                {
+                    ++nb_requests;
+                    nb_points += batch->count;
+                }
+            }
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.free.push_back(batch);
+            queue.changed.notify_all();
+        }
+    });
+
+    for (;;)
+    {
+        ServiceBatch *batch = nullptr;
+        {
+            // 在途请求数达到 max_in_flight 时等写线程归还缓冲，不再读入
+            std::unique_lock<std::mutex> lock(queue.mutex);
+            queue.changed.wait(lock, [&] { return !queue.free.empty(); });
+            batch = queue.free.back();
+            queue.free.pop_back();
+        }
+        ServiceRequestHeader header;
+        bool ok = !closing && read_exact(s, &header, sizeof(header));
+        bool last = !ok;
+        if (ok)
+        {
+            batch->request = header;
+            batch->status = SERVICE_OK;
+            if (header.magic != SERVICE_REQUEST_MAGIC || header.version != SERVICE_PROTOCOL_VERSION)
+                batch->status = SERVICE_BAD_REQUEST;
+            else if (header.count > options.max_batch_points)
+                batch->status = SERVICE_TOO_LARGE;
+            if (batch->status != SERVICE_OK)
+            {
+                // 后面的字节无法再按请求解析，回复错误后断开
+                batch->count = 0;
+                last = true;
+            }
+            else
+            {
+                const size_t n = static_cast<size_t>(header.count);
+                batch->resize(n);
+                ok = read_exact(s, batch->input.x.data(), n * sizeof(double)) &&
+                     read_exact(s, batch->input.y.data(), n * sizeof(double)) &&
+                     read_exact(s, batch->input.z.data(), n * sizeof(double));
+                last = !ok;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!ok)
+        {
+            queue.free.push_back(batch);
+            break;
+        }
+        batch->projected = batch->status != SERVICE_OK;
+        queue.pending.push_back(batch);
+        if (!batch->projected)
+        {
+            arena.enqueue([this, batch, &queue] {
+                project(*batch);
+                // 在锁内通知：写线程看到完成后本连接可能立即结束，queue 随之销毁
+                std::lock_guard<std::mutex> done_lock(queue.mutex);
+                batch->projected = true;
+                queue.changed.notify_all();
+            });
+        }
+        queue.changed.notify_all();
+        if (last)
+            break;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.reading_done = true;
+        queue.changed.notify_all();
+    }
+    writer.join(); // 写线程只在全部在途请求写回（或丢弃）后退出，之后不再有投影任务引用本连接的缓冲
+}
+
+ProjectionService::ProjectionService(const BRepProjector &projector, const ServiceOptions &options)
+    : impl_(new Impl(projector, options))
+{
+    static_assert(sizeof(int) == 4, "element indices are sent as int32");
+}
+
+ProjectionService::~ProjectionService()
+{
+    stop();
+    if (impl_->listener != NO_SOCKET)
+    {
+        close_socket(impl_->listener);
+        std::remove(impl_->socket_path.c_str());
+    }
+}
+
+bool ProjectionService::listen(const std::string &socket_path)
+{
+    sockaddr_un address;
+    if (!socket_startup() || !make_address(socket_path, address))
+        return false;
+    std::remove(socket_path.c_str()); // 上次异常退出留下的套接字文件
+    const socket_handle s = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s == NO_SOCKET)
+    {
+        std::cerr << "Failed to create socket" << std::endl;
+        return false;
+    }
+    if (bind(s, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 || ::listen(s, SOMAXCONN) != 0)
+    {
+        std::cerr << "Failed to listen on " << socket_path << std::endl;
+        close_socket(s);
+        return false;
+    }
+    impl_->listener = s;
+    impl_->socket_path = socket_path;
+    return true;
+}
+
+void ProjectionService::run()
+{
+    Impl &impl = *impl_;
+    while (!impl.stopping && impl.listener != NO_SOCKET)
+    {
+        const socket_handle s = accept(impl.listener, nullptr, nullptr);
+        if (s == NO_SOCKET)
+        {
+            if (impl.stopping)
+                break;
+#ifndef _WIN32
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+#endif
+            std::cerr << "Failed to accept connection on " << impl.socket_path << std::endl;
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(impl.mutex);
+        if (impl.stopping)
+        {
+            close_socket(s);
+            break;
+        }
+        // 回收已结束的连接线程
+        for (auto it = impl.connections.begin(); it != impl.connections.end();)
+        {
+            if ((*it)->done)
+            {
+                (*it)->thread.join();
+                it = impl.connections.erase(it);
+            }
+            else
+                ++it;
+        }
+        impl.connections.emplace_back(new Impl::Connection);
+        Impl::Connection &connection = *impl.connections.back();
+        connection.socket = s;
+        ++impl.nb_connections;
+        connection.thread = std::thread([&impl, &connection] {
+            impl.serve(connection);
+            // 与 stop() 互斥：关闭后的句柄可能被复用，不能再对它 shutdown
+            std::lock_guard<std::mutex> lock(impl.mutex);
+            close_socket(connection.socket);
+            connection.done = true;
+        });
+    }
+
+    // 等待所有连接结束（stop() 已经断开它们）
+    std::list<std::unique_ptr<Impl::Connection>> remaining;
+    {
+        std::lock_guard<std::mutex> lock(impl.mutex);
+        remaining.swap(impl.connections);
+    }
+    for (auto &connection : remaining)
+        connection->thread.join();
+}
+
+void ProjectionService::stop()
+{
+    Impl &impl = *impl_;
+    std::lock_guard<std::mutex> lock(impl.mutex);
+    if (impl.stopping.exchange(true))
+        return;
+    // 关闭读写使阻塞中的 accept/recv 返回；套接字本身由各自的所有者关闭
+    if (impl.listener != NO_SOCKET)
+    {
+        shutdown_socket(impl.listener);
+#ifdef _WIN32
+        close_socket(impl.listener); // Winsock 的 accept 只在套接字关闭时返回
+        impl.listener = NO_SOCKET;
+        std::remove(impl.socket_path.c_str());
+#endif
+    }
+    for (auto &connection : impl.connections)
+    {
+        if (!connection->done)
+            shutdown_socket(connection->socket);
+    }
+}
+
+ServiceStats ProjectionService::stats() const
+{
+    ServiceStats stats;
+    stats.connections = impl_->nb_connections;
+    stats.requests = impl_->nb_requests;
+    stats.points = impl_->nb_points;
+    return stats;
+}
+
+ProjectionClient::~ProjectionClient()
+{
+    close();
+}
+
+bool ProjectionClient::connect(const std::string &socket_path)
+{
+    close();
+    sockaddr_un address;
+    if (!socket_startup() || !make_address(socket_path, address))
+        return false;
+    const socket_handle s = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s == NO_SOCKET)
+    {
+        std::cerr << "Failed to create socket" << std::endl;
+        return false;
+    }
+    if (::connect(s, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        std::cerr << "Failed to connect to " << socket_path << std::endl;
+        close_socket(s);
+        return false;
+    }
+    socket_ = s;
+    return true;
+}
+
+void ProjectionClient::close()
+{
+    if (is_open())
+        close_socket(static_cast<socket_handle>(socket_));
+    socket_ = NO_SOCKET;
+}
+
+bool ProjectionClient::is_open() const
+{
+    return static_cast<socket_handle>(socket_) != NO_SOCKET;
+}
+
+bool ProjectionClient::send(const PointBatch &input, uint64_t id)
+{
+    if (!is_open())
+        return false;
+    const socket_handle s = static_cast<socket_handle>(socket_);
+    const ServiceRequestHeader header = {SERVICE_REQUEST_MAGIC, SERVICE_PROTOCOL_VERSION, id, input.count};
+    const size_t bytes = input.count * sizeof(double);
+    return write_all(s, &header, sizeof(header)) && write_all(s, input.x, bytes) && write_all(s, input.y, bytes) &&
+           write_all(s, input.z, bytes);
+}
+
+bool ProjectionClient::receive(uint64_t &id, ProjectionResultArrays &results, std::vector<int> *element,
+                               std::vector<unsigned char> *type, ServiceStatus *status)
+{
+    if (!is_open())
+        return false;
+    const socket_handle s = static_cast<socket_handle>(socket_);
+    ServiceResponseHeader header;
+    if (!read_exact(s, &header, sizeof(header)) || header.magic != SERVICE_RESPONSE_MAGIC)
+        return false;
+    id = header.id;
+    if (status)
+        *status = static_cast<ServiceStatus>(header.status);
+    if (header.status != SERVICE_OK)
+        return false;
+
+    const size_t n = static_cast<size_t>(header.count);
+    results.resize(n);
+    std::vector<int> element_scratch;
+    std::vector<unsigned char> type_scratch;
+    std::vector<int> &e = element ? *element : element_scratch;
+    std::vector<unsigned char> &t = type ? *type : type_scratch;
+    e.resize(n);
+    t.resize(n);
+    return read_exact(s, results.x.data(), n * sizeof(double)) && read_exact(s, results.y.data(), n * sizeof(double)) &&
+           read_exact(s, results.z.data(), n * sizeof(double)) && read_exact(s, results.u.data(), n * sizeof(double)) &&
+           read_exact(s, results.v.data(), n * sizeof(double)) &&
+           read_exact(s, results.distance.data(), n * sizeof(double)) && read_exact(s, results.status.data(), n) &&
+           read_exact(s, t.data(), n) && read_exact(s, e.data(), n * sizeof(int));
+}
+
+bool ProjectionClient::project(const PointBatch &input, ProjectionResultArrays &results, std::vector<int> *element,
+                               std::vector<unsigned char> *type)
+{
+    const uint64_t id = next_id_++;
+    uint64_t received = 0;
+    return send(input, id) && receive(received, results, element, type) && received == id;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "batch_projection.h"
+#include "brep_projection.h"
+
+// 本地投影服务的二进制协议（Unix域套接字，只在本机通信，按主机字节序）
+// 请求：ServiceRequestHeader + x[count] + y[count] + z[count]（double）
+// 响应：ServiceResponseHeader + x, y, z, u, v, distance 各 count 个 double
+//       + status[count]（ProjectionStatus） + type[count]（BRepElementType） + element[count]（int32）
+// 同一连接上可以连续发送多个请求而不等待响应，响应按请求顺序返回
+const uint32_t SERVICE_REQUEST_MAGIC = 0x5152504f;  // "OPRQ"
+const uint32_t SERVICE_RESPONSE_MAGIC = 0x5352504f; // "OPRS"
+const uint32_t SERVICE_PROTOCOL_VERSION = 1;
+
+struct ServiceRequestHeader
+{
+    uint32_t magic;   // SERVICE_REQUEST_MAGIC
+    uint32_t version; // SERVICE_PROTOCOL_VERSION
+    uint64_t id;      // 客户端自定的请求编号，原样返回
+    uint64_t count;   // 点数
+};
+
+// 响应状态；非 SERVICE_OK 时响应不带数据，服务端随后关闭连接
+enum ServiceStatus : uint32_t
+{
+    SERVICE_OK = 0,
+    SERVICE_BAD_REQUEST = 1, // 魔数或版本不符
+    SERVICE_TOO_LARGE = 2    // 点数超过 ServiceOptions::max_batch_points
+};
+
+struct ServiceResponseHeader
+{
+    uint32_t magic;   // SERVICE_RESPONSE_MAGIC
+    uint32_t version;
+    uint64_t id;
+    uint64_t count;
+    uint32_t status;  // ServiceStatus
+    uint32_t reserved;
+};
+
+struct ServiceOptions
+{
+    int num_threads = 1;                // 常驻线程池（task_arena）的并发度，所有连接共用
+    size_t max_in_flight = 4;           // 每个连接同时在途的请求数（读取/投影/写回重叠）
+    size_t max_batch_points = 1 << 24;  // 单个请求的点数上限
+};
+
+struct ServiceStats
+{
+    uint64_t connections = 0;
+    uint64_t requests = 0;
+    uint64_t points = 0;
+};
+
+// 常驻投影服务：模型只加载、预处理一次，线程池和各线程的投影工作区在请求之间保持
+// - 每个连接一个读线程和一个写线程做阻塞的套接字读写，只有投影提交到共享的 task_arena，
+//   读取、投影、写回重叠进行，响应按请求顺序写回；空闲连接不占用线程池
+// - 请求直接读进投影用的SoA缓冲，结果直接从结果缓冲写回，缓冲按连接复用
+// - 单个请求内部再按点并行，大批量请求也能用满线程池
+// projector 须比服务活得久
+class ProjectionService
+{
+public:
+    ProjectionService(const BRepProjector &projector, const ServiceOptions &options = ServiceOptions());
+    ~ProjectionService();
+    ProjectionService(const ProjectionService &) = delete;
+    ProjectionService &operator=(const ProjectionService &) = delete;
+
+    // 在 socket_path 上监听；同名的残留套接字文件先删除
+    bool listen(const std::string &socket_path);
+    // 接受并服务连接，直到 stop() 被调用（阻塞）；返回前等待所有连接结束
+    void run();
+    // 停止接受连接并断开现有连接，可从其它线程调用（不可在信号处理函数中调用）
+    void stop();
+
+    ServiceStats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// 投影服务客户端；发送和接收互不依赖，可以先连续 send 再按顺序 receive
+// 未完成的请求较多时发送和接收应放在不同线程，否则双方的套接字缓冲写满后会互相等待
+class ProjectionClient
+{
+public:
+    ProjectionClient() = default;
+    ~ProjectionClient();
+    ProjectionClient(const ProjectionClient &) = delete;
+    ProjectionClient &operator=(const ProjectionClient &) = delete;
+
+    bool connect(const std::string &socket_path);
+    void close();
+    bool is_open() const;
+
+    // 发送一个请求（不等待响应）
+    bool send(const PointBatch &input, uint64_t id);
+    // 接收下一个响应，results 和 element/type（可为空）调整为响应点数；
+    // 连接断开或服务端返回错误时返回false，status 非空时返回服务端状态
+    bool receive(uint64_t &id, ProjectionResultArrays &results, std::vector<int> *element = nullptr,
+                 std::vector<unsigned char> *type = nullptr, ServiceStatus *status = nullptr);
+    // 发送并等待响应
+    bool project(const PointBatch &input, ProjectionResultArrays &results, std::vector<int> *element = nullptr,
+                 std::vector<unsigned char> *type = nullptr);
+
+private:
+#ifdef _WIN32
+    uintptr_t socket_ = ~static_cast<uintptr_t>(0); // SOCKET
+#else
+    int socket_ = -1;
+#endif
+    uint64_t next_id_ = 0;
+};
@@ -0,0 +1,318 @@
+#include "schedule_tuner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "seed_cache.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/partitioner.h>
+#include <tbb/task_arena.h>
+#include <tbb/enumerable_thread_specific.h>
+
+namespace
+{
+    const char *const KIND_NAMES[] = {"omp_static", "omp_dynamic", "omp_guided", "tbb_simple", "tbb_auto", "tbb_affinity"};
+    const char *const CACHE_HEADER = "# OCCT projection schedule cache v1";
+
+    bool is_openmp_kind(ScheduleKind kind)
+    {
+        return kind == SCHEDULE_OMP_STATIC || kind == SCHEDULE_OMP_DYNAMIC || kind == SCHEDULE_OMP_GUIDED;
+    }
+
+    int available_families(int families)
+    {
+#ifndef _OPENMP
+        families &= ~FAMILY_OPENMP;
+#endif
+        return families;
+    }
+
+    // 等间隔抽取最多 count 个点（覆盖整个输入，而不是只取开头一段）
+    PointArrays sample_points(const PointBatch &input, size_t count)
+    {
+        PointArrays sample;
+        const size_t n = std::min(count, input.count);
+        sample.reserve(n);
+        for (size_t k = 0; k < n; ++k)
+        {
+            const size_t i = k * input.count / n;
+            sample.x.push_back(input.x[i]);
+            sample.y.push_back(input.y[i]);
+            sample.z.push_back(input.z[i]);
+        }
+        return sample;
+    }
+
+    // 最短耗时：先跑一次（affinity 分区器在这次记录映射），再计时 repeats 次
+    double time_schedule(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output,
+                         const ScheduleConfig &config, int num_threads, int repeats)
+    {
+        ScheduledBatch batch(config);
+        batch.run(projector, input, output, num_threads);
+        double best = 0.0;
+        for (int r = 0; r < std::max(repeats, 1); ++r)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            batch.run(projector, input, output, num_threads);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            best = r == 0 ? seconds : std::min(best, seconds);
+        }
+        return best;
+    }
+}
+
+const char *schedule_kind_name(ScheduleKind kind)
+{
+    return kind >= SCHEDULE_OMP_STATIC && kind <= SCHEDULE_TBB_AFFINITY ? KIND_NAMES[kind] : "unknown";
+}
+
+bool parse_schedule_kind(const std::string &name, ScheduleKind &kind)
+{
+    for (int k = SCHEDULE_OMP_STATIC; k <= SCHEDULE_TBB_AFFINITY; ++k)
+    {
+        if (name == KIND_NAMES[k])
+        {
+            kind = static_cast<ScheduleKind>(k);
+            return true;
+        }
+    }
+    return false;
+}
+
+struct ScheduledBatch::AffinityState
+{
+    tbb::affinity_partitioner partitioner;
+};
+
+ScheduledBatch::ScheduledBatch(const ScheduleConfig &config) : config_(config)
+{
+    config_.grain = std::max<size_t>(config_.grain, 1);
+    if (config_.kind == SCHEDULE_TBB_AFFINITY)
+        affinity_.reset(new AffinityState());
+}
+
+ScheduledBatch::~ScheduledBatch() = default;
+
+void ScheduledBatch::run(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output, int num_threads)
+{
+    const size_t num_points = input.count;
+    const size_t grain = config_.grain;
+    const bool reuse = config_.reuse_workspace;
+
+    if (is_openmp_kind(config_.kind))
+    {
+#ifdef _OPENMP
+        const long long num_blocks = static_cast<long long>((num_points + grain - 1) / grain);
+        const omp_sched_t kind = config_.kind == SCHEDULE_OMP_DYNAMIC ? omp_sched_dynamic
+                                 : config_.kind == SCHEDULE_OMP_GUIDED ? omp_sched_guided
+                                                                       : omp_sched_static;
+        omp_set_num_threads(num_threads);
+        omp_set_schedule(kind, 1); // 分配单位是一个 grain 大小的块
+#pragma omp parallel
+        {
+            std::unique_ptr<ProjectionWorkspace> thread_workspace;
+            if (reuse)
+                thread_workspace.reset(new ProjectionWorkspace());
+#pragma omp for schedule(runtime)
+            for (long long b = 0; b < num_blocks; ++b)
+            {
+                const size_t begin = static_cast<size_t>(b) * grain;
+                const size_t end = std::min(begin + grain, num_points);
+                if (reuse)
+                    projector.project_range(input, output, begin, end, *thread_workspace);
+                else
+                {
+                    ProjectionWorkspace workspace;
+                    projector.project_range(input, output, begin, end, workspace);
+                }
+            }
+        }
+#else
+        std::cerr << "OpenMP not enabled!" << std::endl;
+#endif
+        return;
+    }
+
+    tbb::enumerable_thread_specific<ProjectionWorkspace> ets_workspace;
+    const auto body = [&](const tbb::blocked_range<size_t> &r) {
+        if (reuse)
+            projector.project_range(input, output, r.begin(), r.end(), ets_workspace.local());
+        else
+        {
+            ProjectionWorkspace workspace;
+            projector.project_range(input, output, r.begin(), r.end(), workspace);
+        }
+    };
+    const tbb::blocked_range<size_t> range(0, num_points, grain);
+    tbb::task_arena arena(num_threads);
+    arena.execute([&] {
+        if (config_.kind == SCHEDULE_TBB_SIMPLE)
+            tbb::parallel_for(range, body, tbb::simple_partitioner());
+        else if (config_.kind == SCHEDULE_TBB_AFFINITY)
+            tbb::parallel_for(range, body, affinity_->partitioner);
+        else
+            tbb::parallel_for(range, body, tbb::auto_partitioner());
+    });
+}
+
+void project_batch_scheduled(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output,
+                             const ScheduleConfig &config, int num_threads)
+{
+    ScheduledBatch(config).run(projector, input, output, num_threads);
+}
+
+uint64_t schedule_signature(const BatchProjector &projector)
+{
+    // 同一几何走不同求解路径时每点代价差别很大，调度结论不能共用
+    uint64_t mode = 0;
+    if (projector.is_analytic())
+        mode = 1 + static_cast<uint64_t>(projector.analytic().type);
+    else if (projector.prepared())
+        mode = 16 + static_cast<uint64_t>(projector.prepared()->precision());
+    else
+        mode = 32;
+    uint64_t h = surface_fingerprint(projector);
+    h ^= mode + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    return h;
+}
+
+ScheduleConfig calibrate_schedule(const BatchProjector &projector, const PointBatch &input, int num_threads,
+                                  const TuneOptions &options, std::vector<ScheduleTrial> *trials)
+{
+    ScheduleConfig best;
+    const int families = available_families(options.families);
+    if (input.count == 0 || families == 0)
+        return best;
+
+    const PointArrays sample = sample_points(input, options.calibration_points);
+    const PointBatch sample_input = sample.batch();
+    ProjectionResultArrays scratch;
+    scratch.resize(sample.size());
+    const ProjectionBuffers output = scratch.buffers();
+
+    // 候选粒度：至少能分给每个线程一块，最小的粒度总是保留
+    std::vector<size_t> grains = options.grains;
+    std::sort(grains.begin(), grains.end());
+    grains.erase(std::unique(grains.begin(), grains.end()), grains.end());
+    grains.erase(std::remove(grains.begin(), grains.end(), size_t(0)), grains.end());
+    if (grains.empty())
+        grains.push_back(ANALYTIC_BLOCK_SIZE);
+    const size_t max_grain = std::max(sample.size() / static_cast<size_t>(std::max(num_threads, 1)), grains.front());
+
+    // 预热线程池、曲面求值缓存等，避免计入第一个候选
+    project_batch(projector, sample_input, output, (families & FAMILY_TBB) ? BACKEND_TBB : BACKEND_OPENMP, num_threads);
+
+    double best_seconds = -1.0;
+    const auto consider = [&](const ScheduleConfig &config) {
+        const double seconds = time_schedule(projector, sample_input, output, config, num_threads, options.repeats);
+        if (trials)
+            trials->push_back(ScheduleTrial{config, seconds});
+        if (best_seconds < 0.0 || seconds < best_seconds)
+        {
+            best_seconds = seconds;
+            best = config;
+        }
+    };
+
+    for (int k = SCHEDULE_OMP_STATIC; k <= SCHEDULE_TBB_AFFINITY; ++k)
+    {
+        const ScheduleKind kind = static_cast<ScheduleKind>(k);
+        if (!(families & (is_openmp_kind(kind) ? FAMILY_OPENMP : FAMILY_TBB)))
+            continue;
+        for (size_t grain : grains)
+        {
+            if (grain > max_grain)
+                break;
+            ScheduleConfig config;
+            config.kind = kind;
+            config.grain = grain;
+            config.reuse_workspace = true;
+            consider(config);
+        }
+    }
+
+    ScheduleConfig fresh = best;
+    fresh.reuse_workspace = false;
+    consider(fresh);
+    return best;
+}
+
+bool ScheduleTuner::load(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        // 签名(十六进制) 线程数 候选族 调度器 粒度 复用工作区 吞吐量
+        std::istringstream fields(line);
+        uint64_t signature;
+        int threads, families, reuse;
+        std::string kind_name;
+        Entry entry;
+        if (!(fields >> std::hex >> signature >> std::dec >> threads >> families >> kind_name >> entry.config.grain >> reuse >>
+              entry.points_per_second) ||
+            !parse_schedule_kind(kind_name, entry.config.kind) || entry.config.grain == 0)
+            continue;
+        entry.config.reuse_workspace = reuse != 0;
+        entries_[Key(signature, threads, families)] = entry;
+    }
+    return true;
+}
+
+bool ScheduleTuner::save(const std::string &path) const
+{
+    std::ofstream out(path);
+    if (!out)
+    {
+        std::cerr << "Failed to write schedule cache: " << path << std::endl;
+        return false;
+    }
+    out << CACHE_HEADER << '\n'
+        << "# signature threads families kind grain reuse_workspace points_per_second\n";
+    for (const auto &item : entries_)
+    {
+        const Entry &entry = item.second;
+        out << std::hex << std::get<0>(item.first) << std::dec << ' ' << std::get<1>(item.first) << ' '
+            << std::get<2>(item.first) << ' ' << schedule_kind_name(entry.config.kind) << ' ' << entry.config.grain << ' '
+            << (entry.config.reuse_workspace ? 1 : 0) << ' ' << entry.points_per_second << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+ScheduleConfig ScheduleTuner::select(const BatchProjector &projector, const PointBatch &input, int num_threads,
+                                     const TuneOptions &options, bool *cached)
+{
+    const Key key(schedule_signature(projector), num_threads, available_families(options.families));
+    const auto found = entries_.find(key);
+    if (cached)
+        *cached = found != entries_.end();
+    if (found != entries_.end())
+        return found->second.config;
+
+    std::vector<ScheduleTrial> trials;
+    Entry entry;
+    entry.config = calibrate_schedule(projector, input, num_threads, options, &trials);
+    const size_t sample = std::min(options.calibration_points, input.count);
+    for (const ScheduleTrial &trial : trials)
+    {
+        if (trial.config.kind == entry.config.kind && trial.config.grain == entry.config.grain &&
+            trial.config.reuse_workspace == entry.config.reuse_workspace && trial.seconds > 0.0)
+            entry.points_per_second = sample / trial.seconds;
+    }
+    if (input.count > 0)
+        entries_[key] = entry;
+    return entry.config;
+}
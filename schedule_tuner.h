@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "batch_projection.h"
+
+// 并行调度方式
+enum ScheduleKind
+{
+    SCHEDULE_OMP_STATIC = 0,
+    SCHEDULE_OMP_DYNAMIC,
+    SCHEDULE_OMP_GUIDED,
+    SCHEDULE_TBB_SIMPLE,
+    SCHEDULE_TBB_AUTO,
+    SCHEDULE_TBB_AFFINITY
+};
+
+const char *schedule_kind_name(ScheduleKind kind);
+bool parse_schedule_kind(const std::string &name, ScheduleKind &kind);
+
+// 一种批量投影调度：调度器、粒度（OpenMP为每块点数，TBB为blocked_range粒度）、工作区复用方式
+struct ScheduleConfig
+{
+    ScheduleKind kind = SCHEDULE_TBB_AUTO;
+    size_t grain = ANALYTIC_BLOCK_SIZE;
+    bool reuse_workspace = true; // true: 每线程一个工作区；false: 每块新建（不需要线程局部存储）
+};
+
+// 按给定调度执行批量投影；TBB affinity 分区器记录的块-线程映射保存在本对象中，
+// 反复投影同一批点（迭代求解）时复用同一个对象才有意义
+class ScheduledBatch
+{
+public:
+    explicit ScheduledBatch(const ScheduleConfig &config);
+    ~ScheduledBatch();
+
+    const ScheduleConfig &config() const { return config_; }
+    void run(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output, int num_threads);
+
+private:
+    struct AffinityState;
+
+    ScheduleConfig config_;
+    std::unique_ptr<AffinityState> affinity_;
+};
+
+// 一次性按给定调度投影
+void project_batch_scheduled(const BatchProjector &projector, const PointBatch &input, const ProjectionBuffers &output,
+                             const ScheduleConfig &config, int num_threads);
+
+// 候选调度族
+enum ScheduleFamily
+{
+    FAMILY_OPENMP = 1,
+    FAMILY_TBB = 2,
+    FAMILY_ALL = FAMILY_OPENMP | FAMILY_TBB
+};
+
+// 标定参数
+struct TuneOptions
+{
+    size_t calibration_points = 16384;                          // 从输入中等间隔抽取的标定点数
+    int repeats = 3;                                            // 每个候选计时次数（取最小值）
+    int families = FAMILY_ALL;                                  // 参与比较的调度族（未启用OpenMP时自动去掉）
+    std::vector<size_t> grains = {64, 256, 1024, 4096};         // 候选粒度
+};
+
+// 一个候选的标定结果
+struct ScheduleTrial
+{
+    ScheduleConfig config;
+    double seconds = 0.0; // 标定点集上的最短耗时
+};
+
+// 曲面签名：几何指纹 + 求解路径（闭式内核类型/预处理精度/OCCT通用投影），用作调度缓存的键
+uint64_t schedule_signature(const BatchProjector &projector);
+
+// 在 input 的抽样上逐个计时候选调度，返回最快者：
+// 先以每线程工作区比较全部调度器×粒度，再对最快组合比较工作区复用方式
+ScheduleConfig calibrate_schedule(const BatchProjector &projector, const PointBatch &input, int num_threads,
+                                  const TuneOptions &options = TuneOptions(), std::vector<ScheduleTrial> *trials = nullptr);
+
+// 调度自动调优器：按 (曲面签名, 线程数, 候选族) 缓存标定结果，可存成文本文件供后续运行直接使用
+class ScheduleTuner
+{
+public:
+    // 文件不存在时返回false（缓存保持为空）；格式错误的行被忽略
+    bool load(const std::string &path);
+    bool save(const std::string &path) const;
+
+    // 命中缓存直接返回，否则在 input 上标定并记入缓存；cached 非空时返回是否命中
+    ScheduleConfig select(const BatchProjector &projector, const PointBatch &input, int num_threads,
+                          const TuneOptions &options = TuneOptions(), bool *cached = nullptr);
+
+    size_t size() const { return entries_.size(); }
+    void clear() { entries_.clear(); }
+
+private:
+    struct Entry
+    {
+        ScheduleConfig config;
+        double points_per_second = 0.0; // 标定吞吐量，仅供参考
+    };
+
+    using Key = std::tuple<uint64_t, int, int>; // 签名、线程数、候选族
+    std::map<Key, Entry> entries_;
+};
@@ -0,0 +1,432 @@
+#include "seed_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <Precision.hxx>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/task_arena.h>
+#include <tbb/enumerable_thread_specific.h>
+
+namespace
+{
+    const char CACHE_MAGIC[8] = {'O', 'C', 'C', 'T', 'S', 'D', 'C', '\0'};
+    const uint32_t CACHE_VERSION = 1;
+    const int BOUNDS_SAMPLES = 33; // 估计曲面包围盒时每个方向的采样数
+
+    // FNV-1a
+    void hash_bytes(uint64_t &h, const void *data, size_t size)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (size_t k = 0; k < size; ++k)
+        {
+            h ^= bytes[k];
+            h *= 1099511628211ULL;
+        }
+    }
+
+    void hash_double(uint64_t &h, double value)
+    {
+        if (value == 0.0)
+            value = 0.0; // -0.0 与 0.0 视为相同
+        hash_bytes(h, &value, sizeof(value));
+    }
+
+    bool domain_is_finite(const SurfaceParamDomain &d)
+    {
+        return !Precision::IsInfinite(d.umin) && !Precision::IsInfinite(d.umax) &&
+               !Precision::IsInfinite(d.vmin) && !Precision::IsInfinite(d.vmax);
+    }
+
+    template <class T>
+    void write_value(std::ofstream &out, const T &value)
+    {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <class T>
+    bool read_value(std::ifstream &in, T &value)
+    {
+        return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+    }
+
+    // 单个点：缓存种子局部求解，不满足距离上界时回退全局求解
+    void project_point_cached(const SeedCache &cache, const BatchProjector &projector, const PointBatch &input,
+                              const ProjectionBuffers &output, size_t i, ProjectionWorkspace &workspace,
+                              SeedCacheStats &stats)
+    {
+        const gp_Pnt p(input.x[i], input.y[i], input.z[i]);
+        if (!std::isfinite(p.X()) || !std::isfinite(p.Y()) || !std::isfinite(p.Z()))
+        {
+            output.x[i] = p.X(), output.y[i] = p.Y(), output.z[i] = p.Z();
+            output.status[i] = PROJECTION_INVALID_INPUT;
+            ++stats.failed;
+            return;
+        }
+
+        LocalProjectionResult result;
+        double u0, v0, bound;
+        if (cache.lookup(p, u0, v0, bound))
+        {
+            if (projector.refine_point(p, u0, v0, workspace, result, cache.options().max_iterations) &&
+                result.distance <= bound + cache.options().distance_slack)
+            {
+                store_projection(output, i, result);
+                ++stats.hits;
+                return;
+            }
+            ++stats.rejected;
+        }
+        else
+            ++stats.misses;
+
+        if (!projector.project_point(p, workspace, result))
+        {
+            output.x[i] = p.X(), output.y[i] = p.Y(), output.z[i] = p.Z();
+            output.status[i] = PROJECTION_NOT_DONE;
+            ++stats.failed;
+            return;
+        }
+        store_projection(output, i, result);
+    }
+
+    void add_stats(SeedCacheStats &total, const SeedCacheStats &part)
+    {
+        total.hits += part.hits;
+        total.rejected += part.rejected;
+        total.misses += part.misses;
+        total.failed += part.failed;
+    }
+}
+
+uint64_t surface_fingerprint(const BatchProjector &projector)
+{
+    uint64_t h = 14695981039346656037ULL;
+    const Handle(Geom_Surface) & surface = projector.surface();
+    if (surface.IsNull())
+        return h;
+    const SurfaceParamDomain &d = projector.domain();
+    hash_double(h, d.umin), hash_double(h, d.umax), hash_double(h, d.vmin), hash_double(h, d.vmax);
+    if (!domain_is_finite(d))
+        return h;
+    gp_Pnt p;
+    for (int i = 0; i < 7; ++i)
+    {
+        for (int j = 0; j < 7; ++j)
+        {
+            surface->D0(d.umin + (d.umax - d.umin) * i / 6.0, d.vmin + (d.vmax - d.vmin) * j / 6.0, p);
+            hash_double(h, p.X()), hash_double(h, p.Y()), hash_double(h, p.Z());
+        }
+    }
+    return h;
+}
+
+uint64_t SeedCache::make_key(int level, uint32_t ix, uint32_t iy, uint32_t iz)
+{
+    // 4位层号 + 每轴20位单元坐标
+    return (static_cast<uint64_t>(level) << 60) | (static_cast<uint64_t>(ix & 0xfffff) << 40) |
+           (static_cast<uint64_t>(iy & 0xfffff) << 20) | static_cast<uint64_t>(iz & 0xfffff);
+}
+
+double SeedCache::cell_size(int level) const
+{
+    return std::ldexp(size_, -level);
+}
+
+gp_Pnt SeedCache::cell_center(int level, uint32_t ix, uint32_t iy, uint32_t iz) const
+{
+    const double h = cell_size(level);
+    return gp_Pnt(origin_[0] + (ix + 0.5) * h, origin_[1] + (iy + 0.5) * h, origin_[2] + (iz + 0.5) * h);
+}
+
+bool SeedCache::build(const BatchProjector &projector, int num_threads, const SeedCacheOptions &options)
+{
+    cells_.clear();
+    nb_leaves_ = 0;
+    options_ = options;
+    options_.base_resolution = std::min(std::max(options_.base_resolution, 1), 512);
+    options_.max_depth = std::min(std::max(options_.max_depth, 0), 10); // 顶层坐标 * 2^depth 须在20位内
+    const SurfaceParamDomain &d = projector.domain();
+    if (projector.is_analytic() || projector.surface().IsNull() || !domain_is_finite(d))
+        return false;
+    fingerprint_ = surface_fingerprint(projector);
+
+    // 采样估计曲面包围盒，外扩 band 后划分顶层网格
+    double lo[3], hi[3];
+    gp_Pnt p;
+    for (int i = 0; i < BOUNDS_SAMPLES; ++i)
+    {
+        for (int j = 0; j < BOUNDS_SAMPLES; ++j)
+        {
+            projector.surface()->D0(d.umin + (d.umax - d.umin) * i / (BOUNDS_SAMPLES - 1),
+                                    d.vmin + (d.vmax - d.vmin) * j / (BOUNDS_SAMPLES - 1), p);
+            const double c[3] = {p.X(), p.Y(), p.Z()};
+            for (int k = 0; k < 3; ++k)
+            {
+                lo[k] = i == 0 && j == 0 ? c[k] : std::min(lo[k], c[k]);
+                hi[k] = i == 0 && j == 0 ? c[k] : std::max(hi[k], c[k]);
+            }
+        }
+    }
+    const double diag = std::sqrt((hi[0] - lo[0]) * (hi[0] - lo[0]) + (hi[1] - lo[1]) * (hi[1] - lo[1]) +
+                                  (hi[2] - lo[2]) * (hi[2] - lo[2]));
+    const double band = std::max(options_.band * diag, Precision::Confusion());
+    double extent = 0.0;
+    for (int k = 0; k < 3; ++k)
+    {
+        origin_[k] = lo[k] - band;
+        extent = std::max(extent, hi[k] - lo[k] + 2.0 * band);
+    }
+    size_ = extent / options_.base_resolution;
+    for (int k = 0; k < 3; ++k)
+        dims_[k] = std::max<uint32_t>(1, static_cast<uint32_t>(std::ceil((hi[k] - lo[k] + 2.0 * band) / size_)));
+
+    struct Candidate
+    {
+        uint32_t ix, iy, iz;
+    };
+    std::vector<Candidate> level_cells;
+    for (uint32_t ix = 0; ix < dims_[0]; ++ix)
+        for (uint32_t iy = 0; iy < dims_[1]; ++iy)
+            for (uint32_t iz = 0; iz < dims_[2]; ++iz)
+                level_cells.push_back({ix, iy, iz});
+
+    tbb::enumerable_thread_specific<ProjectionWorkspace> ets_workspace;
+    tbb::task_arena arena(std::max(num_threads, 1));
+    for (int level = 0; level <= options_.max_depth && !level_cells.empty(); ++level)
+    {
+        const double h = cell_size(level);
+        const double half_diag = 0.5 * std::sqrt(3.0) * h;
+        std::vector<Cell> results(level_cells.size());
+        std::vector<unsigned char> keep(level_cells.size(), 0);
+        arena.execute([&] {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, level_cells.size(), 16), [&](const tbb::blocked_range<size_t> &r) {
+                ProjectionWorkspace &workspace = ets_workspace.local();
+                LocalProjectionResult center, corner;
+                for (size_t k = r.begin(); k < r.end(); ++k)
+                {
+                    const Candidate &c = level_cells[k];
+                    const gp_Pnt pc = cell_center(level, c.ix, c.iy, c.iz);
+                    // 整个单元都在 band 之外，或中心无法投影：不缓存，查询时走全局求解
+                    if (!projector.project_point(pc, workspace, center) || center.distance - half_diag > band)
+                        continue;
+                    Cell &cell = results[k];
+                    cell.u = center.u, cell.v = center.v, cell.distance = center.distance;
+
+                    // 角点最近点相对中心最近点的分散程度
+                    bool split = false;
+                    for (int m = 0; m < 8 && !split; ++m)
+                    {
+                        const gp_Pnt pk(pc.X() + ((m & 1) ? 0.5 : -0.5) * h, pc.Y() + ((m & 2) ? 0.5 : -0.5) * h,
+                                        pc.Z() + ((m & 4) ? 0.5 : -0.5) * h);
+                        split = !projector.project_point(pk, workspace, corner) ||
+                                corner.point.Distance(center.point) > options_.max_seed_spread * h;
+                    }
+                    cell.flag = !split ? CELL_LEAF : level < options_.max_depth ? CELL_INTERNAL : CELL_AMBIGUOUS;
+                    keep[k] = 1;
+                }
+            });
+        });
+
+        std::vector<Candidate> children;
+        for (size_t k = 0; k < level_cells.size(); ++k)
+        {
+            if (!keep[k])
+                continue;
+            const Candidate &c = level_cells[k];
+            cells_[make_key(level, c.ix, c.iy, c.iz)] = results[k];
+            if (results[k].flag != CELL_INTERNAL)
+            {
+                ++nb_leaves_;
+                continue;
+            }
+            for (int m = 0; m < 8; ++m)
+                children.push_back({2 * c.ix + (m & 1), 2 * c.iy + ((m >> 1) & 1), 2 * c.iz + ((m >> 2) & 1)});
+        }
+        level_cells.swap(children);
+    }
+    return !cells_.empty();
+}
+
+bool SeedCache::lookup(const gp_Pnt &p, double &u, double &v, double &bound) const
+{
+    if (cells_.empty())
+        return false;
+    const int depth = options_.max_depth;
+    const double fine = cell_size(depth);
+    const double q[3] = {p.X(), p.Y(), p.Z()};
+    uint32_t index[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        const double f = (q[k] - origin_[k]) / fine;
+        if (!(f >= 0.0 && f < std::ldexp(static_cast<double>(dims_[k]), depth))) // 也排除了NaN
+            return false;
+        index[k] = static_cast<uint32_t>(f);
+    }
+
+    // 逐层向下查找，一般只需 1~(max_depth+1) 次哈希查找
+    for (int level = 0; level <= depth; ++level)
+    {
+        const int shift = depth - level;
+        const uint32_t ix = index[0] >> shift, iy = index[1] >> shift, iz = index[2] >> shift;
+        const auto it = cells_.find(make_key(level, ix, iy, iz));
+        if (it == cells_.end() || it->second.flag == CELL_AMBIGUOUS)
+            return false;
+        if (it->second.flag == CELL_INTERNAL)
+            continue;
+        u = it->second.u;
+        v = it->second.v;
+        bound = it->second.distance + p.Distance(cell_center(level, ix, iy, iz));
+        return true;
+    }
+    return false;
+}
+
+bool SeedCache::save(const std::string &path) const
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+    {
+        std::cerr << "Failed to write seed cache: " << path << std::endl;
+        return false;
+    }
+    // 主机字节序，只在同类机器之间复用
+    out.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    write_value(out, CACHE_VERSION);
+    write_value(out, fingerprint_);
+    write_value(out, options_.base_resolution);
+    write_value(out, options_.max_depth);
+    write_value(out, options_.band);
+    write_value(out, options_.max_seed_spread);
+    for (int k = 0; k < 3; ++k)
+        write_value(out, origin_[k]);
+    write_value(out, size_);
+    for (int k = 0; k < 3; ++k)
+        write_value(out, dims_[k]);
+    write_value(out, static_cast<uint64_t>(cells_.size()));
+    for (const auto &entry : cells_)
+    {
+        write_value(out, entry.first);
+        write_value(out, entry.second.u);
+        write_value(out, entry.second.v);
+        write_value(out, entry.second.distance);
+        write_value(out, entry.second.flag);
+    }
+    return static_cast<bool>(out);
+}
+
+bool SeedCache::load(const std::string &path, const BatchProjector &projector)
+{
+    cells_.clear();
+    nb_leaves_ = 0;
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    char magic[8];
+    uint32_t version = 0;
+    uint64_t fingerprint = 0, count = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 ||
+        !read_value(in, version) || version != CACHE_VERSION || !read_value(in, fingerprint))
+    {
+        std::cerr << "Not a seed cache file: " << path << std::endl;
+        return false;
+    }
+    if (fingerprint != surface_fingerprint(projector))
+    {
+        std::cerr << "Seed cache does not match the surface: " << path << std::endl;
+        return false;
+    }
+    fingerprint_ = fingerprint;
+    bool ok = read_value(in, options_.base_resolution) && read_value(in, options_.max_depth) &&
+              read_value(in, options_.band) && read_value(in, options_.max_seed_spread);
+    for (int k = 0; k < 3; ++k)
+        ok = ok && read_value(in, origin_[k]);
+    ok = ok && read_value(in, size_);
+    for (int k = 0; k < 3; ++k)
+        ok = ok && read_value(in, dims_[k]);
+    ok = ok && read_value(in, count);
+    cells_.reserve(static_cast<size_t>(count));
+    for (uint64_t n = 0; ok && n < count; ++n)
+    {
+        uint64_t key = 0;
+        Cell cell;
+        ok = read_value(in, key) && read_value(in, cell.u) && read_value(in, cell.v) &&
+             read_value(in, cell.distance) && read_value(in, cell.flag);
+        if (ok)
+        {
+            cells_[key] = cell;
+            nb_leaves_ += cell.flag != CELL_INTERNAL;
+        }
+    }
+    if (!ok)
+    {
+        std::cerr << "Truncated seed cache file: " << path << std::endl;
+        cells_.clear();
+        nb_leaves_ = 0;
+    }
+    return ok;
+}
+
+SeedCacheStats project_batch_cached(const SeedCache &cache, const BatchProjector &projector, const PointBatch &input,
+                                    const ProjectionBuffers &output, ProjectionBackend backend, int num_threads)
+{
+    SeedCacheStats stats;
+    if (projector.is_analytic() || !cache.is_valid())
+    {
+        project_batch(projector, input, output, backend, num_threads);
+        stats.misses = input.count;
+        return stats;
+    }
+
+    if (backend == BACKEND_TBB)
+    {
+        tbb::enumerable_thread_specific<ProjectionWorkspace> ets_workspace;
+        tbb::enumerable_thread_specific<SeedCacheStats> ets_stats;
+        tbb::task_arena arena(num_threads);
+        arena.execute([&] {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, input.count, ANALYTIC_BLOCK_SIZE), [&](const tbb::blocked_range<size_t> &r) {
+                ProjectionWorkspace &workspace = ets_workspace.local();
+                SeedCacheStats &part = ets_stats.local();
+                for (size_t i = r.begin(); i < r.end(); ++i)
+                    project_point_cached(cache, projector, input, output, i, workspace, part);
+            });
+        });
+        for (const auto &part : ets_stats)
+            add_stats(stats, part);
+    }
+    else if (backend == BACKEND_OPENMP)
+    {
+#ifdef _OPENMP
+        omp_set_num_threads(num_threads);
+#pragma omp parallel
+        {
+            ProjectionWorkspace workspace;
+            SeedCacheStats part;
+            // 命中与回退全局求解的耗时相差很大，用动态调度
+#pragma omp for schedule(dynamic, 256)
+            for (long long i = 0; i < static_cast<long long>(input.count); ++i)
+                project_point_cached(cache, projector, input, output, static_cast<size_t>(i), workspace, part);
+#pragma omp critical
+            add_stats(stats, part);
+        }
+#else
+        std::cerr << "OpenMP not enabled!" << std::endl;
+#endif
+    }
+    else
+    {
+        ProjectionWorkspace workspace;
+        for (size_t i = 0; i < input.count; ++i)
+            project_point_cached(cache, projector, input, output, i, workspace, stats);
+    }
+    return stats;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "batch_projection.h"
+
+// 种子缓存参数
+struct SeedCacheOptions
+{
+    int base_resolution = 16;     // 顶层网格最长轴的单元数（立方体单元）
+    int max_depth = 3;            // 最多细分层数（每层各轴二分）
+    double band = 0.25;           // 只缓存到曲面距离不超过 band * 曲面包围盒对角线 的单元
+    double max_seed_spread = 2.0; // 单元角点的最近点偏离中心最近点超过 该倍数 * 单元边长 时细分
+    int max_iterations = 20;      // 查询时局部Newton最大迭代次数
+    double distance_slack = 1e-7; // 距离上界检查的绝对容差
+};
+
+// 缓存投影统计
+struct SeedCacheStats
+{
+    size_t hits = 0;     // 缓存种子局部求解被接受
+    size_t rejected = 0; // 局部求解不收敛或超出距离上界，回退全局求解
+    size_t misses = 0;   // 点在缓存范围外或落在歧义单元，直接全局求解
+    size_t failed = 0;   // 全局求解也失败
+};
+
+// 稀疏自适应体素种子缓存：每个曲面构建一次，之后各轮点集反复使用，可存盘供后续运行直接加载
+// - 顶层为覆盖曲面包围盒（外扩 band）的均匀立方体网格，只保留距曲面 band 以内的单元
+// - 单元中心做一次全局投影，记录最近点UV和距离；8个角点的最近点若相对中心分散（接近中轴、
+//   有多个局部极小），则细分为8个子单元，到 max_depth 仍分散的单元标记为歧义，查询时走全局求解
+// - 查询：逐层哈希查找到叶单元，以其UV为种子做局部Newton，结果距离不超过
+//   d(中心) + |P - 中心|（全局最近距离的上界）才接受，否则回退全局求解
+// 构建后只读，可被多个线程共享
+class SeedCache
+{
+public:
+    // 构建缓存（TBB并行），曲面参数域无限时返回false
+    bool build(const BatchProjector &projector, int num_threads, const SeedCacheOptions &options = SeedCacheOptions());
+
+    // 二进制存盘/加载；加载时校验曲面指纹，几何变化后返回false
+    bool save(const std::string &path) const;
+    bool load(const std::string &path, const BatchProjector &projector);
+
+    bool is_valid() const { return !cells_.empty(); }
+    const SeedCacheOptions &options() const { return options_; }
+    size_t nb_cells() const { return cells_.size(); }
+    size_t nb_leaves() const { return nb_leaves_; }
+
+    // 查找包含p的叶单元：返回种子UV和全局最近距离的上界；缓存范围外或歧义单元返回false
+    bool lookup(const gp_Pnt &p, double &u, double &v, double &bound) const;
+
+private:
+    enum CellFlag : unsigned char
+    {
+        CELL_LEAF = 0,
+        CELL_INTERNAL = 1,
+        CELL_AMBIGUOUS = 2
+    };
+
+    struct Cell
+    {
+        double u = 0.0, v = 0.0;  // 中心最近点参数
+        double distance = 0.0;    // 中心到曲面的距离
+        unsigned char flag = CELL_LEAF;
+    };
+
+    static uint64_t make_key(int level, uint32_t ix, uint32_t iy, uint32_t iz);
+    double cell_size(int level) const;
+    gp_Pnt cell_center(int level, uint32_t ix, uint32_t iy, uint32_t iz) const;
+
+    SeedCacheOptions options_;
+    uint64_t fingerprint_ = 0;
+    double origin_[3] = {0.0, 0.0, 0.0};
+    double size_ = 0.0;                  // 顶层单元边长
+    uint32_t dims_[3] = {0, 0, 0};       // 顶层各轴单元数
+    size_t nb_leaves_ = 0;
+    std::unordered_map<uint64_t, Cell> cells_;
+};
+
+// 曲面指纹：参数域和固定UV网格上的求值结果的哈希，用于判断缓存是否与几何匹配
+uint64_t surface_fingerprint(const BatchProjector &projector);
+
+// 用种子缓存做批量投影；初等曲面或空缓存直接走 project_batch
+SeedCacheStats project_batch_cached(const SeedCache &cache, const BatchProjector &projector, const PointBatch &input,
+                                    const ProjectionBuffers &output, ProjectionBackend backend, int num_threads);
@@ -0,0 +1,252 @@
+#include "simd_kernels.h"
+
+#include <atomic>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PROJ_SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// GCC/Clang 需要按函数开启指令集；MSVC 无需编译选项即可使用这些内建函数
+#if defined(PROJ_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PROJ_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define PROJ_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define PROJ_TARGET_AVX2
+#define PROJ_TARGET_AVX512
+#endif
+
+namespace
+{
+    typedef size_t (*NearestKernel)(const float *, const float *, const float *, size_t, float, float, float, float &);
+
+    size_t nearest_scalar(const float *x, const float *y, const float *z, size_t n, float qx, float qy, float qz, float &dist2)
+    {
+        size_t best = 0;
+        float best_d2 = std::numeric_limits<float>::infinity();
+        for (size_t i = 0; i < n; ++i)
+        {
+            const float dx = x[i] - qx, dy = y[i] - qy, dz = z[i] - qz;
+            const float d2 = dx * dx + dy * dy + dz * dz;
+            if (d2 < best_d2)
+            {
+                best_d2 = d2;
+                best = i;
+            }
+        }
+        dist2 = best_d2;
+        return best;
+    }
+
+    // 各通道的最小值归约；距离相同取下标小者
+    inline void reduce_lanes(const float *d2, const int *index, int lanes, size_t &best, float &best_d2)
+    {
+        for (int l = 0; l < lanes; ++l)
+        {
+            const size_t i = static_cast<size_t>(index[l]);
+            if (d2[l] < best_d2 || (d2[l] == best_d2 && i < best))
+            {
+                best_d2 = d2[l];
+                best = i;
+            }
+        }
+    }
+
+#ifdef PROJ_SIMD_X86
+    PROJ_TARGET_AVX2
+    size_t nearest_avx2(const float *x, const float *y, const float *z, size_t n, float qx, float qy, float qz, float &dist2)
+    {
+        const __m256 vx = _mm256_set1_ps(qx), vy = _mm256_set1_ps(qy), vz = _mm256_set1_ps(qz);
+        __m256 best_d2 = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+        __m256i best_index = _mm256_setzero_si256();
+        __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i step = _mm256_set1_epi32(8);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), vx);
+            const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), vy);
+            const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(z + i), vz);
+            const __m256 d2 = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx)));
+            const __m256 closer = _mm256_cmp_ps(d2, best_d2, _CMP_LT_OQ);
+            best_d2 = _mm256_blendv_ps(best_d2, d2, closer);
+            best_index = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(best_index), _mm256_castsi256_ps(index), closer));
+            index = _mm256_add_epi32(index, step);
+        }
+        alignas(32) float lane_d2[8];
+        alignas(32) int lane_index[8];
+        _mm256_store_ps(lane_d2, best_d2);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lane_index), best_index);
+        size_t best = 0;
+        float best_value = std::numeric_limits<float>::infinity();
+        reduce_lanes(lane_d2, lane_index, 8, best, best_value);
+        if (i < n)
+        {
+            float tail_d2;
+            const size_t tail = i + nearest_scalar(x + i, y + i, z + i, n - i, qx, qy, qz, tail_d2);
+            if (tail_d2 < best_value)
+                best_value = tail_d2, best = tail;
+        }
+        dist2 = best_value;
+        return best;
+    }
+
+    PROJ_TARGET_AVX512
+    size_t nearest_avx512(const float *x, const float *y, const float *z, size_t n, float qx, float qy, float qz, float &dist2)
+    {
+        const __m512 vx = _mm512_set1_ps(qx), vy = _mm512_set1_ps(qy), vz = _mm512_set1_ps(qz);
+        __m512 best_d2 = _mm512_set1_ps(std::numeric_limits<float>::infinity());
+        __m512i best_index = _mm512_setzero_si512();
+        __m512i index = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        const __m512i step = _mm512_set1_epi32(16);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            const __m512 dx = _mm512_sub_ps(_mm512_loadu_ps(x + i), vx);
+            const __m512 dy = _mm512_sub_ps(_mm512_loadu_ps(y + i), vy);
+            const __m512 dz = _mm512_sub_ps(_mm512_loadu_ps(z + i), vz);
+            const __m512 d2 = _mm512_fmadd_ps(dz, dz, _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dx, dx)));
+            const __mmask16 closer = _mm512_cmp_ps_mask(d2, best_d2, _CMP_LT_OQ);
+            best_d2 = _mm512_mask_blend_ps(closer, best_d2, d2);
+            best_index = _mm512_mask_blend_epi32(closer, best_index, index);
+            index = _mm512_add_epi32(index, step);
+        }
+        alignas(64) float lane_d2[16];
+        alignas(64) int lane_index[16];
+        _mm512_store_ps(lane_d2, best_d2);
+        _mm512_store_si512(lane_index, best_index);
+        size_t best = 0;
+        float best_value = std::numeric_limits<float>::infinity();
+        reduce_lanes(lane_d2, lane_index, 16, best, best_value);
+        if (i < n)
+        {
+            float tail_d2;
+            const size_t tail = i + nearest_scalar(x + i, y + i, z + i, n - i, qx, qy, qz, tail_d2);
+            if (tail_d2 < best_value)
+                best_value = tail_d2, best = tail;
+        }
+        dist2 = best_value;
+        return best;
+    }
+
+    void cpuid(int leaf, int subleaf, unsigned regs[4])
+    {
+#ifdef _MSC_VER
+        int r[4];
+        __cpuidex(r, leaf, subleaf);
+        for (int k = 0; k < 4; ++k)
+            regs[k] = static_cast<unsigned>(r[k]);
+#else
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    unsigned long long xgetbv0()
+    {
+#ifdef _MSC_VER
+        return _xgetbv(0);
+#else
+        unsigned lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return (static_cast<unsigned long long>(hi) << 32) | lo;
+#endif
+    }
+#endif
+
+    SimdLevel detect_level()
+    {
+#ifdef PROJ_SIMD_X86
+        unsigned regs[4];
+        cpuid(0, 0, regs);
+        if (regs[0] < 7)
+            return SIMD_SCALAR;
+        cpuid(1, 0, regs);
+        const bool osxsave = (regs[2] & (1u << 27)) != 0;
+        const bool fma = (regs[2] & (1u << 12)) != 0;
+        if (!osxsave)
+            return SIMD_SCALAR;
+        // 操作系统须保存 YMM（XCR0 位1、2）/ ZMM（位5、6、7）状态
+        const unsigned long long xcr0 = xgetbv0();
+        const bool ymm = (xcr0 & 0x6) == 0x6;
+        const bool zmm = (xcr0 & 0xe6) == 0xe6;
+        cpuid(7, 0, regs);
+        const bool avx2 = (regs[1] & (1u << 5)) != 0;
+        const bool avx512f = (regs[1] & (1u << 16)) != 0;
+        if (avx512f && zmm)
+            return SIMD_AVX512;
+        if (avx2 && fma && ymm)
+            return SIMD_AVX2;
+#endif
+        return SIMD_SCALAR;
+    }
+
+    NearestKernel kernel_for(SimdLevel level)
+    {
+#ifdef PROJ_SIMD_X86
+        if (level == SIMD_AVX512)
+            return nearest_avx512;
+        if (level == SIMD_AVX2)
+            return nearest_avx2;
+#endif
+        return nearest_scalar;
+    }
+
+    struct Dispatch
+    {
+        SimdLevel detected;
+        std::atomic<int> level;
+        std::atomic<NearestKernel> nearest;
+
+        Dispatch() : detected(detect_level()), level(detected), nearest(kernel_for(detected)) {}
+    };
+
+    Dispatch &dispatch()
+    {
+        static Dispatch d; // 线程安全的一次性初始化
+        return d;
+    }
+}
+
+SimdLevel simd_detect()
+{
+    return dispatch().detected;
+}
+
+SimdLevel simd_level()
+{
+    return static_cast<SimdLevel>(dispatch().level.load(std::memory_order_relaxed));
+}
+
+void simd_force(SimdLevel level)
+{
+    Dispatch &d = dispatch();
+    if (level > d.detected)
+        level = d.detected;
+    d.level.store(level, std::memory_order_relaxed);
+    d.nearest.store(kernel_for(level), std::memory_order_relaxed);
+}
+
+const char *simd_level_name(SimdLevel level)
+{
+    switch (level)
+    {
+    case SIMD_AVX512:
+        return "avx512";
+    case SIMD_AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+size_t nearest_point_f32(const float *x, const float *y, const float *z, size_t n,
+                         float qx, float qy, float qz, float &dist2)
+{
+    return dispatch().nearest.load(std::memory_order_relaxed)(x, y, z, n, qx, qy, qz, dist2);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+// 运行时分派的单精度SIMD内核（x86: AVX-512 / AVX2+FMA，其它平台或旧CPU走标量实现）
+// 首次调用时检测一次CPU特性，之后所有线程共用同一组函数指针
+enum SimdLevel
+{
+    SIMD_SCALAR = 0,
+    SIMD_AVX2,
+    SIMD_AVX512
+};
+
+// 当前CPU和操作系统支持的最高级别
+SimdLevel simd_detect();
+
+// 当前使用的级别（默认 simd_detect()）；simd_force 只能降级，用于对比测试
+SimdLevel simd_level();
+void simd_force(SimdLevel level);
+const char *simd_level_name(SimdLevel level);
+
+// 在 n 个单精度点（SoA）中找离 (qx, qy, qz) 最近的一个，返回其下标，dist2 为距离平方（单精度）
+// 距离相同时返回下标最小者，与标量顺序扫描一致；n 为0时返回0，dist2为无穷大
+size_t nearest_point_f32(const float *x, const float *y, const float *z, size_t n,
+                         float qx, float qy, float qz, float &dist2);
@@ -0,0 +1,257 @@
+#include "surface_evaluators.h"
+
+#include <Precision.hxx>
+#include <Geom_BSplineSurface.hxx>
+#include <Geom_BezierSurface.hxx>
+#include <Geom_RectangularTrimmedSurface.hxx>
+#include <GeomConvert.hxx>
+
+namespace
+{
+    // 节点区间 [U(span), U(span+1)) 上 p+1 个非零基函数 N(span-p) .. N(span) 在 u 处的 0..p 阶导数
+    // ders[k * (p + 1) + j] 为 N(span-p+j) 的k阶导数（Piegl & Tiller, The NURBS Book, A2.3）
+    void basis_derivatives(const std::vector<double> &U, int span, double u, int p, std::vector<double> &ders)
+    {
+        const int n = p + 1;
+        std::vector<double> ndu(static_cast<size_t>(n) * n), left(n), right(n), a(2 * static_cast<size_t>(n));
+        ndu[0] = 1.0;
+        for (int j = 1; j <= p; ++j)
+        {
+            left[j] = u - U[span + 1 - j];
+            right[j] = U[span + j] - u;
+            double saved = 0.0;
+            for (int r = 0; r < j; ++r)
+            {
+                ndu[j * n + r] = right[r + 1] + left[j - r];
+                const double temp = ndu[r * n + j - 1] / ndu[j * n + r];
+                ndu[r * n + j] = saved + right[r + 1] * temp;
+                saved = left[j - r] * temp;
+            }
+            ndu[j * n + j] = saved;
+        }
+
+        ders.assign(static_cast<size_t>(n) * n, 0.0);
+        for (int j = 0; j <= p; ++j)
+            ders[j] = ndu[j * n + p];
+        for (int r = 0; r <= p; ++r)
+        {
+            int s1 = 0, s2 = 1;
+            a[0] = 1.0;
+            for (int k = 1; k <= p; ++k)
+            {
+                double d = 0.0;
+                const int rk = r - k, pk = p - k;
+                if (r >= k)
+                {
+                    a[s2 * n] = a[s1 * n] / ndu[(pk + 1) * n + rk];
+                    d = a[s2 * n] * ndu[rk * n + pk];
+                }
+                const int j1 = rk >= -1 ? 1 : -rk;
+                const int j2 = r - 1 <= pk ? k - 1 : p - r;
+                for (int j = j1; j <= j2; ++j)
+                {
+                    a[s2 * n + j] = (a[s1 * n + j] - a[s1 * n + j - 1]) / ndu[(pk + 1) * n + rk + j];
+                    d += a[s2 * n + j] * ndu[(rk + j) * n + pk];
+                }
+                if (r <= pk)
+                {
+                    a[s2 * n + k] = -a[s1 * n + k - 1] / ndu[(pk + 1) * n + r];
+                    d += a[s2 * n + k] * ndu[r * n + pk];
+                }
+                ders[k * n + r] = d;
+                std::swap(s1, s2);
+            }
+        }
+        double factor = p;
+        for (int k = 1; k <= p; ++k)
+        {
+            for (int j = 0; j <= p; ++j)
+                ders[k * n + j] *= factor;
+            factor *= p - k;
+        }
+    }
+
+    // 一个方向的非退化span：起点所在的节点下标，以及换算到归一化参数的泰勒系数 N^(a)(t0) * dt^a / a!
+    struct SpanBasis
+    {
+        int knot = 0;
+        std::vector<double> taylor; // [a * (p + 1) + j]
+    };
+
+    void collect_spans(const std::vector<double> &U, int p, int nb_poles, std::vector<double> &breaks,
+                       std::vector<SpanBasis> &spans)
+    {
+        breaks.clear();
+        spans.clear();
+        std::vector<double> ders;
+        for (int s = p; s < nb_poles; ++s)
+        {
+            const double t0 = U[s], t1 = U[s + 1];
+            if (t1 - t0 <= Precision::PConfusion())
+                continue;
+            SpanBasis span;
+            span.knot = s;
+            basis_derivatives(U, s, t0, p, ders);
+            span.taylor.resize(ders.size());
+            double scale = 1.0; // dt^a / a!
+            for (int a = 0; a <= p; ++a)
+            {
+                for (int j = 0; j <= p; ++j)
+                    span.taylor[a * (p + 1) + j] = ders[a * (p + 1) + j] * scale;
+                scale *= (t1 - t0) / (a + 1);
+            }
+            if (breaks.empty())
+                breaks.push_back(t0);
+            breaks.push_back(t1);
+            spans.push_back(span);
+        }
+    }
+}
+
+const char *surface_evaluator_name(SurfaceEvaluatorKind kind)
+{
+    switch (kind)
+    {
+    case EVALUATOR_PLANE:
+        return "plane";
+    case EVALUATOR_CYLINDER:
+        return "cylinder";
+    case EVALUATOR_CONE:
+        return "cone";
+    case EVALUATOR_SPHERE:
+        return "sphere";
+    case EVALUATOR_TORUS:
+        return "torus";
+    case EVALUATOR_BSPLINE:
+        return "bspline";
+    default:
+        return "adaptor";
+    }
+}
+
+bool BSplineSpanTable::init(const Handle(Geom_Surface) & surface)
+{
+    *this = BSplineSpanTable();
+    if (surface.IsNull())
+        return false;
+
+    // 裁剪曲面不改变基曲面的参数化，系数表直接用基曲面的span
+    Handle(Geom_Surface) basis = surface;
+    while (Handle(Geom_RectangularTrimmedSurface) trimmed = Handle(Geom_RectangularTrimmedSurface)::DownCast(basis))
+        basis = trimmed->BasisSurface();
+    Handle(Geom_BSplineSurface) bspline;
+    if (Handle(Geom_BSplineSurface)::DownCast(basis))
+        bspline = Handle(Geom_BSplineSurface)::DownCast(basis->Copy());
+    else if (Handle(Geom_BezierSurface)::DownCast(basis))
+        bspline = GeomConvert::SurfaceToBSplineSurface(basis);
+    if (bspline.IsNull())
+        return false;
+    // 周期B样条在主周期上与非周期化后的表示一致（Newton迭代中参数已折回主周期）
+    if (bspline->IsUPeriodic())
+        bspline->SetUNotPeriodic();
+    if (bspline->IsVPeriodic())
+        bspline->SetVNotPeriodic();
+    // 参数域须落在节点范围内：跨接缝裁剪的周期曲面（如 [T/2, 3T/2]）超出主周期，
+    // 在末span上只能外推，这类曲面不特化，留给适配器
+    double umin, umax, vmin, vmax, ku0, ku1, kv0, kv1;
+    surface->Bounds(umin, umax, vmin, vmax);
+    bspline->Bounds(ku0, ku1, kv0, kv1);
+    const double tol = Precision::PConfusion();
+    if (umin < ku0 - tol || umax > ku1 + tol || vmin < kv0 - tol || vmax > kv1 + tol)
+        return false;
+
+    const TColStd_Array1OfReal &uk = bspline->UKnotSequence();
+    const TColStd_Array1OfReal &vk = bspline->VKnotSequence();
+    std::vector<double> uknots, vknots;
+    for (int i = uk.Lower(); i <= uk.Upper(); ++i)
+        uknots.push_back(uk(i));
+    for (int i = vk.Lower(); i <= vk.Upper(); ++i)
+        vknots.push_back(vk(i));
+
+    const TColgp_Array2OfPnt &poles = bspline->Poles();
+    const TColStd_Array2OfReal *weights = bspline->Weights();
+    const bool rational = weights && (bspline->IsURational() || bspline->IsVRational());
+    const int nu = bspline->NbUPoles(), nv = bspline->NbVPoles();
+    std::vector<double> homogeneous(static_cast<size_t>(nu) * nv * 4);
+    for (int i = 0; i < nu; ++i)
+    {
+        for (int j = 0; j < nv; ++j)
+        {
+            const gp_Pnt &pole = poles(poles.LowerRow() + i, poles.LowerCol() + j);
+            const double w = rational ? (*weights)(weights->LowerRow() + i, weights->LowerCol() + j) : 1.0;
+            double *h = &homogeneous[(static_cast<size_t>(i) * nv + j) * 4];
+            h[0] = w * pole.X(), h[1] = w * pole.Y(), h[2] = w * pole.Z(), h[3] = w;
+        }
+    }
+    return build(bspline->UDegree(), bspline->VDegree(), uknots, vknots, homogeneous, rational);
+}
+
+bool BSplineSpanTable::build(int udegree, int vdegree, const std::vector<double> &uknots, const std::vector<double> &vknots,
+                             const std::vector<double> &poles, bool rational)
+{
+    *this = BSplineSpanTable();
+    const int p = udegree, q = vdegree;
+    if (p < 1 || q < 1 || p > MAX_DEGREE || q > MAX_DEGREE)
+        return false;
+    const int nu = static_cast<int>(uknots.size()) - p - 1, nv = static_cast<int>(vknots.size()) - q - 1;
+    if (nu < p + 1 || nv < q + 1 || poles.size() != static_cast<size_t>(nu) * nv * 4)
+        return false;
+
+    std::vector<SpanBasis> uspans, vspans;
+    collect_spans(uknots, p, nu, ubreaks_, uspans);
+    collect_spans(vknots, q, nv, vbreaks_, vspans);
+    const size_t stride = static_cast<size_t>(p + 1) * (q + 1) * 4;
+    if (uspans.empty() || vspans.empty() || uspans.size() * vspans.size() * stride > MAX_COEFFICIENTS)
+    {
+        ubreaks_.clear(), vbreaks_.clear();
+        return false;
+    }
+
+    udeg_ = p, vdeg_ = q;
+    rational_ = rational;
+    stride_ = stride;
+    coefficients_.assign(uspans.size() * vspans.size() * stride, 0.0);
+    std::vector<double> row_sum(static_cast<size_t>(p + 1) * (q + 1) * 4); // [a][l][k]：先沿u合并控制点
+    for (size_t iu = 0; iu < uspans.size(); ++iu)
+    {
+        const SpanBasis &su = uspans[iu];
+        for (size_t iv = 0; iv < vspans.size(); ++iv)
+        {
+            const SpanBasis &sv = vspans[iv];
+            std::fill(row_sum.begin(), row_sum.end(), 0.0);
+            for (int a = 0; a <= p; ++a)
+            {
+                for (int j = 0; j <= p; ++j)
+                {
+                    const double nu_a = su.taylor[a * (p + 1) + j];
+                    if (nu_a == 0.0)
+                        continue;
+                    const size_t pole_row = static_cast<size_t>(su.knot - p + j) * nv;
+                    for (int l = 0; l <= q; ++l)
+                    {
+                        const double *h = &poles[(pole_row + sv.knot - q + l) * 4];
+                        double *acc = &row_sum[(static_cast<size_t>(a) * (q + 1) + l) * 4];
+                        for (int k = 0; k < 4; ++k)
+                            acc[k] += nu_a * h[k];
+                    }
+                }
+            }
+            double *c = &coefficients_[(iu * vspans.size() + iv) * stride];
+            for (int a = 0; a <= p; ++a)
+            {
+                for (int b = 0; b <= q; ++b)
+                {
+                    double *cab = c + (static_cast<size_t>(a) * (q + 1) + b) * 4;
+                    for (int l = 0; l <= q; ++l)
+                    {
+                        const double nv_b = sv.taylor[b * (q + 1) + l];
+                        const double *acc = &row_sum[(static_cast<size_t>(a) * (q + 1) + l) * 4];
+                        for (int k = 0; k < 4; ++k)
+                            cab[k] += nv_b * acc[k];
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <gp_Pnt.hxx>
+#include <gp_Vec.hxx>
+#include <Geom_Surface.hxx>
+
+#include "analytic_projection.h"
+
+// 具体曲面类型的非虚求值器：与 Geom_Surface::D2 同签名的内联成员函数，
+// 作为 local_project_point 的模板参数时求值和Newton迭代在同一个翻译单元内联展开，
+// 热循环中没有虚调用和句柄引用计数。曲面类型在批处理入口分派一次（见 PreparedSurface）
+enum SurfaceEvaluatorKind
+{
+    EVALUATOR_ADAPTOR = 0, // 无特化，走 GeomAdaptor_Surface 虚调用
+    EVALUATOR_PLANE,
+    EVALUATOR_CYLINDER,
+    EVALUATOR_CONE,
+    EVALUATOR_SPHERE,
+    EVALUATOR_TORUS,
+    EVALUATOR_BSPLINE      // B样条/Bezier（幂基span系数表）
+};
+
+const char *surface_evaluator_name(SurfaceEvaluatorKind kind);
+
+namespace surface_eval_detail
+{
+    inline gp_Vec combine(double a, const double *x, double b, const double *y)
+    {
+        return gp_Vec(a * x[0] + b * y[0], a * x[1] + b * y[1], a * x[2] + b * y[2]);
+    }
+
+    inline gp_Vec combine(double a, const double *x, double b, const double *y, double c, const double *z)
+    {
+        return gp_Vec(a * x[0] + b * y[0] + c * z[0], a * x[1] + b * y[1] + c * z[1], a * x[2] + b * y[2] + c * z[2]);
+    }
+
+    inline gp_Pnt offset(const double *origin, const gp_Vec &d)
+    {
+        return gp_Pnt(origin[0] + d.X(), origin[1] + d.Y(), origin[2] + d.Z());
+    }
+}
+
+// 初等曲面求值器（参数化与OCCT一致，frame取自 AnalyticSurface）
+// S = O + u X + v Y
+class PlaneEvaluator
+{
+public:
+    explicit PlaneEvaluator(const AnalyticSurface &analytic) : a_(analytic) {}
+
+    void D2(double u, double v, gp_Pnt &S, gp_Vec &Su, gp_Vec &Sv, gp_Vec &Suu, gp_Vec &Svv, gp_Vec &Suv) const
+    {
+        using namespace surface_eval_detail;
+        S = offset(a_.origin, combine(u, a_.xdir, v, a_.ydir));
+        Su = gp_Vec(a_.xdir[0], a_.xdir[1], a_.xdir[2]);
+        Sv = gp_Vec(a_.ydir[0], a_.ydir[1], a_.ydir[2]);
+        Suu = Svv = Suv = gp_Vec(0.0, 0.0, 0.0);
+    }
+
+private:
+    AnalyticSurface a_;
+};
+
+// S = O + R (cos u X + sin u Y) + v Z
+class CylinderEvaluator
+{
+public:
+    explicit CylinderEvaluator(const AnalyticSurface &analytic) : a_(analytic) {}
+
+    void D2(double u, double v, gp_Pnt &S, gp_Vec &Su, gp_Vec &Sv, gp_Vec &Suu, gp_Vec &Svv, gp_Vec &Suv) const
+    {
+        using namespace surface_eval_detail;
+        const double c = std::cos(u), s = std::sin(u), r = a_.radius;
+        S = offset(a_.origin, combine(r * c, a_.xdir, r * s, a_.ydir, v, a_.zdir));
+        Su = combine(-r * s, a_.xdir, r * c, a_.ydir);
+        Sv = gp_Vec(a_.zdir[0], a_.zdir[1], a_.zdir[2]);
+        Suu = combine(-r * c, a_.xdir, -r * s, a_.ydir);
+        Svv = Suv = gp_Vec(0.0, 0.0, 0.0);
+    }
+
+private:
+    AnalyticSurface a_;
+};
+
+// S = O + (R + v sinA)(cos u X + sin u Y) + v cosA Z
+class ConeEvaluator
+{
+public:
+    explicit ConeEvaluator(const AnalyticSurface &analytic) : a_(analytic) {}
+
+    void D2(double u, double v, gp_Pnt &S, gp_Vec &Su, gp_Vec &Sv, gp_Vec &Suu, gp_Vec &Svv, gp_Vec &Suv) const
+    {
+        using namespace surface_eval_detail;
+        const double c = std::cos(u), s = std::sin(u);
+        const double rho = a_.radius + v * a_.sin_angle;
+        S = offset(a_.origin, combine(rho * c, a_.xdir, rho * s, a_.ydir, v * a_.cos_angle, a_.zdir));
+        Su = combine(-rho * s, a_.xdir, rho * c, a_.ydir);
+        Sv = combine(a_.sin_angle * c, a_.xdir, a_.sin_angle * s, a_.ydir, a_.cos_angle, a_.zdir);
+        Suu = combine(-rho * c, a_.xdir, -rho * s, a_.ydir);
+        Svv = gp_Vec(0.0, 0.0, 0.0);
+        Suv = combine(-a_.sin_angle * s, a_.xdir, a_.sin_angle * c, a_.ydir);
+    }
+
+private:
+    AnalyticSurface a_;
+};
+
+// S = O + R cos v (cos u X + sin u Y) + R sin v Z
+class SphereEvaluator
+{
+public:
+    explicit SphereEvaluator(const AnalyticSurface &analytic) : a_(analytic) {}
+
+    void D2(double u, double v, gp_Pnt &S, gp_Vec &Su, gp_Vec &Sv, gp_Vec &Suu, gp_Vec &Svv, gp_Vec &Suv) const
+    {
+        using namespace surface_eval_detail;
+        const double cu = std::cos(u), su = std::sin(u), cv = std::cos(v), sv = std::sin(v), r = a_.radius;
+        S = offset(a_.origin, combine(r * cv * cu, a_.xdir, r * cv * su, a_.ydir, r * sv, a_.zdir));
+        Su = combine(-r * cv * su, a_.xdir, r * cv * cu, a_.ydir);
+        Sv = combine(-r * sv * cu, a_.xdir, -r * sv * su, a_.ydir, r * cv, a_.zdir);
+        Suu = combine(-r * cv * cu, a_.xdir, -r * cv * su, a_.ydir);
+        Svv = combine(-r * cv * cu, a_.xdir, -r * cv * su, a_.ydir, -r * sv, a_.zdir);
+        Suv = combine(r * sv * su, a_.xdir, -r * sv * cu, a_.ydir);
+    }
+
+private:
+    AnalyticSurface a_;
+};
+
+// S = O + (R + r cos v)(cos u X + sin u Y) + r sin v Z
+class TorusEvaluator
+{
+public:
+    explicit TorusEvaluator(const AnalyticSurface &analytic) : a_(analytic) {}
+
+    void D2(double u, double v, gp_Pnt &S, gp_Vec &Su, gp_Vec &Sv, gp_Vec &Suu, gp_Vec &Svv, gp_Vec &Suv) const
+    {
+        using namespace surface_eval_detail;
+        const double cu = std::cos(u), su = std::sin(u), cv = std::cos(v), sv = std::sin(v), r = a_.minor_radius;
+        const double rho = a_.radius + r * cv;
+        S = offset(a_.origin, combine(rho * cu, a_.xdir, rho * su, a_.ydir, r * sv, a_.zdir));
+        Su = combine(-rho * su, a_.xdir, rho * cu, a_.ydir);
+        Sv = combine(-r * sv * cu, a_.xdir, -r * sv * su, a_.ydir, r * cv, a_.zdir);
+        Suu = combine(-rho * cu, a_.xdir, -rho * su, a_.ydir);
+        Svv = combine(-r * cv * cu, a_.xdir, -r * cv * su, a_.ydir, -r * sv, a_.zdir);
+        Suv = combine(r * sv * su, a_.xdir, -r * sv * cu, a_.ydir);
+    }
+
+private:
+    AnalyticSurface a_;
+};
+
+// B样条（Bezier先转换为B样条，周期曲面先非周期化）每个 span 的幂基系数：
+// span [u_i, u_i+1] x [v_j, v_j+1] 内 Sw(u, v) = sum c_ab s^a t^b，s/t 为归一化到 [0, 1] 的局部参数，
+// Sw 为齐次坐标 (wx, wy, wz, w)。系数由span起点的基函数各阶导数一次算出，构建后只读共享
+class BSplineSpanTable
+{
+public:
+    static const int MAX_DEGREE = 15;          // 更高次数的曲面不特化
+    static const size_t MAX_COEFFICIENTS = size_t(8) << 20; // 系数表上限（double个数，64MB）
+
+    // 识别B样条/Bezier（可被 Geom_RectangularTrimmedSurface 包裹）并构建系数表，其它曲面返回false；
+    // 裁剪范围超出节点范围（周期曲面跨接缝裁剪）时也返回false
+    bool init(const Handle(Geom_Surface) & surface);
+
+    // 直接由控制网格构建：节点为完整节点序列（含重复），poles 为 nu x nv 个齐次控制点 (wx, wy, wz, w)，下标 (i * nv + j) * 4
+    bool build(int udegree, int vdegree, const std::vector<double> &uknots, const std::vector<double> &vknots,
+               const std::vector<double> &poles, bool rational);
+
+    bool is_valid() const { return !coefficients_.empty(); }
+    int u_degree() const { return udeg_; }
+    int v_degree() const { return vdeg_; }
+    bool is_rational() const { return rational_; }
+    int nb_u_spans() const { return static_cast<int>(ubreaks_.size()) - 1; }
+    int nb_v_spans() const { return static_cast<int>(vbreaks_.size()) - 1; }
+    size_t nb_coefficients() const { return coefficients_.size(); }
+
+    const std::vector<double> &u_breaks() const { return ubreaks_; }
+    const std::vector<double> &v_breaks() const { return vbreaks_; }
+    const double *span(int iu, int iv) const { return &coefficients_[(static_cast<size_t>(iu) * nb_v_spans() + iv) * stride_]; }
+
+private:
+    int udeg_ = 0, vdeg_ = 0;
+    bool rational_ = false;
+    size_t stride_ = 0;                     // 每个span的系数个数 (udeg + 1) * (vdeg + 1) * 4
+    std::vector<double> ubreaks_, vbreaks_; // span端点（去重节点）
+    std::vector<double> coefficients_;
+};
+
+// B样条求值器：线程私有（缓存上一次所在的span，Newton迭代通常停在同一个span内，不必二分查找）
+class BSplineEvaluator
+{
+public:
+    explicit BSplineEvaluator(const BSplineSpanTable &table) : table_(&table) {}
+
+    void D2(double u, double v, gp_Pnt &S, gp_Vec &Su, gp_Vec &Sv, gp_Vec &Suu, gp_Vec &Svv, gp_Vec &Suv) const
+    {
+        const int p = table_->u_degree(), q = table_->v_degree();
+        iu_ = locate(table_->u_breaks(), u, iu_);
+        iv_ = locate(table_->v_breaks(), v, iv_);
+        const double u0 = table_->u_breaks()[iu_], du = table_->u_breaks()[iu_ + 1] - u0;
+        const double v0 = table_->v_breaks()[iv_], dv = table_->v_breaks()[iv_ + 1] - v0;
+        const double s = (u - u0) / du, t = (v - v0) / dv;
+        const double *c = table_->span(iu_, iv_);
+
+        // 先对每行按 t 做Horner（值、一阶、二阶导），再按 s 合并；4个分量为齐次坐标
+        double r0[BSplineSpanTable::MAX_DEGREE + 1][4], r1[BSplineSpanTable::MAX_DEGREE + 1][4], r2[BSplineSpanTable::MAX_DEGREE + 1][4];
+        for (int a = 0; a <= p; ++a)
+        {
+            const double *row = c + static_cast<size_t>(a) * (q + 1) * 4;
+            for (int k = 0; k < 4; ++k)
+            {
+                double h0 = 0.0, h1 = 0.0, h2 = 0.0;
+                for (int b = q; b >= 0; --b)
+                {
+                    h2 = h2 * t + h1;
+                    h1 = h1 * t + h0;
+                    h0 = h0 * t + row[b * 4 + k];
+                }
+                r0[a][k] = h0, r1[a][k] = h1, r2[a][k] = 2.0 * h2;
+            }
+        }
+        double P[4], Ps[4], Pt[4], Pss[4], Ptt[4], Pst[4];
+        for (int k = 0; k < 4; ++k)
+        {
+            double h0 = 0.0, h1 = 0.0, h2 = 0.0, g0 = 0.0, g1 = 0.0, e0 = 0.0;
+            for (int a = p; a >= 0; --a)
+            {
+                h2 = h2 * s + h1;
+                h1 = h1 * s + h0;
+                h0 = h0 * s + r0[a][k];
+                g1 = g1 * s + g0;
+                g0 = g0 * s + r1[a][k];
+                e0 = e0 * s + r2[a][k];
+            }
+            P[k] = h0, Ps[k] = h1 / du, Pss[k] = 2.0 * h2 / (du * du);
+            Pt[k] = g0 / dv, Pst[k] = g1 / (du * dv), Ptt[k] = e0 / (dv * dv);
+        }
+
+        if (!table_->is_rational())
+        {
+            S.SetCoord(P[0], P[1], P[2]);
+            Su.SetCoord(Ps[0], Ps[1], Ps[2]);
+            Sv.SetCoord(Pt[0], Pt[1], Pt[2]);
+            Suu.SetCoord(Pss[0], Pss[1], Pss[2]);
+            Svv.SetCoord(Ptt[0], Ptt[1], Ptt[2]);
+            Suv.SetCoord(Pst[0], Pst[1], Pst[2]);
+            return;
+        }
+
+        // 有理：S = A / w 的商法则
+        const double iw = 1.0 / P[3];
+        double x[3], xu[3], xv[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            x[k] = P[k] * iw;
+            xu[k] = (Ps[k] - Ps[3] * x[k]) * iw;
+            xv[k] = (Pt[k] - Pt[3] * x[k]) * iw;
+        }
+        S.SetCoord(x[0], x[1], x[2]);
+        Su.SetCoord(xu[0], xu[1], xu[2]);
+        Sv.SetCoord(xv[0], xv[1], xv[2]);
+        Suu.SetCoord((Pss[0] - 2.0 * Ps[3] * xu[0] - Pss[3] * x[0]) * iw,
+                     (Pss[1] - 2.0 * Ps[3] * xu[1] - Pss[3] * x[1]) * iw,
+                     (Pss[2] - 2.0 * Ps[3] * xu[2] - Pss[3] * x[2]) * iw);
+        Svv.SetCoord((Ptt[0] - 2.0 * Pt[3] * xv[0] - Ptt[3] * x[0]) * iw,
+                     (Ptt[1] - 2.0 * Pt[3] * xv[1] - Ptt[3] * x[1]) * iw,
+                     (Ptt[2] - 2.0 * Pt[3] * xv[2] - Ptt[3] * x[2]) * iw);
+        Suv.SetCoord((Pst[0] - Ps[3] * xv[0] - Pt[3] * xu[0] - Pst[3] * x[0]) * iw,
+                     (Pst[1] - Ps[3] * xv[1] - Pt[3] * xu[1] - Pst[3] * x[1]) * iw,
+                     (Pst[2] - Ps[3] * xv[2] - Pt[3] * xu[2] - Pst[3] * x[2]) * iw);
+    }
+
+private:
+    // 包含t的span下标（参数域外截到首尾span）；先查上次的span
+    static int locate(const std::vector<double> &breaks, double t, int hint)
+    {
+        const int last = static_cast<int>(breaks.size()) - 2;
+        if (t >= breaks[hint] && (t < breaks[hint + 1] || hint == last))
+            return hint;
+        const int k = static_cast<int>(std::upper_bound(breaks.begin(), breaks.end(), t) - breaks.begin()) - 1;
+        return std::min(std::max(k, 0), last);
+    }
+
+    const BSplineSpanTable *table_;
+    mutable int iu_ = 0, iv_ = 0;
+};